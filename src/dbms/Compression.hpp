@@ -1,6 +1,8 @@
 #pragma once
 
+#include "dbms/Scheduler.hpp"
 #include "dbms/Store.hpp"
+#include <cstring>
 #include <typeinfo>
 
 
@@ -27,6 +29,26 @@ struct RLE
 template<typename T, typename S = uint32_t>
 struct Dictionary;
 
+/** Tag type for bit packing.  A column of BitPacked<T> stores every block of elements with as many bits per element as
+ * the largest element of the block needs. */
+template<typename T>
+struct BitPacked;
+
+/** Tag type for delta encoding.  A column of Delta<T> stores the first element of every block, and the
+ * frame-of-reference encoded differences of the other elements to their predecessors. */
+template<typename T>
+struct Delta;
+
+/** Tag type for frame-of-reference encoding.  A column of FOR<T> stores every block of elements as the bit-packed
+ * differences of the elements to the minimum of the block. */
+template<typename T>
+struct FOR;
+
+/** Tag type for string compression.  A column of FSST<Char<N>> replaces frequent substrings of its elements by the 1
+ * byte codes of a symbol table, similar to FSST (Fast Static Symbol Table). */
+template<typename T>
+struct FSST;
+
 namespace iterator {
 
 /**
@@ -127,10 +149,45 @@ struct Column<RLE<T>> : GenericColumn
 
     virtual std::size_t size() const { return num_rows_; }
     virtual std::size_t capacity() const { return num_rows_; }
-    std::size_t num_runs() const { return size_; }
+    virtual std::size_t num_runs() const { return size_; }
+
+    virtual bool is_compressed() const { return true; }
+    virtual std::string type_tag() const { return "RLE<" + value_tag<T>() + ">"; }
 
     /** Appends an element at the end of the column. */
     void push_back(T value);
+    virtual void append(const GenericColumn &other, std::size_t n);
+
+    /** Returns an iterator to the element at index idx.  Locating the element searches the run index, and then scans at
+     * most RUNS_PER_INDEX_ENTRY runs. */
+    const_iterator seek(std::size_t idx) const;
+    /** Returns the element at index idx. */
+    const T & at(std::size_t idx) const { return *seek(idx); }
+    /** Decodes the at most n elements starting at index start to buffer and returns the number of decoded elements. */
+    std::size_t fetch(std::size_t start, std::size_t n, T *buffer) const {
+        const_iterator it = seek(start);
+        return fetch(it, n, buffer);
+    }
+    /** Decodes the at most n elements starting at it to buffer, advances it past them, and returns the number of
+     * decoded elements.  Use this method to decode consecutive batches without locating each batch anew. */
+    std::size_t fetch(const_iterator &it, std::size_t n, T *buffer) const {
+        return decode(it, n, buffer, [](const T &value) -> const T& { return value; });
+    }
+
+    virtual ColumnCursor cursor(std::size_t idx) const;
+    virtual const void * read(ColumnCursor &cursor, std::size_t n, void *buffer) const {
+        return read(cursor, n, static_cast<T*>(buffer), [](const T &value) -> const T& { return value; });
+    }
+    virtual bool has_runs() const { return true; }
+    virtual std::size_t read_runs(ColumnCursor &cursor, std::size_t n, std::size_t max_runs, void *values,
+                                  uint32_t *ends) const {
+        return read_runs(cursor, n, max_runs, static_cast<T*>(values), ends,
+                         [](const T &value) -> const T& { return value; });
+    }
+    virtual void skip(ColumnCursor &cursor, std::size_t n) const;
+
+    virtual void write_snapshot(SnapshotWriter &out) const;
+    virtual void read_snapshot(SnapshotReader &in);
 
     friend std::ostream & operator<<(std::ostream &out, const Column<RLE<T>> &column) {
         return out << "Column<RLE<" << typeid(T).name() << ">> (" << column.num_rows_ << " elements, "
@@ -138,8 +195,29 @@ struct Column<RLE<T>> : GenericColumn
     }
     DECLARE_DUMP_VIRTUAL
 
+    protected:
+    /** Writes the values of the at most n elements starting at it, mapped by f, to buffer.  Advances it past the
+     * elements and returns their number.  f is applied once per run. */
+    template<typename U, typename F>
+    std::size_t decode(const_iterator &it, std::size_t n, U *buffer, F &&f) const;
+    /** Decodes like decode(), starting at and advancing cursor.  Returns buffer. */
+    template<typename U, typename F>
+    U * read(ColumnCursor &cursor, std::size_t n, U *buffer, F &&f) const;
+    /** Reads runs like read_runs(), writing the values of the runs mapped by f to values. */
+    template<typename U, typename F>
+    std::size_t read_runs(ColumnCursor &cursor, std::size_t n, std::size_t max_runs, U *values, uint32_t *ends,
+                          F &&f) const;
+
     private:
+    /** Rebuilds index_ from the runs. */
+    void build_index();
+
+    /** The number of runs per entry of the run index. */
+    static constexpr std::size_t RUNS_PER_INDEX_ENTRY = 64;
+
     std::size_t num_rows_ = 0;
+    /** The sparse run index: entry i holds the index of the first element of run i * RUNS_PER_INDEX_ENTRY. */
+    std::vector<std::size_t> index_;
 };
 
 /**
@@ -151,12 +229,44 @@ struct Column<Dictionary<T, S>> : public Column<typename Dictionary<T, S>::index
     using dictionary_type = Dictionary<T, S>;
     using Base = Column<typename dictionary_type::index_type>;
 
+    virtual bool is_compressed() const { return true; }
+    virtual std::string type_tag() const { return "Dictionary<" + value_tag<T>() + ", " + value_tag<S>() + ">"; }
+
     /** Appends an element at the end of the column. */
     void push_back(T value);
+    virtual void append(const GenericColumn &other, std::size_t n);
+    /** Appends the first n elements of the uncompressed column other, which holds values of type T, to the empty
+     * column.  If sorted is true, the dictionary is sorted, i.e. its indices compare like its values. */
+    void build(const GenericColumn &other, std::size_t n, bool sorted);
+
+    /* Fetching a span of elements returns the dictionary indices. */
+    using Base::fetch;
+    /** Decodes the at most n elements starting at index start to buffer and returns the number of decoded elements. */
+    std::size_t fetch(std::size_t start, std::size_t n, T *buffer) const;
+
+    virtual const void * read(ColumnCursor &cursor, std::size_t n, void *buffer) const {
+        cursor.idx += fetch(cursor.idx, n, static_cast<T*>(buffer));
+        return buffer;
+    }
+    /* Consecutive equal indices form runs, that are decoded once. */
+    virtual bool has_runs() const { return true; }
+    virtual std::size_t num_runs() const { return num_runs_; }
+    virtual std::size_t read_runs(ColumnCursor &cursor, std::size_t n, std::size_t max_runs, void *values,
+                                  uint32_t *ends) const;
+    virtual std::size_t dictionary_size() const { return dict_.size(); }
+    virtual void read_dictionary(std::size_t begin, std::size_t n, void *values) const {
+        for (std::size_t i = 0; i != n; ++i)
+            static_cast<T*>(values)[i] = dict_[begin + i];
+    }
+    virtual std::size_t read_index_runs(ColumnCursor &cursor, std::size_t n, std::size_t max_runs, uint32_t *indices,
+                                        uint32_t *ends) const;
 
     /** Returns the underlying dictionary. */
     const dictionary_type & get_dictionary() const { return dict_; }
 
+    virtual void write_snapshot(SnapshotWriter &out) const;
+    virtual void read_snapshot(SnapshotReader &in);
+
     friend std::ostream & operator<<(std::ostream &out, const Column &column) {
         return out << "Column<Dictionary<" << typeid(T).name() << "> (" << column.size() << '/' << column.capacity()
                    << " elements, " << column.dict_.size() << " dictionary entries)";
@@ -165,6 +275,7 @@ struct Column<Dictionary<T, S>> : public Column<typename Dictionary<T, S>::index
 
     private:
     dictionary_type dict_;
+    std::size_t num_runs_ = 0; ///< the number of runs of equal indices
 };
 
 /**
@@ -176,9 +287,51 @@ struct Column<RLE<Dictionary<T, S>>> : public Column<RLE<typename Dictionary<T,
     using dictionary_type = Dictionary<T, S>;
     using rle_type = RLE<typename dictionary_type::index_type>;
     using Base = Column<rle_type>;
+    using const_iterator = typename Base::const_iterator;
+
+    virtual bool is_compressed() const { return true; }
+    virtual std::string type_tag() const { return "RLE<Dictionary<" + value_tag<T>() + ", " + value_tag<S>() + ">>"; }
 
     /** Appends an element at the end of the column. */
     void push_back(T value);
+    virtual void append(const GenericColumn &other, std::size_t n);
+    /** Appends the first n elements of the uncompressed column other, which holds values of type T, to the empty
+     * column.  If sorted is true, the dictionary is sorted, i.e. its indices compare like its values. */
+    void build(const GenericColumn &other, std::size_t n, bool sorted);
+
+    /* Fetching to a buffer of the index type returns the dictionary indices. */
+    using Base::fetch;
+    /** Decodes the at most n elements starting at index start to buffer and returns the number of decoded elements. */
+    std::size_t fetch(std::size_t start, std::size_t n, T *buffer) const {
+        const_iterator it = Base::seek(start);
+        return fetch(it, n, buffer);
+    }
+    /** Decodes the at most n elements starting at it to buffer, advances it past them, and returns the number of
+     * decoded elements. */
+    std::size_t fetch(const_iterator &it, std::size_t n, T *buffer) const {
+        return Base::decode(it, n, buffer, [this](const auto &idx) -> const T& { return dict_[idx]; });
+    }
+
+    virtual const void * read(ColumnCursor &cursor, std::size_t n, void *buffer) const {
+        return Base::read(cursor, n, static_cast<T*>(buffer), [this](const auto &idx) -> const T& { return dict_[idx]; });
+    }
+    virtual std::size_t read_runs(ColumnCursor &cursor, std::size_t n, std::size_t max_runs, void *values,
+                                  uint32_t *ends) const {
+        return Base::read_runs(cursor, n, max_runs, static_cast<T*>(values), ends,
+                               [this](const auto &idx) -> const T& { return dict_[idx]; });
+    }
+    virtual std::size_t dictionary_size() const { return dict_.size(); }
+    virtual void read_dictionary(std::size_t begin, std::size_t n, void *values) const {
+        for (std::size_t i = 0; i != n; ++i)
+            static_cast<T*>(values)[i] = dict_[begin + i];
+    }
+    virtual std::size_t read_index_runs(ColumnCursor &cursor, std::size_t n, std::size_t max_runs, uint32_t *indices,
+                                        uint32_t *ends) const {
+        return Base::read_runs(cursor, n, max_runs, indices, ends, [](const auto &idx) { return uint32_t(idx); });
+    }
+
+    /** Returns the value of the element at index idx. */
+    const T & at(std::size_t idx) const { return dict_[Base::at(idx)]; }
 
     /** Returns the underlying dictionary. */
     const dictionary_type & get_dictionary() const { return dict_; }
@@ -186,6 +339,9 @@ struct Column<RLE<Dictionary<T, S>>> : public Column<RLE<typename Dictionary<T,
     virtual std::size_t size_in_bytes() const { return Base::size_in_bytes() + dict_.size() * sizeof(T); }
     virtual std::size_t capacity_in_bytes() const { return Base::capacity_in_bytes() + dict_.size() * sizeof(T); }
 
+    virtual void write_snapshot(SnapshotWriter &out) const;
+    virtual void read_snapshot(SnapshotReader &in);
+
     friend std::ostream & operator<<(std::ostream &out, const Column &column) {
         return out << "Column<RLE<Dictionary<" << typeid(T).name() << "> (" << column.size() << '/'
                    << column.capacity() << " elements, " << column.dict_.size() << " dictionary entries, "
@@ -197,7 +353,422 @@ struct Column<RLE<Dictionary<T, S>>> : public Column<RLE<typename Dictionary<T,
     dictionary_type dict_;
 };
 
+/**
+ * Specialize Column for bit packing.  The elements are stored in blocks of BLOCK_SIZE elements.  A block stores the
+ * difference of every element to the reference of the block with the number of bits the largest difference needs.
+ * The words of all blocks are the elements of the GenericColumn.  The elements following the last complete block are
+ * kept unpacked until their block is complete.
+ */
+template<typename T>
+struct Column<BitPacked<T>> : GenericColumn
+{
+    static_assert(std::is_integral<T>::value, "bit packing requires integral values");
+
+    /** The number of elements per block. */
+    static constexpr std::size_t BLOCK_SIZE = 1024;
+
+    Column() : Column(false) { }
+
+    virtual std::size_t size() const { return num_rows_; }
+    virtual std::size_t capacity() const { return num_rows_; }
+    virtual std::size_t size_in_bytes() const {
+        return GenericColumn::size_in_bytes() + blocks_.size() * sizeof(Block) + tail_.size() * sizeof(T);
+    }
+    virtual std::size_t capacity_in_bytes() const {
+        return GenericColumn::capacity_in_bytes() + blocks_.capacity() * sizeof(Block) + tail_.capacity() * sizeof(T);
+    }
+
+    virtual bool is_compressed() const { return true; }
+    virtual std::string type_tag() const { return "BitPacked<" + value_tag<T>() + ">"; }
+
+    /** Appends an element at the end of the column. */
+    void push_back(T value);
+    virtual void append(const GenericColumn &other, std::size_t n);
+
+    /** Returns the number of packed blocks. */
+    std::size_t num_blocks() const { return blocks_.size(); }
+    /** Returns the number of bits per element of the packed block with index block. */
+    unsigned bits(std::size_t block) const { return blocks_[block].bits; }
+
+    /** Returns the element at index idx. */
+    T at(std::size_t idx) const;
+    /** Decodes the at most n elements starting at index start to buffer and returns the number of decoded elements. */
+    std::size_t fetch(std::size_t start, std::size_t n, T *buffer) const;
+
+    virtual const void * read(ColumnCursor &cursor, std::size_t n, void *buffer) const {
+        cursor.idx += fetch(cursor.idx, n, static_cast<T*>(buffer));
+        return buffer;
+    }
+
+    virtual void write_snapshot(SnapshotWriter &out) const;
+    virtual void read_snapshot(SnapshotReader &in);
+
+    friend std::ostream & operator<<(std::ostream &out, const Column &column) {
+        return out << "Column<BitPacked<" << typeid(T).name() << ">> (" << column.num_rows_ << " elements, "
+                   << column.blocks_.size() << " blocks)";
+    }
+    DECLARE_DUMP_VIRTUAL
+
+    protected:
+    /** Creates an empty column.  If use_reference is true, the reference of a block is its minimum, otherwise 0. */
+    explicit Column(bool use_reference) : GenericColumn(sizeof(uint64_t)), use_reference_(use_reference) { }
+
+    private:
+    /** The header of a packed block. */
+    struct Block
+    {
+        uint64_t reference; ///< the value the elements of the block are packed relative to
+        uint64_t offset; ///< the index of the first word of the block
+        uint64_t bits; ///< the number of bits per element
+    };
+
+    /** Decodes the n elements starting at index first within block to buffer. */
+    void unpack(const Block &block, std::size_t first, std::size_t n, T *buffer) const;
+    /** Packs the elements of tail_ to a new block and clears tail_. */
+    void pack_tail();
+
+    bool use_reference_;
+    std::size_t num_rows_ = 0;
+    std::vector<Block> blocks_;
+    std::vector<T> tail_; ///< the elements following the last block
+};
+
+/**
+ * Specialize Column for frame-of-reference encoding.  The reference of every block is its minimum, hence the elements
+ * of a block are packed with as many bits as the range of its values needs.
+ */
+template<typename T>
+struct Column<FOR<T>> : public Column<BitPacked<T>>
+{
+    Column() : Column<BitPacked<T>>(true) { }
+
+    virtual std::string type_tag() const { return "FOR<" + value_tag<T>() + ">"; }
+
+    friend std::ostream & operator<<(std::ostream &out, const Column &column) {
+        return out << "Column<FOR<" << typeid(T).name() << ">> (" << column.size() << " elements, "
+                   << column.num_blocks() << " blocks)";
+    }
+    DECLARE_DUMP_VIRTUAL
+};
+
+/**
+ * Specialize Column for delta encoding.  The elements of the base column are the differences of the elements to their
+ * predecessors.  The first element of every block is also stored as the base of its block, such that decoding a block
+ * computes the prefix sums of its differences starting from the base.  Locating an element requires decoding its block
+ * up to the element, while consecutive batches read with a cursor continue from the preceding element.
+ */
+template<typename T>
+struct Column<Delta<T>> : public Column<FOR<std::make_signed_t<T>>>
+{
+    using difference_type = std::make_signed_t<T>;
+    using Base = Column<FOR<difference_type>>;
+    using Base::BLOCK_SIZE;
+
+    virtual std::string type_tag() const { return "Delta<" + value_tag<T>() + ">"; }
+    virtual std::size_t size_in_bytes() const { return Base::size_in_bytes() + bases_.size() * sizeof(T); }
+    virtual std::size_t capacity_in_bytes() const {
+        return Base::capacity_in_bytes() + bases_.capacity() * sizeof(T);
+    }
+
+    /** Appends an element at the end of the column. */
+    void push_back(T value);
+    virtual void append(const GenericColumn &other, std::size_t n);
+
+    /** Returns the element at index idx. */
+    T at(std::size_t idx) const;
+    /** Decodes the at most n elements starting at index start to buffer and returns the number of decoded elements. */
+    std::size_t fetch(std::size_t start, std::size_t n, T *buffer) const {
+        ColumnCursor cursor = this->cursor(start);
+        read(cursor, n, buffer);
+        return cursor.idx - start;
+    }
+
+    virtual ColumnCursor cursor(std::size_t idx) const;
+    virtual const void * read(ColumnCursor &cursor, std::size_t n, void *buffer) const;
+    virtual void skip(ColumnCursor &cursor, std::size_t n) const {
+        cursor = this->cursor(std::min(cursor.idx + n, Base::size()));
+    }
+
+    virtual void write_snapshot(SnapshotWriter &out) const;
+    virtual void read_snapshot(SnapshotReader &in);
+
+    friend std::ostream & operator<<(std::ostream &out, const Column &column) {
+        return out << "Column<Delta<" << typeid(T).name() << ">> (" << column.size() << " elements, "
+                   << column.num_blocks() << " blocks)";
+    }
+    DECLARE_DUMP_VIRTUAL
+
+    private:
+    std::vector<T> bases_; ///< the first element of every block
+    T last_ = T(); ///< the last element of the column
+};
+
+/**
+ * This class implements a table of up to 255 symbols, which are strings of 1 to 8 bytes, for string compression.  A
+ * string is encoded greedily: the longest symbol matching at the current position is replaced by its 1 byte code, and a
+ * byte that no symbol matches is escaped by the code ESCAPE.  Decoding a code copies 8 bytes and advances by the length
+ * of the symbol.  Since encoding is deterministic, equal strings have equal codes.
+ */
+struct SymbolTable
+{
+    static constexpr std::size_t MAX_SYMBOLS = 255;
+    static constexpr uint8_t ESCAPE = 255; ///< the code preceding an escaped byte
+    static constexpr std::size_t MAX_LENGTH = 256; ///< the maximum length of an encoded string
+
+    /** Creates a table without symbols, that escapes every byte. */
+    SymbolTable() { build_lookup(); }
+    /** Creates a table of the given symbols, whose bytes are stored in memory order in the words of symbols. */
+    SymbolTable(const uint64_t *symbols, const uint8_t *lengths, std::size_t num_symbols);
+
+    /** Returns a table trained on the n strings.  The sample is encoded repeatedly, and the table of the next round
+     * keeps the symbols and the concatenations of adjacent symbols, that covered the most bytes. */
+    static SymbolTable Train(const char * const *strings, std::size_t n);
+
+    /** Returns the number of symbols. */
+    std::size_t size() const { return num_symbols_; }
+    std::size_t size_in_bytes() const {
+        return num_symbols_ * (sizeof(uint64_t) + sizeof(uint8_t)) + sizeof(single_) + sizeof(bucket_begin_) +
+               long_codes_.size();
+    }
+    const uint64_t * symbols() const { return symbols_; }
+    const uint8_t * lengths() const { return lengths_; }
+
+    /** Encodes the string str of length len, which must not exceed MAX_LENGTH, to out, which must have room for 2 * len
+     * bytes.  Returns the number of bytes of the codes. */
+    std::size_t encode(const char *str, std::size_t len, uint8_t *out) const;
+
+    /** Decodes the n bytes of codes to out, which must have room for the decoded string and 8 more bytes.  Returns the
+     * length of the decoded string. */
+    std::size_t decode(const uint8_t *codes, std::size_t n, char *out) const {
+        char *p = out;
+        for (std::size_t i = 0; i != n; ++i) {
+            const uint8_t code = codes[i];
+            if (code == ESCAPE) {
+                *p++ = char(codes[++i]);
+            } else {
+                memcpy(p, &symbols_[code], sizeof(uint64_t));
+                p += lengths_[code];
+            }
+        }
+        return p - out;
+    }
+
+    /** Returns true iff the n bytes of codes decode to a string, that starts with the prefix of length len.  Decoding
+     * stops at the first mismatch. */
+    bool starts_with(const uint8_t *codes, std::size_t n, const char *prefix, std::size_t len) const;
+
+    private:
+    /** The number of buckets of symbols of at least 2 bytes. */
+    static constexpr std::size_t NUM_BUCKETS = 1024;
+    /** Returns the bucket of the symbols, that start with the first 2 bytes of word. */
+    static std::size_t bucket_of(uint64_t word) { return (uint32_t(word & 0xffff) * 2654435761U) >> 22; }
+
+    /** Builds the tables to find the longest symbol matching at a position. */
+    void build_lookup();
+
+    std::size_t num_symbols_ = 0;
+    uint64_t symbols_[MAX_SYMBOLS]; ///< the bytes of the symbols in memory order, padded with zeros
+    uint8_t lengths_[MAX_SYMBOLS];
+    uint8_t single_[256]; ///< the code of the symbol of length 1 of each byte, or ESCAPE
+    /** The codes of the symbols of at least 2 bytes, ordered by the bucket of their first 2 bytes and by decreasing
+     * length, and the position of the first code of each bucket. */
+    uint8_t bucket_begin_[NUM_BUCKETS + 1];
+    std::vector<uint8_t> long_codes_;
+};
+
+/**
+ * Specialize Column for string compression.  The elements are encoded with a symbol table, that is trained on a sample
+ * of the elements, and their codes are stored consecutively.  The end of the codes of every element is stored relative
+ * to the start of its block of BLOCK_SIZE elements, such that a single element is located and decoded in constant
+ * time.  Comparisons for equality compare codes, and prefixes are compared while decoding.
+ *
+ * append() trains the table on a sample of the appended elements.  Elements added by push_back() are kept plain, until
+ * TRAINING_SIZE elements train the table.
+ */
+template<std::size_t N>
+struct Column<FSST<Char<N>>> : GenericColumn
+{
+    using value_type = Char<N>;
+
+    /** The number of elements per block. */
+    static constexpr std::size_t BLOCK_SIZE = 128;
+    /** The number of elements the symbol table is trained on. */
+    static constexpr std::size_t TRAINING_SIZE = 1 << 14;
+    static_assert(N <= SymbolTable::MAX_LENGTH, "strings are too long to be encoded");
+    static_assert(2 * N * BLOCK_SIZE <= UINT16_MAX + 1, "the codes of a block must be addressable with 16 bits");
+
+    Column() : GenericColumn(sizeof(uint8_t)) { }
+
+    virtual std::size_t size() const { return num_rows_; }
+    virtual std::size_t capacity() const { return num_rows_; }
+    virtual std::size_t size_in_bytes() const {
+        return GenericColumn::size_in_bytes() + offsets_.size() * sizeof(uint64_t) + ends_.size() * sizeof(uint16_t) +
+               (is_trained_ ? table_.size_in_bytes() : 0) + plain_.size() * sizeof(value_type);
+    }
+    virtual std::size_t capacity_in_bytes() const {
+        return GenericColumn::capacity_in_bytes() + offsets_.capacity() * sizeof(uint64_t) +
+               ends_.capacity() * sizeof(uint16_t) + (is_trained_ ? table_.size_in_bytes() : 0) +
+               plain_.capacity() * sizeof(value_type);
+    }
+
+    virtual bool is_compressed() const { return true; }
+    virtual std::string type_tag() const { return "FSST<" + value_tag<value_type>() + ">"; }
+
+    /** Appends an element at the end of the column. */
+    void push_back(const value_type &value);
+    virtual void append(const GenericColumn &other, std::size_t n);
+
+    /** Returns true iff the symbol table is trained and the elements are encoded. */
+    bool is_trained() const { return is_trained_; }
+    const SymbolTable & symbol_table() const { return table_; }
+
+    /** Returns the element at index idx. */
+    value_type at(std::size_t idx) const {
+        value_type value;
+        fetch(idx, 1, &value);
+        return value;
+    }
+    /** Decodes the at most n elements starting at index start to buffer and returns the number of decoded elements. */
+    std::size_t fetch(std::size_t start, std::size_t n, value_type *buffer) const;
+
+    virtual const void * read(ColumnCursor &cursor, std::size_t n, void *buffer) const {
+        cursor.idx += fetch(cursor.idx, n, static_cast<value_type*>(buffer));
+        return buffer;
+    }
+
+    virtual bool has_string_matching() const { return true; }
+    virtual std::size_t match(ColumnCursor &cursor, std::size_t n, const char *str, bool is_prefix,
+                              uint8_t *mask) const;
+
+    virtual void write_snapshot(SnapshotWriter &out) const;
+    virtual void read_snapshot(SnapshotReader &in);
+
+    friend std::ostream & operator<<(std::ostream &out, const Column &column) {
+        return out << "Column<FSST<Char<" << N << ">>> (" << column.num_rows_ << " elements, "
+                   << column.table_.size() << " symbols)";
+    }
+    DECLARE_DUMP_VIRTUAL
+
+    private:
+    /** Returns the codes of the encoded element at index idx, and sets len to their number. */
+    const uint8_t * codes(std::size_t idx, std::size_t &len) const {
+        const std::size_t first = idx % BLOCK_SIZE;
+        const std::size_t begin = first == 0 ? 0 : ends_[idx - 1];
+        len = ends_[idx] - begin;
+        return static_cast<const uint8_t*>(data_) + offsets_[idx / BLOCK_SIZE] + begin;
+    }
+    /** Encodes value and appends its codes. */
+    void encode(const value_type &value);
+    /** Trains the symbol table on the n strings and encodes the plain elements. */
+    void train(const char * const *strings, std::size_t n);
+
+    SymbolTable table_;
+    bool is_trained_ = false;
+    std::size_t num_rows_ = 0;
+    std::vector<uint64_t> offsets_; ///< the offset of the codes of every block
+    std::vector<uint16_t> ends_; ///< the end of the codes of every element, relative to the offset of its block
+    std::vector<value_type> plain_; ///< the elements, while the table is not trained
+};
+
+/** Returns an empty ColumnStore for the lineitem relation with compressed columns.  Rows appended to the store, e.g. by
+ * the Loader, are compressed on the fly. */
+ColumnStore create_compressed_columnstore_lineitem();
+
 /** This method takes a ColumnStore and its Relation, and returns a new, compressed ColumnStore instance. */
 ColumnStore * compress_columnstore_lineitem(const Relation &relation, const ColumnStore &store);
 
+
+/*======================================================================================================================
+ * Encoding selection
+ *====================================================================================================================*/
+
+#define Encoding(X) \
+    X(EN_Plain), \
+    X(EN_RLE), \
+    X(EN_Dictionary), \
+    X(EN_RLE_Dictionary), \
+    X(EN_BitPacked), \
+    X(EN_FOR), \
+    X(EN_Delta), \
+    X(EN_FSST),
+
+/** The encodings a column can be compressed with.  EN_Plain stores the elements bytewise. */
+DECLARE_ENUM(Encoding);
+
+/** Returns the name of encoding. */
+const char * encoding_name(Encoding encoding);
+
+/**
+ * This class controls the choice of encodings.  An encoding is chosen by the estimated size of a column plus its
+ * estimated decode time, weighted by bytes_per_ns.
+ */
+struct CompressionPolicy
+{
+    std::size_t sample_size = 1 << 16; ///< the number of elements sampled per column
+    /** The number of bytes one nanosecond of decode time is worth.  0 chooses the smallest encoding, larger values
+     * prefer faster decoding. */
+    double bytes_per_ns = 1;
+};
+
+/** The estimated size and decode time of a column in an encoding. */
+struct EncodingEstimate
+{
+    Encoding encoding;
+    std::size_t size; ///< the estimated size in bytes
+    double decode_time; ///< the estimated time in nanoseconds to decode all elements
+};
+
+/** The analysis of a column: estimates of the encodings applicable to its attribute, and the chosen encoding. */
+struct ColumnAnalysis
+{
+    Attribute attr; ///< the attribute of the column
+    std::size_t num_rows; ///< the number of elements of the column
+    std::vector<EncodingEstimate> estimates; ///< the estimates of the applicable encodings, starting with EN_Plain
+    Encoding encoding; ///< the chosen encoding
+
+    /** Returns the estimate of the plain column. */
+    const EncodingEstimate & plain() const { return estimates.front(); }
+    /** Returns the estimate of the chosen encoding. */
+    const EncodingEstimate & chosen() const {
+        for (auto &estimate : estimates)
+            if (estimate.encoding == encoding) return estimate;
+        dbms_unreachable("the chosen encoding has no estimate");
+    }
+    /** Returns the estimated compression ratio of the chosen encoding. */
+    double ratio() const { return double(plain().size) / std::max<std::size_t>(chosen().size, 1); }
+
+    friend std::ostream & operator<<(std::ostream &out, const ColumnAnalysis &analysis) {
+        const double num_rows = std::max<std::size_t>(analysis.num_rows, 1);
+        return out << analysis.attr.name << " (" << analysis.attr.type_name() << ' ' << analysis.attr.size << "B): "
+                   << encoding_name(analysis.encoding) << ", " << analysis.plain().size / num_rows << " -> "
+                   << analysis.chosen().size / num_rows << " bytes per row (" << analysis.ratio() << "x), "
+                   << analysis.chosen().decode_time / num_rows << " ns per row";
+    }
+    DECLARE_DUMP
+};
+
+/** Samples column, which holds the values of attr, estimates the size and decode time of every encoding applicable to
+ * attr, and chooses an encoding according to policy. */
+ColumnAnalysis analyze_column(const Attribute &attr, const ColumnBase &column,
+                              const CompressionPolicy &policy = CompressionPolicy());
+
+/** Analyzes every column of store, whose schema is relation. */
+std::vector<ColumnAnalysis> analyze_columnstore(const Relation &relation, const ColumnStore &store,
+                                                const CompressionPolicy &policy = CompressionPolicy());
+
+/** Returns a new column holding the elements of the uncompressed column, which holds the values of attr, encoded with
+ * encoding.  The encoding must be applicable to attr. */
+ColumnBase * encode_column(const Attribute &attr, const GenericColumn &column, Encoding encoding);
+
+/** Returns a new ColumnStore holding the rows of the uncompressed store, with every column encoded as chosen by its
+ * analysis. */
+ColumnStore * compress_columnstore(const ColumnStore &store, const std::vector<ColumnAnalysis> &analyses);
+
+/** Returns a new ColumnStore holding the rows of the uncompressed store, whose schema is relation, with every column
+ * encoded as chosen by analyze_column() under policy.  Columns are independent, hence they are analyzed and encoded in
+ * parallel on pool, one column per task.  If analyses is not nullptr, it receives the analyses of the columns. */
+ColumnStore * compress(const Relation &relation, const ColumnStore &store,
+                       const CompressionPolicy &policy = CompressionPolicy(), ThreadPool &pool = ThreadPool::Default(),
+                       std::vector<ColumnAnalysis> *analyses = nullptr);
+
 }
@@ -0,0 +1,59 @@
+/*--- Kernels.hpp ------------------------------------------------------------------------------------------------------
+ *
+ * This file provides SIMD kernels for hot loops of queries.  Every kernel has a scalar implementation and
+ * implementations for AVX2 and AVX-512, which are selected at runtime according to the instruction sets the CPU
+ * supports.
+ *
+ *--------------------------------------------------------------------------------------------------------------------*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace dbms {
+
+/** The instruction sets kernels are implemented for, in ascending order of preference. */
+enum ISA { ISA_Scalar, ISA_AVX2, ISA_AVX512 };
+
+/** Returns the most preferred instruction set the CPU supports. */
+ISA best_isa();
+
+/** Returns true iff the CPU supports isa. */
+bool is_supported(ISA isa);
+
+/** Computes the sum of price * (100 - discount) * (100 + tax) over the n rows with date < threshold, where the values
+ * of row i are price[i], discount[i], tax[i], and date[i].  Prices, discounts, and taxes are fixed-point numbers with
+ * two decimal places.  The kernel is executed with isa, which the CPU must support. */
+int64_t sum_discounted_price(const uint32_t *date, const int64_t *price, const int64_t *discount, const int64_t *tax,
+                             std::size_t n, uint32_t threshold, ISA isa = best_isa());
+
+/** Same as above for n rows of row_size bytes at rows, that hold the values at the given offsets. */
+int64_t sum_discounted_price(const void *rows, std::size_t row_size, std::size_t date_offset, std::size_t price_offset,
+                             std::size_t discount_offset, std::size_t tax_offset, std::size_t n, uint32_t threshold,
+                             ISA isa = best_isa());
+
+/** The largest number of bits per integer the vectorized bit unpacking kernels support.  Wider integers are unpacked by
+ * the scalar kernel. */
+constexpr unsigned MAX_VECTOR_UNPACK_BITS = 56;
+
+/** Unpacks the n integers of bits bits starting at index first of the bit-packed array packed, and writes each integer
+ * plus reference to out.  Integer i occupies bits i * bits to (i + 1) * bits - 1 of packed, where bit j is bit j % 64
+ * of word j / 64.  The 8 bytes following an integer must be readable.  The kernel is executed with isa, which the CPU
+ * must support. */
+void unpack_bits(const uint64_t *packed, unsigned bits, std::size_t first, std::size_t n, uint64_t reference,
+                 uint64_t *out, ISA isa = best_isa());
+
+/** Returns a bitmask of the bytes of the 64 bytes at block that equal delimiter or a newline, where bit i stands for
+ * block[i].  The kernel is executed with isa, which the CPU must support. */
+uint64_t find_structurals(const char *block, char delimiter, ISA isa = best_isa());
+
+/** Replaces each of the n values by the sum of initial and all values up to and including it.  Sums wrap around.  The
+ * kernel is executed with isa, which the CPU must support. */
+void prefix_sum(uint32_t *values, std::size_t n, uint32_t initial, ISA isa = best_isa());
+/** Same as above for 64 bit values. */
+void prefix_sum(uint64_t *values, std::size_t n, uint64_t initial, ISA isa = best_isa());
+
+}
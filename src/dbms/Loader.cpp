@@ -2,220 +2,518 @@
 
 #include "dbms/util.hpp"
 #include "impl/ColumnStore.hpp"
+#include "impl/Loader.hpp"
 #include "impl/RowStore.hpp"
+#include <algorithm>
+#include <cctype>
 #include <cstring>
 #include <err.h>
+#include <fcntl.h>
 #include <limits>
+#include <new>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 
 using namespace dbms;
 
-bool isnum(int c) { return '0' <= c and c <= '9'; }
+/** Parses the leading decimal digits of [begin, end) and sets begin to the first non-digit. */
+static int64_t parse_digits(const char *&begin, const char *end)
+{
+    int64_t res = 0;
+    while (begin != end and unsigned(*begin - '0') < 10)
+        res = res * 10 + (*begin++ - '0');
+    return res;
+}
+
+/** Parses an integer with an optional sign from [begin, end).  Returns false if [begin, end) is not such an integer. */
+static bool parse_integer(const char *begin, const char *end, int64_t &res)
+{
+    const bool is_negative = begin != end and *begin == '-';
+    if (is_negative) ++begin;
+    const char *digits = begin;
+    const int64_t value = parse_digits(begin, end);
+    res = is_negative ? -value : value;
+    return begin == end and begin != digits;
+}
+
+/** Parses a fixed point number with at most two decimals, e.g. -123.45 or 5, from [begin, end) as an integer in
+ * hundredths.  Returns false if [begin, end) is not such a number. */
+static bool parse_fixedpoint(const char *begin, const char *end, int64_t &res)
+{
+    const bool is_negative = begin != end and *begin == '-';
+    if (is_negative) ++begin;
+    const char *digits = begin;
+    int64_t value = parse_digits(begin, end) * 100;
+    std::size_t num_digits = begin - digits;
+    if (begin != end and *begin == '.') {
+        const char *decimals = ++begin;
+        const int64_t post = parse_digits(begin, end);
+        switch (begin - decimals) {
+            case 0: break;
+            case 1: value += post * 10; break;
+            case 2: value += post; break;
+            default: return false;
+        }
+        num_digits += begin - decimals;
+    }
+    res = is_negative ? -value : value;
+    return begin == end and num_digits;
+}
+
+/** Parses a date from [begin, end) into the encoding of date_to_int().  Returns false if [begin, end) is not a date in
+ * the format YYYY-MM-DD, where leading zeros may be omitted. */
+static bool parse_date(const char *begin, const char *end, uint32_t &date)
+{
+    /* Fast path for well-formed dates in the format YYYY-MM-DD. */
+    if (end - begin == 10 and parse_date_swar(begin, date))
+        return true;
+
+    /* Slow path for everything else, e.g. dates without leading zeros. */
+    uint32_t parts[3];
+    for (unsigned i = 0; i != 3; ++i) {
+        if (i) {
+            if (begin == end or *begin != '-') return false;
+            ++begin; // skip the dash
+        }
+        const char *digits = begin;
+        parts[i] = parse_digits(begin, end);
+        if (begin == digits or begin - digits > 4) return false;
+    }
+    if (begin != end or parts[1] - 1 >= 12 or parts[2] - 1 >= 31) return false;
+    date = date_to_int(parts[0], parts[1], parts[2]);
+    return true;
+}
+
+
+/*----- Field parse functions of parse plans -------------------------------------------------------------------------*/
+
+template<typename T>
+static bool parse_integer_field(const char *begin, const char *end, void *dest, std::size_t)
+{
+    int64_t value;
+    const bool is_valid = parse_integer(begin, end, value);
+    const T res = value;
+    memcpy(dest, &res, sizeof(res));
+    return is_valid and res == value;
+}
+
+template<typename T>
+static bool parse_fixedpoint_field(const char *begin, const char *end, void *dest, std::size_t)
+{
+    int64_t value;
+    const bool is_valid = parse_fixedpoint(begin, end, value);
+    const T res = value;
+    memcpy(dest, &res, sizeof(res));
+    return is_valid and res == value;
+}
+
+static bool parse_date_field(const char *begin, const char *end, void *dest, std::size_t)
+{
+    uint32_t res = 0;
+    const bool is_valid = parse_date(begin, end, res);
+    memcpy(dest, &res, sizeof(res));
+    return is_valid;
+}
+
+static bool parse_character_field(const char *begin, const char *end, void *dest, std::size_t)
+{
+    *static_cast<char*>(dest) = begin != end ? *begin : 0;
+    return end - begin <= 1;
+}
+
+template<typename T>
+static bool parse_floating_field(const char *begin, const char *end, void *dest, std::size_t)
+{
+    char buf[64];
+    const std::size_t len = std::min<std::size_t>(end - begin, sizeof(buf) - 1);
+    memcpy(buf, begin, len);
+    buf[len] = 0;
+    char *parsed_end;
+    const T res = strtod(buf, &parsed_end);
+    memcpy(dest, &res, sizeof(res));
+    return len != 0 and parsed_end == buf + (end - begin);
+}
+
+static bool parse_chars_field(const char *begin, const char *end, void *dest, std::size_t size)
+{
+    const std::size_t len = std::min<std::size_t>(end - begin, size - 1);
+    memcpy(dest, begin, len);
+    static_cast<char*>(dest)[len] = 0;
+    return true;
+}
+
+static bool parse_varchar_field(const char *begin, const char *end, void *dest, std::size_t)
+{
+    std::string str(begin, end);
+    new (dest) Varchar(str.c_str());
+    return true;
+}
 
-Loader::Loader(const char *filename, const int delimiter)
+Loader::Loader(const char *filename, const int delimiter, ISA isa)
     : delimiter(delimiter)
+    , isa(isa)
     , filename_(nonnull(filename))
-    , file_(fopen(filename, "r"))
+    , data_(nullptr)
+    , end_(nullptr)
+    , pos_(nullptr)
+    , is_mapped_(false)
+    , owns_input_(true)
 {
-    if (not file_)
+    const int fd = open(filename_, O_RDONLY);
+    if (fd == -1)
         err(EXIT_FAILURE, "Failed to open file '%s'", filename_);
+
+    struct stat st;
+    if (fstat(fd, &st))
+        err(EXIT_FAILURE, "Failed to stat file '%s'", filename_);
+
+    if (S_ISREG(st.st_mode)) {
+        const std::size_t size = st.st_size;
+        if (size) {
+            void *addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr != MAP_FAILED) {
+                /* The file is parsed front to back exactly once.  Tell the kernel to read ahead aggressively and to
+                 * back the mapping with huge pages, if possible.  Both are hints, hence errors are ignored. */
+                madvise(addr, size, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+                madvise(addr, size, MADV_HUGEPAGE);
+#endif
+                data_ = static_cast<const char*>(addr);
+                end_ = data_ + size;
+                is_mapped_ = true;
+            }
+        } else {
+            is_mapped_ = true; // nothing to map, nothing to read
+        }
+    }
+
+    if (not is_mapped_) {
+        /* Fall back to reading the entire input into a heap allocated buffer. */
+        std::size_t size = 0;
+        std::size_t capacity = S_ISREG(st.st_mode) ? st.st_size : PAGESIZE;
+        char *buf = static_cast<char*>(malloc(capacity));
+        for (;;) {
+            if (size == capacity)
+                buf = static_cast<char*>(realloc(buf, capacity *= 2));
+            if (not buf)
+                err(EXIT_FAILURE, "Failed to allocate buffer for file '%s'", filename_);
+            const ssize_t n = ::read(fd, buf + size, capacity - size);
+            if (n == -1)
+                err(EXIT_FAILURE, "Failed to read file '%s'", filename_);
+            if (n == 0) break;
+            size += n;
+        }
+        data_ = buf;
+        end_ = buf + size;
+    }
+    pos_ = block_ = data_;
+    mask_ = data_ != end_ ? scan_block(block_) : 0;
+
+    if (close(fd))
+        warn("Failed to close file '%s'", filename_);
+}
+
+Loader::Loader(const Loader &parent, const char *begin, const char *end)
+    : delimiter(parent.delimiter)
+    , isa(parent.isa)
+    , filename_(parent.filename_)
+    , data_(begin)
+    , end_(end)
+    , pos_(begin)
+    , is_mapped_(parent.is_mapped_)
+    , owns_input_(false)
+    , block_(begin)
+    , mask_(begin != end ? scan_block(begin) : 0)
+    , offsets_(parent.offsets_)
+{
+    assert(parent.data_ <= begin and begin <= end and end <= parent.end_, "chunk out of bounds");
 }
 
 Loader::~Loader()
 {
-    if (fclose(file_))
-        warn("Failed to close file '%s'", filename_);
+    if (not owns_input_)
+        return;
+    if (is_mapped_) {
+        if (data_ and munmap(const_cast<char*>(data_), end_ - data_))
+            warn("Failed to unmap file '%s'", filename_);
+    } else {
+        free(const_cast<char*>(data_));
+    }
 }
 
 void Loader::parse_header(const Relation &relation)
 {
-    offsets_.reserve(relation.size());
+    offsets_.clear();
+    for (;;) {
+        const char *end = next_structural();
+        std::string name(pos_, end);
+        offsets_.push_back(relation.has(name) ? relation[name].offset() : SKIP_FIELD);
+        const bool is_last = end == end_ or *end == '\n';
+        skip_field(end);
+        if (is_last) break;
+    }
 
-    for (std::size_t i = 0; i != relation.size(); ++i) {
-        std::string name(read());
-        const Attribute &attr = relation[name];
-        offsets_.push_back(attr.offset());
+    for (auto &attr : relation) {
+        if (std::find(offsets_.begin(), offsets_.end(), attr.offset()) == offsets_.end())
+            errx(EXIT_FAILURE, "Attribute '%s' is missing in file '%s'", attr.name.c_str(), filename_);
     }
 }
 
-const char * Loader::read()
+uint64_t Loader::scan_block(const char *block) const
 {
-    strbuf_.clear();
-    int c = getc_unlocked(file_);
-    while (not feof(file_) and c != delimiter and c != '\n') {
-        strbuf_.push_back(c);
-        c = getc_unlocked(file_);
+    alignas(64) char tail[64];
+    if (end_ - block < 64) {
+        /* Copy the last, partial block to avoid reading past the end of the input.  Zero bytes are neither delimiters
+         * nor newlines. */
+        memset(tail, 0, sizeof(tail));
+        memcpy(tail, block, end_ - block);
+        block = tail;
     }
-    strbuf_.push_back(0);
 
+    return find_structurals(block, delimiter, isa);
+}
+
+const char * Loader::read()
+{
+    const char *end = next_structural();
+    strbuf_.assign(pos_, end);
+    strbuf_.push_back(0);
+    skip_field(end);
     return &strbuf_[0];
 }
 
 int64_t Loader::read_int()
 {
-    int64_t res = 0;
-    int c = '0';
-    while (isnum(c)) {
-        res = res * 10 + (c - '0');
-        c = getc_unlocked(file_);
-    }
+    const char *end = next_structural();
+    int64_t res;
+    if (not parse_integer(pos_, end, res))
+        malformed_field(end);
+    skip_field(end);
     return res;
 }
 
 int64_t Loader::read_fixedpoint()
 {
-    int64_t pre = read_int();
-    int64_t post = read_int();
-    return pre * 100 + post;
+    const char *end = next_structural();
+    int64_t res;
+    if (not parse_fixedpoint(pos_, end, res))
+        malformed_field(end);
+    skip_field(end);
+    return res;
 }
 
 int Loader::read_char() {
-    int c = getc_unlocked(file_);
-    getc_unlocked(file_);
+    const char *end = next_structural();
+    int c = pos_ != end ? static_cast<unsigned char>(*pos_) : 0;
+    skip_field(end);
     return c;
 }
 
 uint32_t Loader::read_date()
 {
-    uint32_t year, month, day;
-    fscanf(file_, "%u-%u-%u", &year, &month, &day);
-    getc_unlocked(file_);
-    return date_to_int(year, month, day);
+    const char *end = next_structural();
+    uint32_t res;
+    if (not parse_date(pos_, end, res))
+        malformed_field(end);
+    skip_field(end);
+    return res;
 }
 
-std::size_t Loader::load_LineItem(const char *filename, const Relation &relation, RowStore &store,
-                                  const std::size_t max_rows)
+void Loader::malformed_field(const char *field_end) const
 {
-    Loader loader(filename, '|');
-    loader.parse_header(relation);
+    const std::size_t line = 1 + std::count(data_, pos_, '\n');
+    errx(EXIT_FAILURE, "Malformed field '%.*s' in line %zu of file '%s'", int(field_end - pos_), pos_,
+         line, filename_);
+}
 
-    std::size_t num_rows = 0;
-    while (num_rows != max_rows) {
-        uint32_t orderkey        = loader.read_int();
-        uint32_t partkey         = loader.read_int();
-        uint32_t suppkey         = loader.read_int();
-        int32_t linenumber       = loader.read_int();
-        int64_t quantity         = loader.read_int();
-        int64_t extendedprice    = loader.read_fixedpoint();
-        int64_t discount         = loader.read_fixedpoint();
-        int64_t tax              = loader.read_fixedpoint();
-        char returnflag          = loader.read_char();
-        char linestatus          = loader.read_char();
-        uint32_t shipdate        = loader.read_date();
-        uint32_t commitdate      = loader.read_date();
-        uint32_t receiptdate     = loader.read_date();
-        Char<26> shipinstruct;     loader.read(shipinstruct);
-        Char<11> shipmode;         loader.read(shipmode);
-        Char<45> comment;          loader.read(comment);
-
-        if (feof(loader.file_)) break;
-
-        auto it = store.append(1);
-        ++num_rows;
+Loader::plan_type Loader::compile_plan(const Relation &relation) const
+{
+    /* Determine the textual format of Int attributes from the fields of the first rows.  A field is parsed as a date
+     * if all sampled values are dates, as a character if all are single characters and not all of them digits, and as
+     * a fixed point number if any value has a decimal point.  Rows that do not match the format of a field fail to
+     * parse later on. */
+    constexpr std::size_t SAMPLE_ROWS = 1000;
+    struct Sample
+    {
+        bool is_empty = true; ///< whether all values are empty
+        bool is_date = true; ///< whether all values are dates
+        bool is_character = true; ///< whether all values are single characters
+        bool has_letter = false; ///< whether any value is a single character that is not a digit
+        bool has_point = false; ///< whether any value has a decimal point
+    };
+    std::vector<Sample> samples(offsets_.size());
+    {
+        const char *row = pos_;
+        for (std::size_t r = 0; r != SAMPLE_ROWS and row != end_; ++r) {
+            const char *eol = static_cast<const char*>(memchr(row, '\n', end_ - row));
+            if (not eol) eol = end_;
+            const char *field = row;
+            for (std::size_t i = 0; i != offsets_.size() and field <= eol; ++i) {
+                const char *field_end = static_cast<const char*>(memchr(field, delimiter, eol - field));
+                if (not field_end) field_end = eol;
+                if (const std::size_t len = field_end - field) {
+                    Sample &sample = samples[i];
+                    uint32_t date;
+                    sample.is_empty = false;
+                    sample.is_date = sample.is_date and parse_date(field, field_end, date);
+                    sample.is_character = sample.is_character and len == 1;
+                    sample.has_letter = sample.has_letter or (len == 1 and not isdigit(uint8_t(*field)));
+                    sample.has_point = sample.has_point or memchr(field, '.', len);
+                }
+                field = field_end + 1;
+            }
+            row = eol == end_ ? end_ : eol + 1;
+        }
+    }
 
-        it.get<uint32_t>(loader.offsets_[0]) = orderkey;
-        it.get<uint32_t>(loader.offsets_[1]) = partkey;
-        it.get<uint32_t>(loader.offsets_[2]) = suppkey;
-        it.get< int32_t>(loader.offsets_[3]) = linenumber;
-        it.get< int64_t>(loader.offsets_[4]) = quantity;
-        it.get< int64_t>(loader.offsets_[5]) = extendedprice;
-        it.get< int64_t>(loader.offsets_[6]) = discount;
-        it.get< int64_t>(loader.offsets_[7]) = tax;
-        it.get<unsigned char>(loader.offsets_[8]) = returnflag;
-        it.get<unsigned char>(loader.offsets_[9]) = linestatus;
-        it.get<uint32_t>(loader.offsets_[10]) = shipdate;
-        it.get<uint32_t>(loader.offsets_[11]) = commitdate;
-        it.get<uint32_t>(loader.offsets_[12]) = receiptdate;
-        it.get<Char<26>>(loader.offsets_[13]) = shipinstruct;
-        it.get<Char<11>>(loader.offsets_[14]) = shipmode;
-        it.get<Char<45>>(loader.offsets_[15]) = comment;
+    plan_type plan;
+    plan.reserve(offsets_.size());
+    std::size_t num_skipped = 0;
+    for (std::size_t i = 0; i != offsets_.size(); ++i) {
+        if (offsets_[i] == SKIP_FIELD) {
+            ++num_skipped;
+            continue;
+        }
+        const Attribute &attr = relation[offsets_[i]];
+        const Sample &sample = samples[i];
+        ParseStep step{ nullptr, attr.offset(), attr.size, num_skipped };
+        num_skipped = 0;
+
+        switch (attr.type) {
+            case Attribute::TY_Int: {
+                if (not sample.is_empty and sample.is_date and attr.size == 4)
+                    step.parse = parse_date_field;
+                else if (sample.is_character and sample.has_letter and attr.size == 1)
+                    step.parse = parse_character_field;
+                else if (sample.has_point)
+                    switch (attr.size) {
+                        case 4: step.parse = parse_fixedpoint_field<int32_t>; break;
+                        case 8: step.parse = parse_fixedpoint_field<int64_t>; break;
+                    }
+                else
+                    switch (attr.size) {
+                        case 1: step.parse = parse_integer_field<int8_t>; break;
+                        case 2: step.parse = parse_integer_field<int16_t>; break;
+                        case 4: step.parse = parse_integer_field<int32_t>; break;
+                        case 8: step.parse = parse_integer_field<int64_t>; break;
+                    }
+                break;
+            }
+
+            case Attribute::TY_Float:
+                step.parse = parse_floating_field<float>;
+                break;
+
+            case Attribute::TY_Double:
+                step.parse = parse_floating_field<double>;
+                break;
+
+            case Attribute::TY_Char:
+                step.parse = parse_chars_field;
+                break;
+
+            case Attribute::TY_Varchar:
+                step.size = sizeof(Varchar);
+                step.parse = parse_varchar_field;
+                break;
+
+            default: dbms_unreachable("unknown attribute type");
+        }
+        if (not step.parse)
+            errx(EXIT_FAILURE, "Unsupported format of attribute '%s' in file '%s'", attr.name.c_str(), filename_);
+        plan.push_back(step);
     }
+    if (num_skipped)
+        plan.push_back(ParseStep{ nullptr, 0, 0, num_skipped }); // skip the trailing fields of the row
 
-    return num_rows;
+    return plan;
 }
 
-std::size_t Loader::load_LineItem(const char *filename, const Relation &relation, ColumnStore &store,
-                                  const std::size_t max_rows)
+std::size_t Loader::parse(Loader &loader, const plan_type &plan, RowStore &store, std::size_t max_rows)
 {
-    Loader loader(filename, '|');
-    loader.parse_header(relation);
+    std::vector<std::size_t> offsets;
+    for (auto &step : plan)
+        offsets.push_back(step.parse ? store.offset_of(step.attr) : 0);
 
     std::size_t num_rows = 0;
-    while (num_rows != max_rows) {
-        uint32_t orderkey        = loader.read_int();
-        uint32_t partkey         = loader.read_int();
-        uint32_t suppkey         = loader.read_int();
-        int32_t linenumber       = loader.read_int();
-        int64_t quantity         = loader.read_int();
-        int64_t extendedprice    = loader.read_fixedpoint();
-        int64_t discount         = loader.read_fixedpoint();
-        int64_t tax              = loader.read_fixedpoint();
-        char returnflag          = loader.read_char();
-        char linestatus          = loader.read_char();
-        uint32_t shipdate        = loader.read_date();
-        uint32_t commitdate      = loader.read_date();
-        uint32_t receiptdate     = loader.read_date();
-        Char<26> shipinstruct;     loader.read(shipinstruct);
-        Char<11> shipmode;         loader.read(shipmode);
-        Char<45> comment;          loader.read(comment);
-
-        if (feof(loader.file_)) break;
-
+    while (num_rows != max_rows and not loader.eof()) {
+        uint8_t *row = static_cast<uint8_t*>(*store.append(1));
+        for (std::size_t i = 0, end = plan.size(); i != end; ++i) {
+            loader.skip_fields(plan[i].skip);
+            if (not plan[i].parse) break;
+            const char *field_end = loader.next_structural();
+            if (not plan[i].parse(loader.pos_, field_end, row + offsets[i], plan[i].size))
+                loader.malformed_field(field_end);
+            loader.skip_field(field_end);
+        }
         ++num_rows;
-
-        store.get_column<uint32_t>(loader.offsets_[0]).push_back(orderkey);
-        store.get_column<uint32_t>(loader.offsets_[1]).push_back(partkey);
-        store.get_column<uint32_t>(loader.offsets_[2]).push_back(suppkey);
-        store.get_column< int32_t>(loader.offsets_[3]).push_back(linenumber);
-        store.get_column< int64_t>(loader.offsets_[4]).push_back(quantity);
-        store.get_column< int64_t>(loader.offsets_[5]).push_back(extendedprice);
-        store.get_column< int64_t>(loader.offsets_[6]).push_back(discount);
-        store.get_column< int64_t>(loader.offsets_[7]).push_back(tax);
-        store.get_column<char>(loader.offsets_[8]).push_back(returnflag);
-        store.get_column<char>(loader.offsets_[9]).push_back(linestatus);
-        store.get_column<uint32_t>(loader.offsets_[10]).push_back(shipdate);
-        store.get_column<uint32_t>(loader.offsets_[11]).push_back(commitdate);
-        store.get_column<uint32_t>(loader.offsets_[12]).push_back(receiptdate);
-        store.get_column<Char<26>>(loader.offsets_[13]).push_back(shipinstruct);
-        store.get_column<Char<11>>(loader.offsets_[14]).push_back(shipmode);
-        store.get_column<Char<45>>(loader.offsets_[15]).push_back(comment);
     }
 
     return num_rows;
 }
 
-std::size_t Loader::load_Orders(const char *filename, const Relation &relation, ColumnStore &store,
-                                const std::size_t max_rows)
+std::size_t Loader::parse(Loader &loader, const plan_type &plan, ColumnStore &store, std::size_t max_rows)
 {
-    Loader loader(filename, '|');
-    loader.parse_header(relation);
+    std::vector<GenericColumn*> columns;
+    for (auto &step : plan) {
+        if (not step.parse) {
+            columns.push_back(nullptr);
+            continue;
+        }
+        ColumnBase &column = store.get_column(step.attr);
+        assert(not column.is_compressed(), "can only parse into uncompressed columns");
+        columns.push_back(static_cast<GenericColumn*>(&column));
+    }
 
     std::size_t num_rows = 0;
-    while (num_rows != max_rows) {
-        uint32_t orderkey = loader.read_int();
-        uint32_t custkey = loader.read_int();
-        char orderstatus = loader.read_char();
-        uint64_t totalprice = loader.read_fixedpoint();
-        uint32_t orderdate = loader.read_date();
-        Char<16> orderpriority; loader.read(orderpriority);
-        Char<16> clerk; loader.read(clerk);
-        int32_t shippriority = loader.read_int();
-        Char<80> comment; loader.read(comment);
-
-        if (feof(loader.file_)) break;
-
+    while (num_rows != max_rows and not loader.eof()) {
+        for (std::size_t i = 0, end = plan.size(); i != end; ++i) {
+            loader.skip_fields(plan[i].skip);
+            if (not plan[i].parse) break;
+            const char *field_end = loader.next_structural();
+            if (not plan[i].parse(loader.pos_, field_end, columns[i]->append(1), plan[i].size))
+                loader.malformed_field(field_end);
+            loader.skip_field(field_end);
+        }
         ++num_rows;
-
-        store.get_column<uint32_t>(loader.offsets_[0]).push_back(orderkey);
-        store.get_column<uint32_t>(loader.offsets_[1]).push_back(custkey);
-        store.get_column<char>(loader.offsets_[2]).push_back(orderstatus);
-        store.get_column<uint64_t>(loader.offsets_[3]).push_back(totalprice);
-        store.get_column<uint32_t>(loader.offsets_[4]).push_back(orderdate);
-        store.get_column<Char<16>>(loader.offsets_[5]).push_back(orderpriority);
-        store.get_column<Char<16>>(loader.offsets_[6]).push_back(clerk);
-        store.get_column<int32_t>(loader.offsets_[7]).push_back(shippriority);
-        store.get_column<Char<80>>(loader.offsets_[8]).push_back(comment);
     }
 
     return num_rows;
 }
+
+std::size_t Loader::load(const char *filename, const Relation &relation, RowStore &store,
+                         const std::size_t max_rows, unsigned num_threads)
+{
+    Loader loader(filename, '|');
+    loader.parse_header(relation);
+    const plan_type plan = loader.compile_plan(relation);
+    return load_parallel(loader, store, max_rows, num_threads,
+                         [&]() { return RowStore::Create_Like(store); },
+                         [&](Loader &loader, RowStore &store, std::size_t max_rows) {
+                             return parse(loader, plan, store, max_rows);
+                         });
+}
+
+std::size_t Loader::load(const char *filename, const Relation &relation, ColumnStore &store,
+                         const std::size_t max_rows, unsigned num_threads)
+{
+    Loader loader(filename, '|');
+    loader.parse_header(relation);
+    const plan_type plan = loader.compile_plan(relation);
+
+    /* Compressed columns cannot be parsed into.  Parse chunks into uncompressed columns and let the columns of store
+     * encode them. */
+    bool in_place = true;
+    for (std::size_t i = 0; i != relation.size(); ++i)
+        in_place = in_place and not store.get_column(i).is_compressed();
+
+    return load_parallel(loader, store, max_rows, num_threads,
+                         [&]() { return ColumnStore::Create_Naive(relation); },
+                         [&](Loader &loader, ColumnStore &store, std::size_t max_rows) {
+                             return parse(loader, plan, store, max_rows);
+                         },
+                         in_place);
+}
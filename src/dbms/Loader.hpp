@@ -1,6 +1,7 @@
 #pragma once
 
 #include "dbms/assert.hpp"
+#include "dbms/Kernels.hpp"
 #include "dbms/Store.hpp"
 #include <cstdint>
 #include <cstdio>
@@ -10,17 +11,70 @@
 
 namespace dbms {
 
+/**
+ * This class implements a loader for delimiter separated text files.
+ * The input file is mapped into memory and parsed directly from the mapped buffer, without copying.  If the file
+ * cannot be mapped (e.g. because it is a pipe), it is read into a heap allocated buffer instead.
+ *
+ * Fields are located through a structural index: the input is scanned in blocks of 64 bytes with SIMD compares, and the
+ * positions of all delimiters and newlines within a block are recorded in a bitmask (see find_structurals()).  The
+ * field readers take the end of the current field from that bitmask and parse the field from the buffer without
+ * testing each character for a delimiter.
+ *
+ * The load functions are driven by the relation: the header of the file names the attribute of every field, and a
+ * parse plan is compiled once from the types of these attributes, with one specialized parse function per field.  The
+ * textual format of Int attributes (integer, fixed point number with at most two decimals, date, or single character)
+ * is determined from a sample of the first rows of the file.  The rows are then parsed by executing the plan.  A field
+ * that does not match the format of its attribute is an error, e.g. a fixed point number in a field sampled as
+ * integer.
+ *
+ * The relation may be a projection of the attributes in the file (see Relation's projection constructor): fields whose
+ * header name is not an attribute of the relation are skipped over without being parsed or stored.
+ *
+ * The input is split at line boundaries into chunks, and the chunks are parsed concurrently on num_threads threads.
+ * Each chunk is parsed into a store of its own, and the chunks are appended in input order as soon as they are parsed,
+ * such that the resulting store is identical to the one of a sequential load.  Workers parse at most num_threads
+ * chunks ahead of the append, which bounds the memory of parsed chunks when appending is slower than parsing, e.g.
+ * when encoding compressed columns.  A num_threads of 0 selects the number of hardware threads.
+ *
+ * A ColumnStore may consist of compressed columns, e.g. created with ColumnStore::Create_Explicit().  Such a store is
+ * loaded chunk by chunk: each chunk is parsed into uncompressed columns, which are then encoded into the columns of the
+ * store and released.  Hence the uncompressed table is never materialized as a whole.
+ */
 struct Loader
 {
+    /** Loads at most max_rows rows of the table in file filename into store and returns the number of loaded rows.
+     * The store must have been created for relation. */
+    static std::size_t load(const char *filename, const Relation &relation, RowStore &store,
+                            const std::size_t max_rows = std::numeric_limits<std::size_t>::max(),
+                            unsigned num_threads = 0);
+    static std::size_t load(const char *filename, const Relation &relation, ColumnStore &store,
+                            const std::size_t max_rows = std::numeric_limits<std::size_t>::max(),
+                            unsigned num_threads = 0);
+
     static std::size_t load_LineItem(const char *filename, const Relation &relation, RowStore &store,
-                                     const std::size_t max_rows = std::numeric_limits<std::size_t>::max());
+                                     const std::size_t max_rows = std::numeric_limits<std::size_t>::max(),
+                                     unsigned num_threads = 0) {
+        return load(filename, relation, store, max_rows, num_threads);
+    }
     static std::size_t load_LineItem(const char *filename, const Relation &relation, ColumnStore &store,
-                                     const std::size_t max_rows = std::numeric_limits<std::size_t>::max());
+                                     const std::size_t max_rows = std::numeric_limits<std::size_t>::max(),
+                                     unsigned num_threads = 0) {
+        return load(filename, relation, store, max_rows, num_threads);
+    }
     static std::size_t load_Orders(const char *filename, const Relation &relation, ColumnStore &store,
-                                   const std::size_t max_rows = std::numeric_limits<std::size_t>::max());
+                                   const std::size_t max_rows = std::numeric_limits<std::size_t>::max(),
+                                   unsigned num_threads = 0) {
+        return load(filename, relation, store, max_rows, num_threads);
+    }
 
-    Loader(const char *filename, const int delimiter);
+    /** Opens the file filename.  The structural index is built with isa, which the CPU must support. */
+    Loader(const char *filename, const int delimiter, ISA isa = best_isa());
     ~Loader();
+    Loader(const Loader&) = delete;
+
+    /** Returns true iff the entire input has been consumed. */
+    bool eof() const { return pos_ == end_; }
 
     void parse_header(const Relation &relation);
     const char * read();
@@ -30,25 +84,89 @@ struct Loader
     int read_char();
     uint32_t read_date();
 
+    /** Parses the remaining input of loader into store, using num_threads threads.  parse(loader, store, max_rows)
+     * must parse at most max_rows rows from loader into store and return the number of parsed rows.  make_store()
+     * must return an empty store that can be appended to store.  If in_place is false, parse is never applied to store
+     * itself, and all rows are parsed into stores created by make_store().  At most num_threads stores created by
+     * make_store() exist at any time.  Defined in impl/Loader.hpp. */
+    template<typename Store, typename MakeStore, typename Parse>
+    static std::size_t load_parallel(Loader &loader, Store &store, std::size_t max_rows, unsigned num_threads,
+                                     MakeStore make_store, Parse parse, bool in_place = true);
+
     const int delimiter;
+    const ISA isa; ///< the instruction set to build the structural index with
     private:
+    /** Creates a loader for the part [begin, end) of the input of parent.  The loader does not own the input. */
+    Loader(const Loader &parent, const char *begin, const char *end);
+
+    /** A step of a parse plan.  Skips skip fields of a row, then parses the next field into the attribute with index
+     * attr.  The last step of a plan may have no parse function and only skip the trailing fields of the row. */
+    struct ParseStep
+    {
+        /** Parses the field [begin, end) into size bytes at dest.  Returns false if the field is malformed. */
+        using parse_fn = bool(*)(const char *begin, const char *end, void *dest, std::size_t size);
+
+        parse_fn parse;
+        std::size_t attr; ///< the index of the attribute in the relation
+        std::size_t size; ///< the size of the attribute in bytes
+        std::size_t skip; ///< the number of fields to skip before the field to parse
+    };
+    using plan_type = std::vector<ParseStep>;
+
+    /** Compiles the parse plan for the fields named in the header.  Must be called after parse_header(), and does not
+     * consume any input. */
+    plan_type compile_plan(const Relation &relation) const;
+
+    /** Parses at most max_rows rows from loader into store by executing plan.  Returns the number of parsed rows. */
+    static std::size_t parse(Loader &loader, const plan_type &plan, RowStore &store, std::size_t max_rows);
+    static std::size_t parse(Loader &loader, const plan_type &plan, ColumnStore &store, std::size_t max_rows);
+
+    /** Returns the position of the next delimiter or newline at or after the current read position, or the end of the
+     * input if there is none. */
+    const char * next_structural() {
+        while (not mask_) {
+            if (end_ - block_ <= 64) return end_;
+            block_ += 64;
+            mask_ = scan_block(block_);
+        }
+        const char *pos = block_ + __builtin_ctzll(mask_);
+        mask_ &= mask_ - 1;
+        return pos;
+    }
+    /** Returns a bitmask of the delimiters and newlines in the 64 bytes starting at block.  Bytes past the end of the
+     * input are not accessed. */
+    uint64_t scan_block(const char *block) const;
+    /** Reports the field from the read position to field_end as malformed and exits. */
+    [[noreturn]] void malformed_field(const char *field_end) const;
+    /** Moves the read position past the field ending at field_end. */
+    void skip_field(const char *field_end) { pos_ = field_end == end_ ? end_ : field_end + 1; }
+    /** Moves the read position past the next n fields, without parsing them. */
+    void skip_fields(std::size_t n) {
+        while (n--) skip_field(next_structural());
+    }
+
     const char *filename_;
-    FILE *file_;
-    std::vector<std::size_t> offsets_;
+    const char *data_; ///< the start of the input buffer
+    const char *end_; ///< the end of the input buffer
+    const char *pos_; ///< the current read position within the input buffer
+    bool is_mapped_; ///< whether the input buffer is a memory mapping of the file
+    bool owns_input_; ///< whether the input buffer is owned by this loader
+    const char *block_; ///< the start of the current block of the structural index
+    uint64_t mask_; ///< the not yet consumed delimiters and newlines of the current block
+    /** Marks a field of the header that is not an attribute of the relation. */
+    static constexpr std::size_t SKIP_FIELD = std::numeric_limits<std::size_t>::max();
+    std::vector<std::size_t> offsets_; ///< for each field of the header the index of its attribute, or SKIP_FIELD
     std::vector<char> strbuf_;
 };
 
 template<std::size_t N>
 void Loader::read(Char<N> &chr)
 {
-    std::size_t i = 0;
-    int c = getc_unlocked(file_);
-    while (i != N - 1 and c != delimiter and c != '\n') {
-        chr.data[i++] = c;
-        c = getc_unlocked(file_);
-    }
-    assert(i < N);
-    chr.data[i] = 0;
+    const char *end = next_structural();
+    const std::size_t len = std::min<std::size_t>(end - pos_, N - 1);
+    memcpy(chr.data, pos_, len);
+    chr.data[len] = 0;
+    skip_field(end);
 }
 
 }
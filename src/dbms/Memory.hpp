@@ -0,0 +1,70 @@
+/*--- Memory.hpp -------------------------------------------------------------------------------------------------------
+ *
+ * This file provides memory management for the stores and indexes beyond malloc().  Large memory regions are
+ * allocated according to a MemoryPolicy, that selects the page size and the NUMA placement of the memory.
+ *
+ *--------------------------------------------------------------------------------------------------------------------*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace dbms {
+
+/**
+ * This class describes how the memory of a store or index is allocated.  The regular policy allocates with malloc().
+ * All other policies map memory directly from the operating system:
+ *
+ *  - with PG_Transparent_Huge, the kernel is advised to back the memory with transparent huge pages,
+ *  - with PG_Explicit_Huge, the memory is taken from the pool of explicitly reserved huge pages (see
+ *    /proc/sys/vm/nr_hugepages), falling back to transparent huge pages if the pool is exhausted,
+ *  - with PL_Bind, the memory is placed on the NUMA nodes in nodes,
+ *  - with PL_Interleave, the pages of the memory are interleaved round robin across the NUMA nodes in nodes.
+ */
+struct MemoryPolicy
+{
+    static constexpr std::size_t HUGE_PAGE_SIZE = 2 << 20;
+
+    enum Pages { PG_Regular, PG_Transparent_Huge, PG_Explicit_Huge };
+    enum Placement { PL_First_Touch, PL_Bind, PL_Interleave };
+
+    Pages pages = PG_Regular;
+    Placement placement = PL_First_Touch;
+    uint64_t nodes = 0; ///< bitmask of the NUMA nodes for PL_Bind and PL_Interleave
+
+    /** Returns true iff the policy allocates with malloc(). */
+    bool is_regular() const { return pages == PG_Regular and placement == PL_First_Touch; }
+
+    /** Returns the default policy of the process, that is used by stores and indexes unless they are configured
+     * otherwise.  It is initialized from the environment variable DBMS_MEMORY_POLICY, if set (see Parse()). */
+    static MemoryPolicy & Default();
+
+    /** Parses a policy from a comma separated list of the options "regular", "thp", "hugetlb", "bind=<nodes>", and
+     * "interleave=<nodes>", where <nodes> is a '+' separated list of NUMA nodes or ranges of nodes, e.g. "0+2-3". */
+    static MemoryPolicy Parse(const char *str);
+};
+
+/** Allocates size bytes according to policy.  Returns nullptr if size is 0.  Allocations of less than 64 KiB are always
+ * served by malloc(). */
+void * allocate(std::size_t size, const MemoryPolicy &policy);
+
+/** Resizes the allocation of old_size bytes at ptr to new_size bytes.  ptr may be nullptr, if old_size is 0.  Returns a
+ * pointer to the resized allocation, which holds the first min(old_size, new_size) bytes of the original one. */
+void * reallocate(void *ptr, std::size_t old_size, std::size_t new_size, const MemoryPolicy &policy);
+
+/** Frees the allocation of size bytes at ptr, which was allocated with policy. */
+void deallocate(void *ptr, std::size_t size, const MemoryPolicy &policy);
+
+/** Reserves size bytes of address space and returns a page aligned pointer to its start.  The reservation does not
+ * commit physical memory; a page is backed by memory, placed according to policy, when it is first accessed.  Hence a
+ * store can grow within the reservation without ever moving its data.  Reservations use transparent instead of
+ * explicit huge pages. */
+void * reserve_pages(std::size_t size, const MemoryPolicy &policy = MemoryPolicy::Default());
+
+/** Releases a reservation of size bytes at addr, that was obtained from reserve_pages(size, policy). */
+void release_pages(void *addr, std::size_t size, const MemoryPolicy &policy = MemoryPolicy::Default());
+
+}
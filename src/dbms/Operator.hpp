@@ -0,0 +1,504 @@
+/*--- Operator.hpp -----------------------------------------------------------------------------------------------------
+ *
+ * This file provides vectorized query operators.  A query is a tree of operators.  Each operator pulls batches of up to
+ * BATCH_SIZE rows from its children and produces batches of rows itself.  Within a batch, the values of an attribute are
+ * stored contiguously, such that operators process them in tight loops the compiler can vectorize.
+ *
+ *--------------------------------------------------------------------------------------------------------------------*/
+
+
+#pragma once
+
+#include "dbms/Scheduler.hpp"
+#include "dbms/Schema.hpp"
+#include "dbms/Store.hpp"
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace dbms {
+
+/** The attributes of the rows produced by an operator.  Integer attributes of 1, 2, and 4 bytes are unsigned, integer
+ * attributes of 8 bytes are signed. */
+using Schema = std::vector<Attribute>;
+
+/** Returns the index of the attribute with name in schema.  Exits with an error, if schema has no such attribute. */
+std::size_t index_of(const Schema &schema, const std::string &name);
+
+/**
+ * This class implements a vector of the values of one attribute for the rows of a batch.  A vector does not own its
+ * values: they are either referenced in place, e.g. within a column, or owned by the operator or expression that
+ * produced the vector.
+ */
+struct Vector
+{
+    Attribute::Type type = Attribute::TY_Int;
+    std::size_t elem_size = 0; ///< the size of a value in bytes
+    const void *data = nullptr;
+    bool is_constant = false; ///< whether data holds a single value that applies to all rows
+
+    template<typename T>
+    const T * as() const { return static_cast<const T*>(data); }
+};
+
+/**
+ * This class implements a batch of rows.  A batch holds one vector per attribute of the schema of the operator that
+ * produced it.  Rows that were rejected, e.g. by a filter, remain in the batch but are not selected.
+ *
+ * Operators that agreed to produce runs, see Operator::produce_runs(), may produce batches whose rows each stand for a
+ * run of equal rows.  The lengths of the runs are given by counts.
+ */
+struct Batch
+{
+    std::size_t size = 0; ///< number of rows
+    std::size_t num_selected = 0; ///< number of selected rows
+    const uint16_t *selection = nullptr; ///< ascending positions of the selected rows, or nullptr if all are selected
+    const uint32_t *counts = nullptr; ///< the number of equal rows each row stands for, or nullptr if one each
+    std::vector<Vector> vectors;
+
+    /** Selects all rows of the batch, each standing for a single row. */
+    void select_all() { num_selected = size; selection = nullptr; counts = nullptr; }
+};
+static_assert(BATCH_SIZE <= UINT16_MAX + 1, "positions within a batch must fit into a selection vector");
+
+struct ExprNode;
+struct ExprEvaluator;
+
+/**
+ * This class implements an expression, that computes a value for each row of a batch.  Expressions are composed from
+ * attributes, constants, arithmetic, comparisons, and logical connectives, e.g.
+ *
+ *     col("extendedprice") * (100 - col("discount"))
+ *     col("shipdate") < date_to_int(1998, 1, 1) and col("shipmode") == "AIR"
+ *
+ * Arithmetic is computed with 64 bit signed integers, or with doubles if an operand is a double.  Comparisons and
+ * logical connectives compute a boolean, that is an unsigned integer of 1 byte, which is 0 or 1.  Attributes of type
+ * Char compare as strings.
+ */
+struct Expr
+{
+    enum Operation {
+        OP_Add, OP_Sub, OP_Mul, OP_Div,
+        OP_Eq, OP_Ne, OP_Lt, OP_Le, OP_Gt, OP_Ge,
+        OP_And, OP_Or, OP_Not,
+        OP_Length, OP_StartsWith,
+    };
+
+    Expr(std::shared_ptr<const ExprNode> node) : node(std::move(node)) { }
+    /* Constants. */
+    template<typename T, typename = std::enable_if_t<std::is_integral<T>::value>>
+    Expr(T value) : Expr(int64_t(value)) { }
+    Expr(int64_t value);
+    Expr(double value);
+    Expr(const char *value);
+
+    std::shared_ptr<const ExprNode> node; ///< the root of the expression tree
+};
+
+/** Returns an expression that evaluates to the values of the attribute with name. */
+Expr col(const char *name);
+
+Expr operator+(Expr lhs, Expr rhs);
+Expr operator-(Expr lhs, Expr rhs);
+Expr operator*(Expr lhs, Expr rhs);
+Expr operator/(Expr lhs, Expr rhs);
+Expr operator==(Expr lhs, Expr rhs);
+Expr operator!=(Expr lhs, Expr rhs);
+Expr operator<(Expr lhs, Expr rhs);
+Expr operator<=(Expr lhs, Expr rhs);
+Expr operator>(Expr lhs, Expr rhs);
+Expr operator>=(Expr lhs, Expr rhs);
+Expr operator&&(Expr lhs, Expr rhs);
+Expr operator||(Expr lhs, Expr rhs);
+Expr operator!(Expr expr);
+/** Returns an expression that evaluates to the length of the string expr. */
+Expr length(Expr expr);
+/** Returns an expression that evaluates to whether the string expr starts with the string prefix, like
+ * expr LIKE 'prefix%'. */
+Expr starts_with(Expr expr, Expr prefix);
+/** Returns an expression that evaluates to whether expr lies in the closed interval [lo, hi]. */
+inline Expr between(Expr expr, Expr lo, Expr hi) { return expr >= std::move(lo) and std::move(expr) <= std::move(hi); }
+
+/**
+ * This class describes an aggregate, that is computed over the rows of a group.
+ */
+struct Aggregate
+{
+    enum Function { AG_Count, AG_Sum, AG_Min, AG_Max, AG_Avg };
+
+    Aggregate(const char *name, Function function, Expr expr) : name(name), function(function), expr(std::move(expr)) { }
+
+    /* Convenience constructors. */
+    static Aggregate Count(const char *name) { return Aggregate(name, AG_Count, Expr(0)); }
+    static Aggregate Sum(const char *name, Expr expr) { return Aggregate(name, AG_Sum, std::move(expr)); }
+    static Aggregate Min(const char *name, Expr expr) { return Aggregate(name, AG_Min, std::move(expr)); }
+    static Aggregate Max(const char *name, Expr expr) { return Aggregate(name, AG_Max, std::move(expr)); }
+    static Aggregate Avg(const char *name, Expr expr) { return Aggregate(name, AG_Avg, std::move(expr)); }
+
+    std::string name; ///< the name of the attribute holding the aggregate
+    Function function;
+    Expr expr; ///< the expression to aggregate
+};
+
+/**
+ * The base class of all operators.  An operator owns its children, that are passed to its constructor.
+ */
+struct Operator
+{
+    virtual ~Operator() { }
+
+    /** Returns the attributes of the rows produced by the operator. */
+    const Schema & schema() const { return schema_; }
+
+    /** Produces the next batch of rows.  Returns false, if the operator has no more rows.  The vectors of the batch
+     * remain valid until the next call. */
+    virtual bool next(Batch &batch) = 0;
+
+    /** Requests the operator to produce batches of runs of equal rows, see Batch::counts, which the caller then must
+     * accept.  Returns true iff the operator agrees.  Must be called before the first batch is produced. */
+    virtual bool produce_runs() { return false; }
+
+    protected:
+    Schema schema_;
+};
+
+/** A range of rows [first, second) of a store. */
+using RowRange = std::pair<std::size_t, std::size_t>;
+
+/** Returns the ascending, disjoint ranges of the rows of store, whose attribute name satisfies predicate.  The predicate
+ * must refer to no other attribute.  The predicate is evaluated once per dictionary entry of dictionary compressed
+ * columns, once per run of columns with runs, and once per row otherwise.  Columns that match strings on their encoded
+ * elements evaluate comparisons with a string by =, <> and starts_with() without decoding. */
+std::vector<RowRange> select(const ColumnStore &store, const Relation &relation, const char *name, Expr predicate);
+
+/**
+ * This operator scans the attributes of a store.  Compressed columns are decoded batch wise.  The scan can be limited to
+ * a range of rows or to the ranges of rows computed by select(), or scan the morsels claimed by a worker of a parallel
+ * execution.  If all scanned columns have long runs of equal values, the scan produces runs on request: a row of a
+ * batch then stands for a range of rows within which no scanned column changes its value, and the values are decoded
+ * once per run.
+ */
+struct Scan : Operator
+{
+    /** Scans the attributes with names of the rows in [begin, end) of the store with relation. */
+    Scan(const ColumnStore &store, const Relation &relation, std::initializer_list<const char*> names,
+         std::size_t begin = 0, std::size_t end = SIZE_MAX);
+    Scan(const RowStore &store, const Relation &relation, std::initializer_list<const char*> names,
+         std::size_t begin = 0, std::size_t end = SIZE_MAX);
+    /** Scans the attributes with names of the rows in ascending, disjoint ranges.  Rows between the ranges are skipped
+     * without being decoded.  Rows of a batch, that are not within a range, are not selected. */
+    Scan(const ColumnStore &store, const Relation &relation, std::initializer_list<const char*> names,
+         std::vector<RowRange> ranges);
+    /** Scans the attributes with names of the rows of the morsels, that worker claims from morsels. */
+    Scan(const ColumnStore &store, const Relation &relation, std::initializer_list<const char*> names,
+         Morsels &morsels, std::size_t worker);
+    Scan(const RowStore &store, const Relation &relation, std::initializer_list<const char*> names,
+         Morsels &morsels, std::size_t worker);
+
+    bool next(Batch &batch);
+    bool produce_runs();
+
+    private:
+    void init(const Relation &relation, std::initializer_list<const char*> names);
+    /** Claims the next morsel and moves the scan to its rows.  Returns false, if there are no more morsels. */
+    bool next_morsel();
+    /** Produces the runs of the next at most n rows. */
+    void next_runs(Batch &batch, std::size_t n);
+    /** Produces the next batch of rows, that holds rows in ranges_.  Returns false, if there are no more ranges. */
+    bool next_in_ranges(Batch &batch);
+    /** Reads the next n rows into batch. */
+    void read(Batch &batch, std::size_t n);
+
+    const ColumnStore *column_store_ = nullptr;
+    const RowStore *row_store_ = nullptr;
+    Morsels *morsels_ = nullptr;
+    std::size_t worker_ = 0;
+    std::size_t pos_; ///< the next row to scan
+    std::size_t end_; ///< the end of the range of rows to scan
+    std::vector<std::size_t> attrs_; ///< the offsets of the scanned attributes in the relation
+    std::vector<ColumnCursor> cursors_;
+    std::vector<std::vector<uint64_t>> buffers_; ///< buffers to decode or gather a batch of values to
+
+    bool runs_ = false; ///< whether the scan produces runs
+    std::vector<std::vector<uint64_t>> run_values_; ///< the values of the runs of each column
+    std::vector<std::vector<uint32_t>> run_ends_; ///< the ends of the runs of each column
+    std::vector<std::vector<uint16_t>> run_indices_; ///< the index of the run of each column for each produced run
+    std::vector<uint32_t> counts_;
+
+    bool has_ranges_ = false; ///< whether the scan is limited to ranges_
+    std::vector<RowRange> ranges_;
+    std::size_t range_ = 0; ///< the first range, that ends after the next row to scan
+    std::vector<uint16_t> selection_;
+};
+
+/**
+ * This operator selects the rows of its child that satisfy a predicate.
+ */
+struct Filter : Operator
+{
+    Filter(Operator *child, Expr predicate);
+    ~Filter();
+
+    bool next(Batch &batch);
+    bool produce_runs() { return child_->produce_runs(); }
+
+    private:
+    std::unique_ptr<Operator> child_;
+    std::unique_ptr<ExprEvaluator> predicate_;
+    uint16_t selection_[BATCH_SIZE];
+};
+
+/**
+ * This operator computes expressions over the rows of its child.
+ */
+struct Project : Operator
+{
+    /** Produces one attribute per pair of a name and an expression. */
+    Project(Operator *child, std::vector<std::pair<const char*, Expr>> exprs);
+    ~Project();
+
+    bool next(Batch &batch);
+    bool produce_runs() { return child_->produce_runs(); }
+
+    private:
+    std::unique_ptr<Operator> child_;
+    std::vector<std::unique_ptr<ExprEvaluator>> exprs_;
+    std::vector<std::vector<uint64_t>> buffers_; ///< buffers to broadcast constants to
+};
+
+/**
+ * This operator groups the rows of its child by the values of attributes and computes aggregates per group.  Without
+ * grouping attributes, it produces a single row holding the aggregates over all rows.  The rows produced hold the
+ * grouping attributes followed by the aggregates.  Counts and sums of integers are 64 bit integers, sums of doubles are
+ * doubles, minima and maxima are of the type of the aggregated expression, and averages are doubles.
+ *
+ * The groups are kept in an open addressing hash table.  Keys are padded to whole words, and keys of a single word, like
+ * integers, dates, and short strings, are looked up by a specialized probe loop.
+ */
+struct HashAggregate : Operator
+{
+    friend struct ParallelAggregate;
+
+    HashAggregate(Operator *child, std::vector<const char*> group_by, std::vector<Aggregate> aggregates);
+    ~HashAggregate();
+
+    bool next(Batch &batch);
+
+    private:
+    union State
+    {
+        int64_t i;
+        double d;
+    };
+
+    /** Consumes all rows of the child. */
+    void build();
+    /** Stores the index of the group of each selected row of batch in groups, inserting new groups as necessary. */
+    void find_groups(const Batch &batch, uint32_t *groups);
+    /** Returns the index of the group with key, inserting a new group if necessary. */
+    uint32_t find_group(const uint64_t *key, uint64_t hash);
+    /** Same as find_group() for keys of a single word. */
+    uint32_t find_group(uint64_t key, uint64_t hash);
+    /** Doubles the number of slots of the hash table. */
+    void grow();
+    /** Merges the groups of other, which computes the same aggregates, into the groups of this. */
+    void merge(const HashAggregate &other);
+    /** Updates the aggregate with index aggregate by the selected rows of batch, that belong to groups. */
+    template<typename T>
+    void update(std::size_t aggregate, const Batch &batch, const uint32_t *groups, const T *values);
+    /** Same as update() for a batch of runs, of which a sum weights the values by the lengths of the runs. */
+    template<typename T>
+    void update_runs(std::size_t aggregate, const Batch &batch, const uint32_t *groups, const T *values);
+
+    std::unique_ptr<Operator> child_;
+    std::vector<std::size_t> keys_; ///< the offsets of the grouping attributes in the schema of the child
+    std::vector<std::size_t> key_offsets_; ///< the offsets of the grouping attributes within a key
+    std::size_t key_size_ = 0; ///< the size of the values of all grouping attributes together
+    std::size_t key_words_ = 0; ///< the size of a key in words
+    /* The states computed per group.  An average is computed as a sum and a count, hence functions_ never holds
+     * AG_Avg. */
+    std::vector<std::unique_ptr<ExprEvaluator>> exprs_; ///< the expressions of the states
+    std::vector<Aggregate::Function> functions_;
+    std::vector<bool> is_double_; ///< whether a state is computed with doubles
+    /** Describes how an aggregate is produced from the states of a group. */
+    struct Output
+    {
+        std::size_t state; ///< the index of the state holding the aggregate, or its sum if the aggregate is an average
+        std::size_t count; ///< the index of the count of an average, or NO_COUNT
+    };
+    static constexpr std::size_t NO_COUNT = std::numeric_limits<std::size_t>::max();
+    std::vector<Output> outputs_;
+
+    std::vector<uint64_t> batch_keys_; ///< the keys of the selected rows of the current batch
+    uint64_t hashes_[BATCH_SIZE]; ///< the hashes of the keys in batch_keys_
+    std::vector<uint64_t> group_keys_; ///< the key of each group, key_words_ words per group
+    std::vector<uint64_t> group_hashes_; ///< the hash of the key of each group
+    std::vector<State> states_; ///< the states of the aggregates, consecutively for each group
+    std::vector<uint32_t> slots_; ///< open addressing hash table of group indices
+    std::size_t num_groups_ = 0;
+
+    bool built_ = false;
+    std::size_t pos_ = 0; ///< the next group to produce
+    std::vector<std::vector<uint64_t>> buffers_;
+};
+
+/**
+ * This operator computes a HashAggregate in parallel.  Every worker of a pool runs its own pipeline, that scans the
+ * morsels claimed by the worker, and aggregates the rows of the pipeline into groups of its own.  The groups of all
+ * workers are merged before the first row is produced.
+ */
+struct ParallelAggregate : Operator
+{
+    /** Creates the pipeline of worker.  The pipeline must read its rows through Scans of morsels for worker. */
+    using Pipeline = std::function<Operator*(Morsels &morsels, std::size_t worker)>;
+
+    /** Aggregates the rows of the pipelines over the morsels of [0, num_rows). */
+    ParallelAggregate(std::size_t num_rows, Pipeline pipeline, std::vector<const char*> group_by,
+                      std::vector<Aggregate> aggregates, ThreadPool &pool = ThreadPool::Default(),
+                      std::size_t morsel_size = MORSEL_SIZE);
+    ~ParallelAggregate();
+
+    bool next(Batch &batch);
+
+    private:
+    /** Runs the pipelines of all workers and merges their groups. */
+    void build();
+
+    Pipeline pipeline_;
+    std::vector<const char*> group_by_;
+    std::vector<Aggregate> aggregates_;
+    ThreadPool &pool_;
+    Morsels morsels_;
+    std::vector<std::unique_ptr<HashAggregate>> partials_; ///< the aggregates of the workers
+    bool built_ = false;
+};
+
+/**
+ * This operator sorts the rows of its child.
+ */
+struct Sort : Operator
+{
+    struct Key
+    {
+        const char *name;
+        bool ascending = true;
+    };
+
+    Sort(Operator *child, std::initializer_list<Key> keys);
+
+    bool next(Batch &batch);
+
+    private:
+    /** Materializes and sorts all rows of the child. */
+    void build();
+
+    std::unique_ptr<Operator> child_;
+    std::vector<std::pair<std::size_t, bool>> keys_; ///< the offsets of the sort attributes and whether ascending
+    std::vector<std::size_t> offsets_; ///< the offsets of the attributes within a materialized row
+    std::size_t row_size_ = 0;
+    std::vector<uint8_t> rows_; ///< the materialized rows
+    std::vector<uint32_t> order_; ///< the indices of the rows in sorted order
+    bool built_ = false;
+    std::size_t pos_ = 0; ///< the next row to produce
+    std::vector<std::vector<uint64_t>> buffers_;
+};
+
+/**
+ * This operator produces the first n rows of its child.
+ */
+struct Limit : Operator
+{
+    Limit(Operator *child, std::size_t n);
+
+    bool next(Batch &batch);
+
+    private:
+    std::unique_ptr<Operator> child_;
+    std::size_t remaining_; ///< the number of rows still to produce
+};
+
+/**
+ * This operator joins the rows of its children on the equality of an integer attribute of each child.  The rows of the
+ * build child are inserted into a hash table, which the rows of the probe child are looked up in.  The rows produced
+ * hold the attributes of the build child followed by the attributes of the probe child, in the order of the probe
+ * rows.
+ */
+struct HashJoin : Operator
+{
+    HashJoin(Operator *build, Operator *probe, const char *build_key, const char *probe_key);
+
+    bool next(Batch &batch);
+
+    private:
+    /** Materializes the rows of the build child in the hash table. */
+    void build();
+
+    std::unique_ptr<Operator> build_;
+    std::unique_ptr<Operator> probe_;
+    std::size_t build_key_; ///< the offset of the join attribute in the schema of the build child
+    std::size_t probe_key_; ///< the offset of the join attribute in the schema of the probe child
+
+    std::vector<std::size_t> offsets_; ///< the offsets of the build attributes within a materialized row
+    std::size_t row_size_ = 0;
+    std::vector<uint8_t> rows_; ///< the materialized build rows
+    std::vector<int64_t> row_keys_; ///< the join key of each build row
+    std::vector<uint32_t> next_; ///< the next build row with the same hash, chaining the rows of a slot
+    std::vector<uint32_t> slots_; ///< the first build row of each slot
+    bool built_ = false;
+
+    Batch probe_batch_; ///< the current batch of the probe child
+    std::vector<int64_t> probe_keys_; ///< the join keys of probe_batch_
+    std::size_t probe_pos_ = 0; ///< the next selected row of probe_batch_ to probe
+    uint32_t match_; ///< the next build row that may match the current probe row
+    uint32_t build_rows_[BATCH_SIZE]; ///< the build rows of the produced batch
+    uint16_t probe_rows_[BATCH_SIZE]; ///< the positions in probe_batch_ of the probe rows of the produced batch
+    std::vector<std::vector<uint64_t>> buffers_;
+};
+
+/**
+ * This operator joins like HashJoin, but is cache-conscious and parallel.  The rows of both children are partitioned
+ * by the lowest bits of the hashes of their join keys, such that the hash table of each partition fits into the L2
+ * cache.  The partitioning and the joins of the partitions run on the workers of a pool.  The rows produced hold the
+ * attributes of the build child followed by the attributes of the probe child, in no particular order.
+ */
+struct RadixJoin : Operator
+{
+    /** The size in bytes the partition of the build child and its hash table should not exceed. */
+    static constexpr std::size_t PARTITION_SIZE = 256 << 10;
+
+    RadixJoin(Operator *build, Operator *probe, const char *build_key, const char *probe_key,
+              ThreadPool &pool = ThreadPool::Default(), std::size_t partition_size = PARTITION_SIZE);
+
+    bool next(Batch &batch);
+
+    private:
+    /** Materializes the rows of both children, partitions them, and joins the partitions. */
+    void build();
+
+    std::unique_ptr<Operator> build_;
+    std::unique_ptr<Operator> probe_;
+    std::size_t build_key_; ///< the offset of the join attribute in the schema of the build child
+    std::size_t probe_key_; ///< the offset of the join attribute in the schema of the probe child
+    ThreadPool &pool_;
+    std::size_t partition_size_;
+
+    std::vector<std::size_t> build_offsets_; ///< the offsets of the build attributes within a materialized row
+    std::vector<std::size_t> probe_offsets_; ///< the offsets of the probe attributes within a materialized row
+    std::size_t build_row_size_ = 0;
+    std::size_t probe_row_size_ = 0;
+    std::vector<uint8_t> build_rows_; ///< the materialized build rows
+    std::vector<uint8_t> probe_rows_; ///< the materialized probe rows
+    std::vector<std::pair<uint32_t, uint32_t>> matches_; ///< the pairs of indices of matching build and probe rows
+    bool built_ = false;
+    std::size_t pos_ = 0; ///< the next match to produce
+    std::vector<std::vector<uint64_t>> buffers_;
+};
+
+}
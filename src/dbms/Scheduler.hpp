@@ -0,0 +1,105 @@
+/*--- Scheduler.hpp ----------------------------------------------------------------------------------------------------
+ *
+ * This file provides the parallel execution of queries.  A ThreadPool runs a task on all of its workers.  The work of a
+ * task is split into Morsels, small ranges of rows, which the workers claim dynamically: every worker starts on its own
+ * stripe of morsels, and a worker that exhausted its stripe steals morsels from the other workers.  Hence all workers
+ * stay busy until the last morsel is processed, even if morsels take different time.
+ *
+ *--------------------------------------------------------------------------------------------------------------------*/
+
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace dbms {
+
+/** The default number of rows of a morsel. */
+constexpr std::size_t MORSEL_SIZE = 1 << 14;
+
+/**
+ * This class implements the dynamic assignment of morsels to workers.  The items [0, num_items) are split into
+ * morsels of morsel_size items, and the morsels are split into one contiguous stripe per worker.  A worker claims the
+ * morsels of its stripe front to back, such that it scans a contiguous range of rows.  Once its stripe is exhausted,
+ * it steals morsels from the back of the stripes of other workers.  Claiming a morsel is a single compare-and-swap.
+ */
+struct Morsels
+{
+    Morsels(std::size_t num_items, std::size_t num_workers, std::size_t morsel_size = MORSEL_SIZE);
+    Morsels(const Morsels&) = delete;
+
+    std::size_t num_items() const { return num_items_; }
+    std::size_t num_workers() const { return num_workers_; }
+
+    /** Claims the next morsel for worker.  Returns false, if all morsels are claimed.  Otherwise, sets [begin, end) to
+     * the items of the claimed morsel. */
+    bool next(std::size_t worker, std::size_t &begin, std::size_t &end);
+
+    private:
+    /** The unclaimed morsels of a stripe, as the index of its first morsel in the upper and the index past its last
+     * morsel in the lower 32 bits.  Stripes are padded to cache lines, as they are updated concurrently. */
+    struct alignas(LEVEL1_DCACHE_LINESIZE) Stripe
+    {
+        std::atomic<uint64_t> range;
+    };
+
+    bool claim(Stripe &stripe, bool from_front, std::size_t &morsel);
+
+    std::size_t num_items_;
+    std::size_t num_workers_;
+    std::size_t morsel_size_;
+    std::unique_ptr<Stripe[]> stripes_;
+};
+
+/**
+ * This class implements a pool of threads, that execute tasks in parallel.  The thread calling run() participates as
+ * worker 0, hence a pool of n workers starts n - 1 threads.
+ */
+struct ThreadPool
+{
+    /** Creates a pool of num_workers workers. */
+    explicit ThreadPool(std::size_t num_workers);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+
+    std::size_t num_workers() const { return threads_.size() + 1; }
+
+    /** Runs task(worker) on every worker and returns once all calls returned.  Tasks of concurrent calls to run() are
+     * executed one after another.  A task that calls run() executes the nested task on the calling worker only, as
+     * worker 0. */
+    void run(const std::function<void(std::size_t worker)> &task);
+
+    /** Calls f(worker, begin, end) for the morsels of morsel_size items of [0, num_items), distributing the morsels
+     * over all workers. */
+    void parallel_for(std::size_t num_items, const std::function<void(std::size_t, std::size_t, std::size_t)> &f,
+                      std::size_t morsel_size = MORSEL_SIZE);
+
+    /** Returns the default pool of the process.  Its number of workers is taken from the environment variable
+     * DBMS_NUM_THREADS, if set, and defaults to the number of hardware threads. */
+    static ThreadPool & Default();
+
+    private:
+    /** The loop of the thread of a worker. */
+    void work(std::size_t worker);
+
+    std::vector<std::thread> threads_;
+    std::mutex run_mutex_; ///< serializes calls to run()
+    std::mutex mutex_; ///< protects the following members
+    std::condition_variable task_available_;
+    std::condition_variable task_finished_;
+    const std::function<void(std::size_t)> *task_ = nullptr;
+    uint64_t generation_ = 0; ///< the number of tasks started so far
+    std::size_t num_running_ = 0; ///< the number of threads still executing the current task
+    bool is_stopping_ = false;
+};
+
+}
@@ -111,6 +111,21 @@ struct Relation
         }
     }
 
+    /** Creates the projection of relation to the attributes named in names, in the order of names. */
+    Relation(const Relation &relation, std::initializer_list<const char*> names)
+        : name(relation.name), size_(names.size())
+    {
+        attributes_ = static_cast<decltype(attributes_)>(malloc(sizeof(*attributes_) * names.size()));
+        auto it = names.begin();
+        for (std::size_t i = 0; i != names.size(); ++i, ++it) {
+            new (&attributes_[i]) Attribute(relation[*it]);
+            attributes_[i].offset_ = i;
+            std::string name(*it);
+            std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+            name_to_attribute_[name] = i;
+        }
+    }
+
     ~Relation() { free(attributes_); }
 
     Attribute * begin() { return attributes_; }
@@ -133,6 +148,12 @@ struct Relation
         return attributes_[idx];
     }
 
+    /** Returns true iff the relation has an attribute with name s. */
+    bool has(std::string s) const {
+        std::transform(s.begin(), s.end(), s.begin(), ::tolower);
+        return name_to_attribute_.count(s);
+    }
+
     friend std::ostream & operator<<(std::ostream &out, const Relation &relation) {
         out << "Relation \"" << relation.name << "\" (\n";
         for (std::size_t i = 0; i != relation.size_; ++i)
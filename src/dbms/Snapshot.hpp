@@ -0,0 +1,129 @@
+/*--- Snapshot.hpp -----------------------------------------------------------------------------------------------------
+ *
+ * This file provides the binary snapshot format of the stores.  A snapshot file consists of a fixed size header, the
+ * contents of the store, and a trailer with the metadata of the store:
+ *
+ *      +--------+--------+--------+-----+--------+----------+
+ *      | header | data 0 | data 1 | ... | data n | metadata |
+ *      +--------+--------+--------+-----+--------+----------+
+ *
+ * Every data section starts at a multiple of the page size.  A snapshot is opened by mapping the entire file into
+ * memory and letting the stores reference their data sections in place, i.e. without deserialization.  The mapping is
+ * private, such that modifications of an opened store never reach the file.  The header records the byte order of the
+ * writer, and the metadata identifies the classes of columns by explicit type tags, such that snapshots do not depend
+ * on the compiler.
+ *
+ *--------------------------------------------------------------------------------------------------------------------*/
+
+
+#pragma once
+
+#include "dbms/assert.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+
+namespace dbms {
+
+struct Snapshot
+{
+    static constexpr char MAGIC[8] = { 'D', 'B', 'M', 'S', 'S', 'N', 'A', 'P' };
+    static constexpr uint32_t VERSION = 2;
+    /** Written in the byte order of the writer.  Snapshots are only read on machines of the same byte order, as the
+     * data sections are referenced in place. */
+    static constexpr uint64_t BYTE_ORDER_MARK = 0x0102030405060708UL;
+
+    /** The kind of store contained in a snapshot. */
+    enum Kind : uint32_t { SK_RowStore, SK_ColumnStore };
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        Kind kind;
+        uint64_t byte_order; ///< BYTE_ORDER_MARK
+        uint64_t metadata_offset; ///< the offset of the metadata trailer in the file
+        uint64_t metadata_size; ///< the size of the metadata trailer in bytes
+    };
+};
+
+/**
+ * This class writes a snapshot file.  Data sections are written to the file immediately, while metadata is collected
+ * and written on close().
+ */
+struct SnapshotWriter
+{
+    SnapshotWriter(const char *filename, Snapshot::Kind kind);
+    ~SnapshotWriter();
+    SnapshotWriter(const SnapshotWriter&) = delete;
+
+    /** Appends a trivially copyable value to the metadata. */
+    template<typename T>
+    void put(const T &value) {
+        static_assert(std::is_trivially_copyable<T>::value, "metadata must be trivially copyable");
+        const char *bytes = reinterpret_cast<const char*>(&value);
+        metadata_.insert(metadata_.end(), bytes, bytes + sizeof(T));
+    }
+    /** Appends a string to the metadata. */
+    void put_string(const char *str);
+    /** Writes size bytes at data to a new, page aligned data section and appends a reference to it to the metadata. */
+    void put_data(const void *data, std::size_t size);
+
+    /** Writes the metadata and the header and closes the file. */
+    void close();
+
+    private:
+    const char *filename_;
+    FILE *file_;
+    Snapshot::Kind kind_;
+    uint64_t offset_; ///< the current end of the file
+    std::vector<char> metadata_;
+};
+
+/**
+ * This class reads a snapshot file.  The file is mapped into memory, and metadata is read in the order it was written.
+ */
+struct SnapshotReader
+{
+    SnapshotReader(const char *filename, Snapshot::Kind kind);
+    SnapshotReader(const SnapshotReader&) = delete;
+
+    /** Reads a trivially copyable value from the metadata. */
+    template<typename T>
+    T get() {
+        static_assert(std::is_trivially_copyable<T>::value, "metadata must be trivially copyable");
+        T value;
+        memcpy(&value, next(sizeof(T)), sizeof(T));
+        return value;
+    }
+    /** Reads a string from the metadata. */
+    std::string get_string();
+    /** Reads a reference to a data section from the metadata.  Returns a pointer to the data section within the
+     * mapping, and stores its size in size. */
+    void * get_data(std::size_t &size);
+    /** Reads a string from the metadata and fails if it differs from expected. */
+    void expect_string(const char *expected);
+    /** Fails because the snapshot does not match the layout of the store it is read into. */
+    [[noreturn]] void layout_mismatch() const;
+
+    /** Returns the mapping of the snapshot file.  Stores that reference their data within the mapping must hold on to
+     * it. */
+    const std::shared_ptr<void> & mapping() const { return mapping_; }
+
+    private:
+    /** Returns a pointer to the next size bytes of metadata and advances past them. */
+    const char * next(std::size_t size);
+
+    const char *filename_;
+    std::shared_ptr<void> mapping_;
+    uint64_t data_size_; ///< the size of the file without the metadata trailer
+    const char *pos_; ///< the current position within the metadata
+    const char *end_; ///< the end of the metadata
+};
+
+}
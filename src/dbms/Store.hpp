@@ -10,12 +10,16 @@
 #pragma once
 
 #include "dbms/assert.hpp"
+#include "dbms/Memory.hpp"
 #include "dbms/Schema.hpp"
 #include "dbms/util.hpp"
 #include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <initializer_list>
+#include <memory>
+#include <new>
+#include <string>
 #include <type_traits>
 #include <typeinfo>
 #include <vector>
@@ -29,6 +33,8 @@ struct ColumnBase;
 struct GenericColumn;
 template<typename T> struct Column;
 struct ColumnStore;
+struct SnapshotWriter;
+struct SnapshotReader;
 
 namespace iterator {
 
@@ -194,23 +200,73 @@ struct Varchar
 };
 static_assert(sizeof(Varchar) == sizeof(const char*), "Varchar has incorrect size");
 
+/** Returns the name of the value type of the null pointer argument in the type tags of columns, see
+ * ColumnBase::type_tag().  Unlike typeid(T).name(), the name does not depend on the compiler. */
+template<typename T>
+std::string value_tag(const T*)
+{
+    static_assert(std::is_arithmetic<T>::value, "unsupported value type");
+    const char *kind = std::is_floating_point<T>::value ? "Float" : std::is_signed<T>::value ? "Int" : "UInt";
+    return kind + std::to_string(8 * sizeof(T));
+}
+template<std::size_t N>
+std::string value_tag(const Char<N>*) { return "Char" + std::to_string(N); }
+inline std::string value_tag(const Varchar*) { return "Varchar"; }
+/** Returns the name of the value type T in the type tags of columns. */
+template<typename T>
+std::string value_tag() { return value_tag(static_cast<const T*>(nullptr)); }
+
+/** The number of elements that queries process at a time.  Batches of the few columns accessed by a query fit into the
+ * L1 data cache together. */
+constexpr std::size_t BATCH_SIZE = 1024;
+
+/**
+ * This class implements a view of a contiguous sequence of elements, e.g. a batch of elements of a column.  A span does
+ * not own its elements.
+ */
+template<typename T>
+struct Span
+{
+    Span(T *data, std::size_t size) : data_(data), size_(size) { }
+
+    T * data() const { return data_; }
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    T * begin() const { return data_; }
+    T * end() const { return data_ + size_; }
+
+    T & operator[](std::size_t idx) const { return data_[idx]; }
+
+    private:
+    T *data_;
+    std::size_t size_;
+};
+
 /**
  * This class implements a row store.  It stores tuples by placing the attributes in row-major order.
  */
 struct RowStore final : public Store
 {
     private:
-    RowStore() : data_(nullptr), size_(0), capacity_(0) { }
+    RowStore()
+        : data_(nullptr), size_(0), capacity_(0), reserved_(0), owns_data_(true), has_varchar_(false)
+        , policy_(MemoryPolicy::Default())
+    { }
 
     public:
     ~RowStore();
     RowStore(const RowStore&) = delete;
-    RowStore(RowStore&&) = default;
+    RowStore(RowStore &&other);
 
     /* Factory methods. */
     static RowStore Create_Naive(const Relation &relation);
     static RowStore Create_Optimized(const Relation &relation);
     static RowStore Create_Explicit(const Relation &relation, std::size_t *order);
+    /** Creates an empty store with the same row layout as other. */
+    static RowStore Create_Like(const RowStore &other);
+    /** Opens the snapshot in file filename.  The store references its rows within the mapped file. */
+    static RowStore Open_Snapshot(const char *filename);
 
     std::size_t size() const { return size_; }
     std::size_t size_in_bytes() const { return size_ * row_size_; }
@@ -219,6 +275,8 @@ struct RowStore final : public Store
 
     std::size_t num_attributes() const { return num_attributes_; }
     std::size_t row_size() const { return row_size_; }
+    /** Returns the offset in bytes of the attribute with index attr within a row. */
+    std::size_t offset_of(std::size_t attr) const { return offsets_[attr]; }
 
     /* Iterator. */
     private:
@@ -237,9 +295,24 @@ struct RowStore final : public Store
 
     /** Increases the capacity of the store to a value greater or equal to new_cap. */
     void reserve(std::size_t new_cap);
+    /** Moves the rows to a reservation of address space for max_cap rows, which becomes the capacity of the store.  Up
+     * to max_cap rows, the store then grows in place: appending never copies the rows, and addresses of rows remain
+     * valid.  Physical memory is committed page wise as rows are appended.  Growing beyond max_cap moves the rows to a
+     * larger reservation. */
+    void reserve_address_space(std::size_t max_cap);
+    /** Moves the rows to memory allocated according to policy, which is used for all further allocations. */
+    void set_memory_policy(const MemoryPolicy &policy);
+    const MemoryPolicy & memory_policy() const { return policy_; }
     /** Appends n_rows fresh rows at the end of the store and returns an iterator to the first fresh row.  The capacity
      * is increased if necessary. */
     iterator append(std::size_t n_rows);
+    /** Appends copies of the first n_rows rows of other at the end of the store.  Both stores must have the same row
+     * layout. */
+    void append(const RowStore &other, std::size_t n_rows);
+
+    /** Writes a snapshot of the store to file filename.  The rows are written bytewise, hence the store must not
+     * contain Varchar attributes.  Fails otherwise. */
+    void save_snapshot(const char *filename) const;
 
     friend std::ostream & operator<<(std::ostream &out, const RowStore &row_store) {
         out << "RowStore (" << row_store.size_ << '/' << row_store.capacity_ << " rows, "
@@ -260,9 +333,31 @@ struct RowStore final : public Store
     std::size_t row_size_; ///< size of a row in bytes
     std::size_t size_; ///< number of used rows
     std::size_t capacity_; ///< number of allocated rows
+    std::size_t reserved_; ///< number of rows in the address space reservation at data_, or 0 if data_ is malloc'd
+    bool owns_data_; ///< whether data_ was allocated by the store, or references a snapshot
+    bool has_varchar_; ///< whether a row contains Varchar attributes, i.e. pointers to strings
+    MemoryPolicy policy_; ///< the policy to allocate data_ with
+    std::shared_ptr<void> snapshot_; ///< the mapping of the snapshot the store was opened from
+
+    /** Releases data_, if owned. */
+    void release_data();
 };
 
 
+struct GenericColumn;
+
+/**
+ * This class implements a position within a column, from which consecutive batches of elements are read.  Compressed
+ * columns record in the cursor where decoding continues.
+ */
+struct ColumnCursor
+{
+    std::size_t idx = 0; ///< index of the next element
+    std::size_t run = 0; ///< run of the next element, for run length encoded columns
+    std::size_t run_idx = 0; ///< index of the next element within its run, for run length encoded columns
+    uint64_t previous = 0; ///< the element preceding the next element, for delta encoded columns
+};
+
 /**
  * A base class for all column classes.  Provides a virtual destructor for simple cleanup, and some other functions for
  * general status reports.
@@ -276,6 +371,62 @@ struct ColumnBase
     virtual std::size_t capacity() const = 0;
     virtual std::size_t capacity_in_bytes() const = 0;
 
+    /** Returns true iff the column encodes its elements, i.e. does not store them bytewise. */
+    virtual bool is_compressed() const = 0;
+    /** Returns a tag of the class of the column and its value type, e.g. "RLE<UInt32>", that identifies the column in
+     * snapshots independently of the compiler. */
+    virtual std::string type_tag() const = 0;
+    /** Appends the first n elements of the uncompressed column other at the end of the column, encoding them if the
+     * column is compressed.  The elements of other must be of the value type of the column. */
+    virtual void append(const GenericColumn &other, std::size_t n) = 0;
+
+    /** Returns a cursor to the element at index idx. */
+    virtual ColumnCursor cursor(std::size_t idx) const = 0;
+    /** Reads the min(n, size() - cursor.idx) elements at cursor and advances cursor past them.  Returns a pointer to the
+     * values of the elements: uncompressed columns return their elements in place, compressed columns decode the
+     * values to buffer, which must have room for n values. */
+    virtual const void * read(ColumnCursor &cursor, std::size_t n, void *buffer) const = 0;
+
+    /** Returns true iff the column can read its elements as runs of equal values, see read_runs(). */
+    virtual bool has_runs() const { return false; }
+    /** Returns the number of runs of equal values of the column, or size() if the column has no runs. */
+    virtual std::size_t num_runs() const { return size(); }
+    /** Reads the runs of equal values of the min(n, size() - cursor.idx) elements at cursor, but at most max_runs runs,
+     * and advances cursor past them.  Writes the value of each run to values and the end of each run, relative to
+     * cursor, to ends.  Returns the number of runs.  The column must have runs. */
+    virtual std::size_t read_runs(ColumnCursor&, std::size_t, std::size_t, void*, uint32_t*) const {
+        dbms_unreachable("the column has no runs");
+    }
+    /** Advances cursor past the min(n, size() - cursor.idx) elements at cursor without reading them. */
+    virtual void skip(ColumnCursor &cursor, std::size_t n) const { cursor.idx += std::min(n, size() - cursor.idx); }
+
+    /** Returns the number of entries of the dictionary of a dictionary compressed column, or 0 if the column has no
+     * dictionary. */
+    virtual std::size_t dictionary_size() const { return 0; }
+    /** Writes the values of the n dictionary entries with indices from begin on to values. */
+    virtual void read_dictionary(std::size_t, std::size_t, void*) const {
+        dbms_unreachable("the column has no dictionary");
+    }
+    /** Reads runs like read_runs(), but writes the dictionary index of each run to indices instead of its value. */
+    virtual std::size_t read_index_runs(ColumnCursor&, std::size_t, std::size_t, uint32_t*, uint32_t*) const {
+        dbms_unreachable("the column has no dictionary");
+    }
+
+    /** Returns true iff the column compares strings with its encoded elements, see match(). */
+    virtual bool has_string_matching() const { return false; }
+    /** Evaluates for the min(n, size() - cursor.idx) elements at cursor, whether they equal str, or start with str if
+     * is_prefix, writes 1 or 0 for each element to mask, and advances cursor past them.  Returns the number of
+     * elements. */
+    virtual std::size_t match(ColumnCursor&, std::size_t, const char*, bool, uint8_t*) const {
+        dbms_unreachable("the column cannot match strings");
+    }
+
+    /** Writes the contents of the column to a snapshot. */
+    virtual void write_snapshot(SnapshotWriter &out) const = 0;
+    /** Replaces the contents of the column by the contents read from a snapshot.  The column may reference its data
+     * within the mapped snapshot. */
+    virtual void read_snapshot(SnapshotReader &in) = 0;
+
     virtual void dump(std::ostream&) const = 0;
     virtual void dump() const = 0;
 };
@@ -288,8 +439,13 @@ struct ColumnBase
  */
 struct GenericColumn : ColumnBase
 {
-    GenericColumn(std::size_t elem_size) : data_(nullptr), size_(0), capacity_(0), elem_size_(elem_size) { reserve(8); }
-    ~GenericColumn() { free(data_); }
+    GenericColumn(std::size_t elem_size)
+        : data_(nullptr), size_(0), capacity_(0), elem_size_(elem_size), reserved_(0), owns_data_(true)
+        , policy_(MemoryPolicy::Default())
+    {
+        reserve(8);
+    }
+    ~GenericColumn() { release_data(); }
     GenericColumn(const GenericColumn &other) = delete;
     GenericColumn(GenericColumn&&) = default;
 
@@ -298,9 +454,49 @@ struct GenericColumn : ColumnBase
     virtual std::size_t capacity() const { return capacity_; }
     virtual std::size_t capacity_in_bytes() const { return capacity_ * elem_size_; }
     std::size_t elem_size() const { return elem_size_; }
+    /** Returns a pointer to the elements of the column. */
+    const void * data() const { return data_; }
+
+    virtual bool is_compressed() const { return false; }
+    virtual std::string type_tag() const { return "Bytes" + std::to_string(elem_size_); }
+    /** Returns true iff the elements can be copied bytewise, i.e. do not own any resources. */
+    virtual bool has_trivial_elements() const { return true; }
 
     /** Increases the capacity of the store to a value greater or equal to new_cap. */
     void reserve(std::size_t new_cap);
+    /** Moves the elements to a reservation of address space for max_cap elements, which becomes the capacity of the
+     * column.  Up to max_cap elements, the column then grows in place: appending never copies the elements, and
+     * addresses of elements remain valid.  Physical memory is committed page wise as elements are appended.  Growing
+     * beyond max_cap moves the elements to a larger reservation. */
+    void reserve_address_space(std::size_t max_cap);
+    /** Moves the elements to memory allocated according to policy, which is used for all further allocations. */
+    void set_memory_policy(const MemoryPolicy &policy);
+    const MemoryPolicy & memory_policy() const { return policy_; }
+    /** Appends bytewise copies of the first n elements of the uncompressed column other at the end of the column.
+     * Both columns must have the same element size, and the elements of other must be trivial. */
+    virtual void append(const GenericColumn &other, std::size_t n);
+    virtual ColumnCursor cursor(std::size_t idx) const {
+        ColumnCursor cursor;
+        cursor.idx = idx;
+        return cursor;
+    }
+    virtual const void * read(ColumnCursor &cursor, std::size_t n, void*) const {
+        const void *elems = static_cast<const uint8_t*>(data_) + cursor.idx * elem_size_;
+        cursor.idx += std::min(n, size_ - cursor.idx);
+        return elems;
+    }
+    /** Appends n uninitialized elements at the end of the column and returns a pointer to the first of them.  The
+     * capacity is increased if necessary. */
+    void * append(std::size_t n) {
+        if (size_ + n > capacity_)
+            reserve(std::max(size_ + n, capacity_ + capacity_ / 2));
+        void *elem = static_cast<uint8_t*>(data_) + size_ * elem_size_;
+        size_ += n;
+        return elem;
+    }
+
+    virtual void write_snapshot(SnapshotWriter &out) const;
+    virtual void read_snapshot(SnapshotReader &in);
 
     friend std::ostream & operator<<(std::ostream &out, const GenericColumn &column) {
         return out << "GenericColumn (" << column.size_ << '/' << column.capacity_ << " elements, "
@@ -313,6 +509,13 @@ struct GenericColumn : ColumnBase
     std::size_t size_; ///< number of stored elements
     std::size_t capacity_; ///< number of allocated elements
     std::size_t elem_size_; ///< the size of an element in bytes
+    std::size_t reserved_; ///< number of elements in the address space reservation at data_, or 0 if data_ is malloc'd
+    bool owns_data_; ///< whether data_ was allocated by the column, or references a snapshot
+    MemoryPolicy policy_; ///< the policy to allocate data_ with
+
+    private:
+    /** Releases data_, if owned. */
+    void release_data();
 };
 
 /**
@@ -347,6 +550,51 @@ struct Column : GenericColumn
 
     void push_back(T value);
 
+    virtual std::string type_tag() const { return "Plain<" + value_tag<T>() + ">"; }
+    virtual bool has_trivial_elements() const { return std::is_trivially_copyable<T>::value; }
+    /** Appends copies of the first n elements of other at the end of the column.  Trivial elements are copied
+     * bytewise, all others are copy constructed, which requires other to be a column of the same type. */
+    virtual void append(const GenericColumn &other, std::size_t n) {
+        if constexpr (std::is_trivially_copyable<T>::value) {
+            GenericColumn::append(other, n);
+        } else {
+            auto column = dynamic_cast<const Column<T>*>(&other);
+            assert(column, "can only append columns of the same type");
+            assert(n <= column->size_, "not enough elements");
+            const T *src = static_cast<const T*>(column->data_);
+            T *dest = static_cast<T*>(GenericColumn::append(n));
+            for (std::size_t i = 0; i != n; ++i)
+                new (dest + i) T(src[i]);
+        }
+    }
+    using GenericColumn::append;
+
+    /** Returns a span of the at most n elements starting at index start. */
+    Span<T> fetch(std::size_t start, std::size_t n) {
+        assert(start <= size_, "start out of bounds");
+        return Span<T>(static_cast<T*>(data_) + start, std::min(n, size_ - start));
+    }
+    Span<const T> fetch(std::size_t start, std::size_t n) const {
+        assert(start <= size_, "start out of bounds");
+        return Span<const T>(static_cast<const T*>(data_) + start, std::min(n, size_ - start));
+    }
+    /** Copies the at most n elements starting at index start to buffer and returns the number of copied elements.
+     * Compressed columns provide the same method to decode a batch of elements. */
+    std::size_t fetch(std::size_t start, std::size_t n, T *buffer) const {
+        auto batch = fetch(start, n);
+        std::copy(batch.begin(), batch.end(), buffer);
+        return batch.size();
+    }
+
+    virtual void write_snapshot(SnapshotWriter &out) const {
+        if constexpr (std::is_trivially_copyable<T>::value) GenericColumn::write_snapshot(out);
+        else dbms_unreachable("column type does not support snapshots");
+    }
+    virtual void read_snapshot(SnapshotReader &in) {
+        if constexpr (std::is_trivially_copyable<T>::value) GenericColumn::read_snapshot(in);
+        else dbms_unreachable("column type does not support snapshots");
+    }
+
     friend std::ostream & operator<<(std::ostream &out, const Column<T> &column) {
         return out << "Column<" << typeid(T).name() << "> (" << column.size_ << '/' << column.capacity_ << " elements, "
                    << column.elem_size_ << "B)";
@@ -385,8 +633,16 @@ struct ColumnStore final : public Store
 
     static ColumnStore Create_Naive(const Relation &relation);
     static ColumnStore Create_Explicit(std::initializer_list<ColumnBase*> columns);
+    /** Creates a store of the given columns, which are owned by the store. */
+    static ColumnStore Create_Explicit(std::vector<ColumnBase*> columns);
+    /** Opens the snapshot in file filename of a store that was created with Create_Naive(relation). */
+    static ColumnStore Open_Snapshot(const char *filename, const Relation &relation);
+    /** Opens the snapshot in file filename of a store that consists of columns of the same types as columns, in the
+     * same order.  The given columns are filled from the snapshot and owned by the returned store. */
+    static ColumnStore Open_Snapshot(const char *filename, std::initializer_list<ColumnBase*> columns);
 
     std::size_t size() const { return columns_[0]->size(); }
+    std::size_t num_columns() const { return columns_.size(); }
     std::size_t size_in_bytes() const;
     std::size_t capacity() const { return columns_[0]->capacity(); }
     std::size_t capacity_in_bytes() const;
@@ -397,6 +653,22 @@ struct ColumnStore final : public Store
     const Column<T> & get_column(std::size_t offset) const {
         return const_cast<ColumnStore*>(this)->get_column<T>(offset);
     }
+    /** Returns the untyped column at offset. */
+    ColumnBase & get_column(std::size_t offset) { return *columns_[offset]; }
+    const ColumnBase & get_column(std::size_t offset) const { return *columns_[offset]; }
+
+    /** Reserves address space for max_rows rows in every uncompressed column, see
+     * GenericColumn::reserve_address_space().  Compressed columns keep their allocations. */
+    void reserve_address_space(std::size_t max_rows);
+    /** Sets the memory policy of every uncompressed column, see GenericColumn::set_memory_policy(). */
+    void set_memory_policy(const MemoryPolicy &policy);
+
+    /** Appends the first n_rows rows of other at the end of the store.  other must consist of uncompressed columns
+     * holding the value types of the columns of this store, which are encoded if this store is compressed. */
+    void append(const ColumnStore &other, std::size_t n_rows);
+
+    /** Writes a snapshot of the store to file filename. */
+    void save_snapshot(const char *filename) const;
 
     friend std::ostream & operator<<(std::ostream &out, const ColumnStore &store) {
         out << "ColumnStore (" << store.columns_.size() << " columns: [";
@@ -409,7 +681,11 @@ struct ColumnStore final : public Store
     DECLARE_DUMP
 
     private:
+    /** Fills the columns of the store from the snapshot in file filename. */
+    void read_snapshot(const char *filename);
+
     std::vector<ColumnBase*> columns_;
+    std::shared_ptr<void> snapshot_; ///< the mapping of the snapshot the store was opened from
 };
 
 }
@@ -162,18 +162,31 @@ int main(int argc, char **argv)
     auto Q4 = [=](const ColumnStore &store) { return query::milestone2::Q4(store, O, L); };
     using query::milestone2::Q2;
     using query::milestone2::Q3;
-#define BENCHMARK(QUERY, STORE) { \
+#define BENCHMARK(QUERY, STORE, NAME) { \
     auto start = high_resolution_clock::now(); \
     auto result = QUERY(*(STORE)); \
     auto stop = high_resolution_clock::now(); \
-    std::cout << "Milestone2, " #QUERY ", " #STORE ", " << result << ", " \
+    std::cout << NAME ", " #QUERY ", " #STORE ", " << result << ", " \
               << duration_cast<nanoseconds>(stop - start).count() / 1e6 << " ms, " \
               << mem_compressed / double(1024) << " MiB" \
               << std::endl; \
 }
-    BENCHMARK(Q2, compressed_columnstore);
-    BENCHMARK(Q3, compressed_columnstore);
-    BENCHMARK(Q4, compressed_columnstore);
+    BENCHMARK(Q2, compressed_columnstore, "Milestone2");
+    BENCHMARK(Q3, compressed_columnstore, "Milestone2");
+    BENCHMARK(Q4, compressed_columnstore, "Milestone2");
+    {
+        auto Q2 = [&](const ColumnStore &store) { return query::vectorized::Q2(store, lineitem); };
+        auto Q3 = [&](const ColumnStore &store) { return query::vectorized::Q3(store, lineitem); };
+        auto Q4 = [&](const ColumnStore &store) { return query::vectorized::Q4(store, lineitem, O, L); };
+        BENCHMARK(Q2, compressed_columnstore, "Vectorized");
+        BENCHMARK(Q3, compressed_columnstore, "Vectorized");
+        BENCHMARK(Q4, compressed_columnstore, "Vectorized");
+    }
+    {
+        auto Q3 = [&](const ColumnStore &store) { return query::parallel::Q3(store, lineitem); };
+        BENCHMARK(Q3, compressed_columnstore, "Parallel");
+    }
+#undef BENCHMARK
 
     delete compressed_columnstore;
 }
@@ -193,26 +193,29 @@ int main(int argc, char **argv)
     head = exhaust_reserved_memory(head);
     ColumnStore *compressed_columnstore = compress_columnstore_lineitem(lineitem, *lineitem_store);
 
-#define BENCHMARK(QUERY, ...) { \
+#define BENCHMARK(NAME, NAMESPACE, QUERY, ...) { \
     const char *qstr = #QUERY; \
     head = exhaust_reserved_memory(head); \
     asm volatile ("" : : : "memory"); \
     const auto mem_before = get_memory_reserved(); \
     auto start = high_resolution_clock::now(); \
-    auto result = query::milestone3:: QUERY(__VA_ARGS__); \
+    auto result = query::NAMESPACE::QUERY(__VA_ARGS__); \
     asm volatile ("" : : : "memory"); \
     const auto mem_after = get_memory_reserved(); \
     auto stop = high_resolution_clock::now(); \
-    std::cout << "Milestone3, " << qstr << ", compressed_columnstore, " << result << ", " \
+    std::cout << NAME ", " << qstr << ", compressed_columnstore, " << result << ", " \
               << duration_cast<nanoseconds>(stop - start).count() / 1e6 << " ms, " \
               << (mem_after - mem_before) / 1024.f << " MiB" \
               << std::endl; \
 }
 
     /* Execute the queries. */
-    BENCHMARK(Q3, *compressed_columnstore, shipdate_index);
-    BENCHMARK(Q4, *compressed_columnstore, O, L, primary_index);
-    BENCHMARK(Q5, *compressed_columnstore, *orders_store);
+    BENCHMARK("Milestone3", milestone3, Q3, *compressed_columnstore, shipdate_index);
+    BENCHMARK("Milestone3", milestone3, Q4, *compressed_columnstore, O, L, primary_index);
+    BENCHMARK("Milestone3", milestone3, Q5, *compressed_columnstore, *orders_store);
+    BENCHMARK("Vectorized", vectorized, Q5, *compressed_columnstore, lineitem, *orders_store, orders);
+    BENCHMARK("Parallel", parallel, Q5, *compressed_columnstore, lineitem, *orders_store, orders);
+#undef BENCHMARK
 
     delete lineitem_store;
     delete orders_store;
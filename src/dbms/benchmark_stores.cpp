@@ -63,4 +63,29 @@ int main(int argc, char **argv)
     BENCHMARK(Q1, columnstore);
     BENCHMARK(Q2, rowstore);
     BENCHMARK(Q2, columnstore);
+#undef BENCHMARK
+
+#define BENCHMARK(QUERY, STORE) { \
+    auto start = high_resolution_clock::now(); \
+    auto result = query::vectorized::QUERY(STORE, lineitem); \
+    auto stop = high_resolution_clock::now(); \
+    std::cout << "Vectorized, " #QUERY ", " #STORE ", " << result << ", " << duration_cast<nanoseconds>(stop - start).count() / 1e6 << " ms" << std::endl; \
+}
+    BENCHMARK(Q1, rowstore);
+    BENCHMARK(Q1, columnstore);
+    BENCHMARK(Q2, rowstore);
+    BENCHMARK(Q2, columnstore);
+#undef BENCHMARK
+
+#define BENCHMARK(QUERY, STORE) { \
+    auto start = high_resolution_clock::now(); \
+    auto result = query::parallel::QUERY(STORE, lineitem); \
+    auto stop = high_resolution_clock::now(); \
+    std::cout << "Parallel (" << ThreadPool::Default().num_workers() << " threads), " #QUERY ", " #STORE ", " << result << ", " << duration_cast<nanoseconds>(stop - start).count() / 1e6 << " ms" << std::endl; \
+}
+    BENCHMARK(Q1, rowstore);
+    BENCHMARK(Q1, columnstore);
+    BENCHMARK(Q2, rowstore);
+    BENCHMARK(Q2, columnstore);
+#undef BENCHMARK
 }
@@ -48,5 +48,18 @@ int main(int argc, char **argv)
         << "Compressed ColumnStore: " << compressed_columnstore->size_in_bytes() / double(1024 * 1024) << " MiB"
         << std::endl;
 
+    /* Load directly into the compressed columns, without materializing the uncompressed store. */
+    ColumnStore direct_columnstore = create_compressed_columnstore_lineitem();
+    {
+        auto start = high_resolution_clock::now();
+        Loader::load_LineItem(filename, lineitem, direct_columnstore);
+        auto stop = high_resolution_clock::now();
+        std::cout << "Directly loaded compressed ColumnStore: "
+                  << direct_columnstore.size_in_bytes() / double(1024 * 1024) << " MiB, "
+                  << duration_cast<nanoseconds>(stop - start).count() / 1e6 << " ms" << std::endl;
+    }
+    if (direct_columnstore.size_in_bytes() != compressed_columnstore->size_in_bytes())
+        errx(EXIT_FAILURE, "Directly loaded store differs from the compressed store");
+
     delete compressed_columnstore;
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "dbms/Scheduler.hpp"
+#include "dbms/Schema.hpp"
 #include "dbms/Store.hpp"
 #include <cstdint>
 #include <functional>
@@ -60,6 +62,34 @@ unsigned Q5(const ColumnStore &lineitem, const ColumnStore &orders);
 
 }
 
+/* The queries composed from vectorized operators, see Operator.hpp.  Attributes are looked up by name in the relations
+ * of the stores, hence the queries apply to uncompressed and compressed stores alike. */
+namespace vectorized {
+
+uint64_t Q1(const RowStore &store, const Relation &relation);
+uint64_t Q1(const ColumnStore &store, const Relation &relation);
+unsigned Q2(const RowStore &store, const Relation &relation);
+unsigned Q2(const ColumnStore &store, const Relation &relation);
+unsigned Q3(const ColumnStore &store, const Relation &relation);
+unsigned Q4(const ColumnStore &store, const Relation &relation, uint32_t O, uint32_t L);
+unsigned Q5(const ColumnStore &lineitem, const Relation &lineitem_relation,
+            const ColumnStore &orders, const Relation &orders_relation);
+
+}
+
+/* The vectorized queries, executed morsel-driven on all workers of pool. */
+namespace parallel {
+
+uint64_t Q1(const RowStore &store, const Relation &relation, ThreadPool &pool = ThreadPool::Default());
+uint64_t Q1(const ColumnStore &store, const Relation &relation, ThreadPool &pool = ThreadPool::Default());
+unsigned Q2(const RowStore &store, const Relation &relation, ThreadPool &pool = ThreadPool::Default());
+unsigned Q2(const ColumnStore &store, const Relation &relation, ThreadPool &pool = ThreadPool::Default());
+unsigned Q3(const ColumnStore &store, const Relation &relation, ThreadPool &pool = ThreadPool::Default());
+unsigned Q5(const ColumnStore &lineitem, const Relation &lineitem_relation,
+            const ColumnStore &orders, const Relation &orders_relation, ThreadPool &pool = ThreadPool::Default());
+
+}
+
 }
 
 }
@@ -39,6 +39,62 @@ inline void int_to_date(uint32_t date, uint32_t &year, uint32_t &month, uint32_t
     year = date;
 }
 
+/** Parses a date in the fixed format YYYY-MM-DD from the ten characters at str into the encoding of date_to_int().
+ * Returns false and leaves date unchanged, if the characters are not a date in that format. */
+inline bool parse_date_scalar(const char *str, uint32_t &date)
+{
+    static constexpr bool is_digit[10] = { 1, 1, 1, 1, 0, 1, 1, 0, 1, 1 };
+    uint32_t digits[10];
+    for (unsigned i = 0; i != 10; ++i) {
+        if (is_digit[i]) {
+            digits[i] = uint8_t(str[i] - '0');
+            if (digits[i] > 9) return false;
+        } else if (str[i] != '-') {
+            return false;
+        }
+    }
+
+    const uint32_t year  = digits[0] * 1000 + digits[1] * 100 + digits[2] * 10 + digits[3];
+    const uint32_t month = digits[5] * 10 + digits[6];
+    const uint32_t day   = digits[8] * 10 + digits[9];
+    if (month - 1 >= 12 or day - 1 >= 31) return false;
+    date = date_to_int(year, month, day);
+    return true;
+}
+
+/** Same as parse_date_scalar(), but validates and converts all digits at once with SIMD within a register. */
+inline bool parse_date_swar(const char *str, uint32_t &date)
+{
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint64_t ymd; // "YYYY-MM-"
+    uint16_t dd;  // "DD"
+    memcpy(&ymd, str, sizeof(ymd));
+    memcpy(&dd, str + 8, sizeof(dd));
+
+    /* Validate the dashes, and that every digit has the high nibble 3 and a low nibble of at most 9. */
+    constexpr uint64_t DIGITS = 0x00ffff00ffffffff;
+    constexpr uint64_t DASHES = 0xff0000ff00000000;
+    if ((ymd & DASHES) != (0x2d00002d00000000 & DASHES)) return false;
+    if ((ymd & (0xf0f0f0f0f0f0f0f0 & DIGITS)) != (0x3030303030303030 & DIGITS)) return false;
+    if (((ymd + (0x0606060606060606 & DIGITS)) & (0xf0f0f0f0f0f0f0f0 & DIGITS)) != (0x3030303030303030 & DIGITS))
+        return false;
+    if ((dd & 0xf0f0) != 0x3030 or ((dd + 0x0606) & 0xf0f0) != 0x3030) return false;
+
+    /* Combine the four year digits pairwise into two digit numbers and then into one number. */
+    uint64_t year = ymd & 0x0f0f0f0f;
+    year = (year * 10 + (year >> 8)) & 0x00ff00ff;
+    year = (year * 100 + (year >> 16)) & 0xffff;
+    const uint32_t month = ((ymd >> 40) & 0xf) * 10 + ((ymd >> 48) & 0xf);
+    const uint32_t day   = (dd & 0xf) * 10 + ((dd >> 8) & 0xf);
+
+    if (month - 1 >= 12 or day - 1 >= 31) return false;
+    date = date_to_int(year, month, day);
+    return true;
+#else
+    return parse_date_scalar(str, date);
+#endif
+}
+
 inline bool streq(const char *first, const char *second) { return 0 == strcmp(first, second); }
 
 struct StrHash
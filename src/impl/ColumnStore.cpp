@@ -1,21 +1,95 @@
 #include "impl/ColumnStore.hpp"
 
+#include "dbms/Memory.hpp"
+#include "dbms/Snapshot.hpp"
+#include <err.h>
+
 
 using namespace dbms;
 
 
 void GenericColumn::reserve(std::size_t new_cap)
 {
-    if (new_cap > capacity_) {
-        void *new_data_ = realloc(data_, elem_size_ * new_cap);
-        if (new_data_ != NULL) {
-            data_ = new_data_;
-            capacity_ = new_cap;
-        }
-        //TODO handle memory allocation failure -(alternate) use malloc and handle memory chunks
+    if (new_cap > capacity_ and reserved_) {
+        /* The reservation is exhausted.  Move to a larger one. */
+        reserve_address_space(std::max(new_cap, 2 * reserved_));
+    } else if (new_cap > capacity_ and not owns_data_) {
+        /* The data references a snapshot.  Copy it to memory of our own. */
+        void *new_data_ = allocate(elem_size_ * new_cap, policy_);
+        memcpy(new_data_, data_, elem_size_ * size_);
+        data_ = new_data_;
+        capacity_ = new_cap;
+        owns_data_ = true;
+    } else if (new_cap > capacity_) {
+        data_ = reallocate(data_, elem_size_ * capacity_, elem_size_ * new_cap, policy_);
+        capacity_ = new_cap;
     }
 }
 
+void GenericColumn::reserve_address_space(std::size_t max_cap)
+{
+    max_cap = std::max({ max_cap, capacity_, std::size_t(1) });
+    if (max_cap <= reserved_) return;
+
+    void *new_data = reserve_pages(max_cap * elem_size_, policy_);
+    memcpy(new_data, data_, size_ * elem_size_);
+    release_data();
+    data_ = new_data;
+    capacity_ = reserved_ = max_cap;
+    owns_data_ = true;
+}
+
+void GenericColumn::set_memory_policy(const MemoryPolicy &policy)
+{
+    void *new_data = reserved_ ? reserve_pages(reserved_ * elem_size_, policy)
+                               : allocate(capacity_ * elem_size_, policy);
+    if (size_) memcpy(new_data, data_, size_ * elem_size_);
+    release_data();
+    data_ = new_data;
+    owns_data_ = true;
+    policy_ = policy;
+}
+
+void GenericColumn::release_data()
+{
+    if (reserved_)
+        release_pages(data_, reserved_ * elem_size_, policy_);
+    else if (owns_data_)
+        deallocate(data_, capacity_ * elem_size_, policy_);
+}
+
+void GenericColumn::append(const GenericColumn &other, std::size_t n)
+{
+    assert(not other.is_compressed(), "can only append uncompressed columns");
+    assert(other.has_trivial_elements(), "can only copy trivial elements bytewise");
+    assert(elem_size_ == other.elem_size_, "element sizes differ");
+    assert(n <= other.size_, "not enough elements");
+    memcpy(append(n), other.data_, n * elem_size_);
+}
+
+void GenericColumn::write_snapshot(SnapshotWriter &out) const
+{
+    out.put<uint64_t>(elem_size_);
+    out.put<uint64_t>(size_);
+    out.put_data(data_, size_ * elem_size_);
+}
+
+void GenericColumn::read_snapshot(SnapshotReader &in)
+{
+    const uint64_t elem_size = in.get<uint64_t>();
+    const uint64_t size = in.get<uint64_t>();
+    std::size_t num_bytes;
+    void *data = in.get_data(num_bytes);
+    if (elem_size != elem_size_ or num_bytes != size * elem_size)
+        in.layout_mismatch();
+
+    release_data();
+    data_ = data;
+    size_ = capacity_ = size;
+    reserved_ = 0;
+    owns_data_ = false;
+}
+
 ColumnStore::~ColumnStore()
 {
     for (auto column_ : columns_)
@@ -46,6 +120,87 @@ ColumnStore ColumnStore::Create_Explicit(std::initializer_list<ColumnBase*> colu
     return column_store;
 }
 
+ColumnStore ColumnStore::Create_Explicit(std::vector<ColumnBase*> columns)
+{
+    ColumnStore column_store;
+    column_store.columns_ = std::move(columns);
+    return column_store;
+}
+
+void ColumnStore::reserve_address_space(std::size_t max_rows)
+{
+    /* Compressed columns derive from GenericColumn, too, but their elements are not rows. */
+    for (auto column : columns_) {
+        if (column->is_compressed()) continue;
+        if (auto generic = dynamic_cast<GenericColumn*>(column))
+            generic->reserve_address_space(max_rows);
+    }
+}
+
+void ColumnStore::set_memory_policy(const MemoryPolicy &policy)
+{
+    for (auto column : columns_) {
+        if (column->is_compressed()) continue;
+        if (auto generic = dynamic_cast<GenericColumn*>(column))
+            generic->set_memory_policy(policy);
+    }
+}
+
+void ColumnStore::append(const ColumnStore &other, std::size_t n_rows)
+{
+    assert(columns_.size() == other.columns_.size(), "stores have different number of columns");
+    for (std::size_t i = 0, end = columns_.size(); i != end; ++i) {
+        auto column = dynamic_cast<const GenericColumn*>(other.columns_[i]);
+        assert(column and not column->is_compressed(), "can only append uncompressed columns");
+        columns_[i]->append(*column, n_rows);
+    }
+}
+
+void ColumnStore::save_snapshot(const char *filename) const
+{
+    /* Check before the file is created, such that no partial snapshot remains. */
+    for (auto column : columns_) {
+        auto generic = dynamic_cast<const GenericColumn*>(column);
+        if (generic and not generic->has_trivial_elements())
+            errx(EXIT_FAILURE, "Cannot save a snapshot of a column of type %s to file '%s'",
+                 column->type_tag().c_str(), filename);
+    }
+
+    SnapshotWriter out(filename, Snapshot::SK_ColumnStore);
+    out.put<uint64_t>(columns_.size());
+    for (auto column : columns_) {
+        out.put_string(column->type_tag().c_str());
+        column->write_snapshot(out);
+    }
+    out.close();
+}
+
+void ColumnStore::read_snapshot(const char *filename)
+{
+    SnapshotReader in(filename, Snapshot::SK_ColumnStore);
+    if (in.get<uint64_t>() != columns_.size())
+        in.layout_mismatch();
+    for (auto column : columns_) {
+        in.expect_string(column->type_tag().c_str());
+        column->read_snapshot(in);
+    }
+    snapshot_ = in.mapping();
+}
+
+ColumnStore ColumnStore::Open_Snapshot(const char *filename, const Relation &relation)
+{
+    ColumnStore column_store = Create_Naive(relation);
+    column_store.read_snapshot(filename);
+    return column_store;
+}
+
+ColumnStore ColumnStore::Open_Snapshot(const char *filename, std::initializer_list<ColumnBase*> columns)
+{
+    ColumnStore column_store = Create_Explicit(columns);
+    column_store.read_snapshot(filename);
+    return column_store;
+}
+
 std::size_t ColumnStore::size_in_bytes() const
 {
     std::size_t size_bytes = 0;
@@ -1,67 +1,514 @@
 #include "impl/Compression.hpp"
 #include "impl/ColumnStore.hpp"
 #include "dbms/Store.hpp"
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <utility>
 
 
 using namespace dbms;
 
 
+ColumnStore dbms::create_compressed_columnstore_lineitem()
+{
+    return ColumnStore::Create_Explicit({
+            new Column<RLE<uint8_t>>(),
+            new Column<RLE<uint64_t>>(),
+            new Column<RLE<uint8_t>>(),
+            new Column<RLE<uint64_t>>(),
+            new Column<RLE<uint32_t>>(),
+            new Column<RLE<uint64_t>>(),
+            new Column<RLE<Char<26>>>(),
+            new Column<RLE<uint32_t>>(),
+            new Column<RLE<uint32_t>>(),
+            new Column<RLE<uint32_t>>(),
+            new Column<RLE<uint32_t>>(),
+            new Column<RLE<uint32_t>>(),
+            new Column<RLE<uint32_t>>(),
+            new Column<RLE<Char<11>>>(),
+            new Column<RLE<Char<45>>>(),
+            new Column<RLE<uint64_t>>(),
+            });
+}
+
 ColumnStore * dbms::compress_columnstore_lineitem(const Relation &relation, const ColumnStore &store)
 {
-    Column<RLE<uint8_t>> * col0 = new Column<RLE<uint8_t>>();
-    Column<RLE<uint64_t>> * col1 = new Column<RLE<uint64_t>>();
-    Column<RLE<uint8_t>> * col2 = new Column<RLE<uint8_t>>();
-    Column<RLE<uint64_t>> * col3 = new Column<RLE<uint64_t>>();
-    Column<RLE<uint32_t>> * col4 = new Column<RLE<uint32_t>>();
-    Column<RLE<uint64_t>> * col5 = new Column<RLE<uint64_t>>();
-    Column<RLE<Char<26>>> * col6 = new Column<RLE<Char<26>>>();
-    Column<RLE<uint32_t>> * col7 = new Column<RLE<uint32_t>>();
-    Column<RLE<uint32_t>> * col8 = new Column<RLE<uint32_t>>();
-    Column<RLE<uint32_t>> * col9 = new Column<RLE<uint32_t>>();
-    Column<RLE<uint32_t>> * col10 = new Column<RLE<uint32_t>>();
-    Column<RLE<uint32_t>> * col11 = new Column<RLE<uint32_t>>();
-    Column<RLE<uint32_t>> * col12 = new Column<RLE<uint32_t>>();
-    Column<RLE<Char<11>>> * col13 = new Column<RLE<Char<11>>>();
-    Column<RLE<Char<45>>> * col14 = new Column<RLE<Char<45>>>();
-    Column<RLE<uint64_t>> * col15 = new Column<RLE<uint64_t>>();
-
-    auto orig_col0_it = store.get_column<uint8_t>(0).begin();
-    auto orig_col1_it = store.get_column<uint64_t>(1).begin();
-    auto orig_col2_it = store.get_column<uint8_t>(2).begin();
-    auto orig_col3_it = store.get_column<uint64_t>(3).begin();
-    auto orig_col4_it = store.get_column<uint32_t>(4).begin();
-    auto orig_col5_it = store.get_column<uint64_t>(5).begin();
-    auto orig_col6_it = store.get_column<Char<26>>(6).begin();
-    auto orig_col7_it = store.get_column<uint32_t>(7).begin();
-    auto orig_col8_it = store.get_column<uint32_t>(8).begin();
-    auto orig_col9_it = store.get_column<uint32_t>(9).begin();
-    auto orig_col10_it = store.get_column<uint32_t>(10).begin();
-    auto orig_col11_it = store.get_column<uint32_t>(11).begin();
-    auto orig_col12_it = store.get_column<uint32_t>(12).begin();
-    auto orig_col13_it = store.get_column<Char<11>>(13).begin();
-    auto orig_col14_it = store.get_column<Char<45>>(14).begin();
-    auto orig_col15_it = store.get_column<uint64_t>(15).begin();
-
-    for (unsigned i = 0; i < store.size(); ++i) {
-        col0->push_back(*orig_col0_it++);
-        col1->push_back(*orig_col1_it++);
-        col2->push_back(*orig_col2_it++);
-        col3->push_back(*orig_col3_it++);
-        col4->push_back(*orig_col4_it++);
-        col5->push_back(*orig_col5_it++);
-        col6->push_back(*orig_col6_it++);
-        col7->push_back(*orig_col7_it++);
-        col8->push_back(*orig_col8_it++);
-        col9->push_back(*orig_col9_it++);
-        col10->push_back(*orig_col10_it++);
-        col11->push_back(*orig_col11_it++);
-        col12->push_back(*orig_col12_it++);
-        col13->push_back(*orig_col13_it++);
-        col14->push_back(*orig_col14_it++);
-        col15->push_back(*orig_col15_it++);
+    ColumnStore *compress_colstore = new ColumnStore(create_compressed_columnstore_lineitem());
+    compress_colstore->append(store, store.size());
+    return compress_colstore;
+}
+
+
+/*======================================================================================================================
+ * String compression
+ *====================================================================================================================*/
+
+/* Symbols are compared with the leading bytes of 64 bit words, that are loaded from strings. */
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "symbol tables require a little endian target");
+
+SymbolTable::SymbolTable(const uint64_t *symbols, const uint8_t *lengths, std::size_t num_symbols)
+    : num_symbols_(num_symbols)
+{
+    assert(num_symbols <= MAX_SYMBOLS, "too many symbols");
+    std::copy_n(symbols, num_symbols, symbols_);
+    std::copy_n(lengths, num_symbols, lengths_);
+    build_lookup();
+}
+
+void SymbolTable::build_lookup()
+{
+    std::fill_n(single_, 256, ESCAPE);
+    long_codes_.clear();
+    for (std::size_t code = 0; code != num_symbols_; ++code) {
+        if (lengths_[code] == 1) single_[symbols_[code] & 0xff] = uint8_t(code);
+        else long_codes_.push_back(uint8_t(code));
     }
+    auto bucket = [this](uint8_t code) { return bucket_of(symbols_[code]); };
+    std::sort(long_codes_.begin(), long_codes_.end(), [&](uint8_t first, uint8_t second) {
+        if (bucket(first) != bucket(second)) return bucket(first) < bucket(second);
+        return lengths_[first] > lengths_[second];
+    });
+    std::fill_n(bucket_begin_, NUM_BUCKETS + 1, 0);
+    for (uint8_t code : long_codes_)
+        ++bucket_begin_[bucket(code) + 1];
+    for (std::size_t i = 1; i != NUM_BUCKETS + 1; ++i)
+        bucket_begin_[i] += bucket_begin_[i - 1];
+}
 
-    ColumnStore* compress_colstore = new ColumnStore(ColumnStore::Create_Explicit({col0, col1, col2, col3, col4, col5, col6, col7, col8, col9, col10, col11, col12, col13, col14, col15}));
+std::size_t SymbolTable::encode(const char *str, std::size_t len, uint8_t *out) const
+{
+    assert(len <= MAX_LENGTH, "string is too long to be encoded");
+    /* Pad the string with zeros, such that a word can be loaded at every position. */
+    char padded[MAX_LENGTH + sizeof(uint64_t)];
+    memcpy(padded, str, len);
+    memset(padded + len, 0, sizeof(uint64_t));
 
-    return compress_colstore;
+    uint8_t *p = out;
+    for (std::size_t pos = 0; pos != len; ) {
+        uint64_t word;
+        memcpy(&word, padded + pos, sizeof(word));
+        const std::size_t remaining = len - pos;
+        std::size_t matched = 0;
+        if (remaining >= 2) {
+            /* Try the symbols in the bucket of the next 2 bytes, longest first. */
+            const std::size_t bucket = bucket_of(word);
+            for (std::size_t i = bucket_begin_[bucket], end = bucket_begin_[bucket + 1]; i != end; ++i) {
+                const uint8_t code = long_codes_[i];
+                const std::size_t length = lengths_[code];
+                const uint64_t mask = length == sizeof(uint64_t) ? ~uint64_t(0) : (uint64_t(1) << 8 * length) - 1;
+                if (length <= remaining and (word & mask) == symbols_[code]) {
+                    *p++ = code;
+                    matched = length;
+                    break;
+                }
+            }
+        }
+        if (not matched) {
+            const uint8_t byte = uint8_t(word);
+            const uint8_t code = single_[byte];
+            *p++ = code;
+            if (code == ESCAPE)
+                *p++ = byte;
+            matched = 1;
+        }
+        pos += matched;
+    }
+    return p - out;
+}
+
+bool SymbolTable::starts_with(const uint8_t *codes, std::size_t n, const char *prefix, std::size_t len) const
+{
+    std::size_t pos = 0;
+    for (std::size_t i = 0; i != n and pos != len; ++i) {
+        const uint8_t code = codes[i];
+        if (code == ESCAPE) {
+            if (char(codes[++i]) != prefix[pos])
+                return false;
+            ++pos;
+        } else {
+            const std::size_t length = std::min<std::size_t>(lengths_[code], len - pos);
+            if (memcmp(&symbols_[code], prefix + pos, length) != 0)
+                return false;
+            pos += length;
+        }
+    }
+    return pos == len;
+}
+
+SymbolTable SymbolTable::Train(const char * const *strings, std::size_t n)
+{
+    constexpr unsigned NUM_ROUNDS = 5;
+    /* Symbols of the sample are identified by their code, or by 256 plus the byte for escaped bytes. */
+    constexpr std::size_t NUM_IDS = 512;
+    constexpr uint64_t SINGLE_BYTE_WEIGHT = 8;
+
+    SymbolTable table;
+    std::vector<uint32_t> counts(NUM_IDS), pair_counts(NUM_IDS * NUM_IDS);
+    std::vector<uint8_t> codes(2 * MAX_LENGTH);
+    for (unsigned round = 0; round != NUM_ROUNDS; ++round) {
+        /* Count the symbols and the pairs of adjacent symbols in the encoded sample. */
+        std::fill(counts.begin(), counts.end(), 0);
+        std::fill(pair_counts.begin(), pair_counts.end(), 0);
+        for (std::size_t s = 0; s != n; ++s) {
+            const std::size_t num_codes = table.encode(strings[s], strnlen(strings[s], MAX_LENGTH), codes.data());
+            std::size_t previous = NUM_IDS;
+            for (std::size_t i = 0; i != num_codes; ++i) {
+                const std::size_t id = codes[i] == ESCAPE ? 256 + codes[++i] : codes[i];
+                ++counts[id];
+                /* Count the first byte of a longer symbol as well, such that single bytes can replace escapes when
+                 * the longer symbols are replaced. */
+                if (id < 256 and table.lengths_[id] != 1)
+                    ++counts[256 + (table.symbols_[id] & 0xff)];
+                if (previous != NUM_IDS)
+                    ++pair_counts[previous * NUM_IDS + id];
+                previous = id;
+            }
+        }
+
+        /* Weigh the symbols and the concatenations of adjacent symbols by the number of bytes they covered.  Symbols
+         * of a single byte are weighed higher, as they avoid escapes.  Strings contain no zero bytes, hence the zero
+         * padded bytes of a symbol identify it. */
+        auto symbol = [&table](std::size_t id) { return id < 256 ? table.symbols_[id] : uint64_t(id - 256); };
+        auto length = [&table](std::size_t id) -> std::size_t { return id < 256 ? table.lengths_[id] : 1; };
+        std::unordered_map<uint64_t, uint64_t> gains;
+        for (std::size_t id = 0; id != NUM_IDS; ++id) {
+            if (counts[id])
+                gains[symbol(id)] += uint64_t(counts[id]) * (length(id) == 1 ? SINGLE_BYTE_WEIGHT : length(id));
+        }
+        for (std::size_t first = 0; first != NUM_IDS; ++first) {
+            if (not counts[first]) continue;
+            for (std::size_t second = 0; second != NUM_IDS; ++second) {
+                const uint32_t count = pair_counts[first * NUM_IDS + second];
+                const std::size_t concatenated = length(first) + length(second);
+                if (count and concatenated <= sizeof(uint64_t))
+                    gains[symbol(first) | symbol(second) << 8 * length(first)] += uint64_t(count) * concatenated;
+            }
+        }
+
+        /* Keep the symbols with the largest gains. */
+        std::vector<std::pair<uint64_t, uint64_t>> candidates(gains.begin(), gains.end());
+        const std::size_t num_symbols = std::min(MAX_SYMBOLS, candidates.size());
+        std::partial_sort(candidates.begin(), candidates.begin() + num_symbols, candidates.end(),
+                          [](const auto &first, const auto &second) {
+                              if (first.second != second.second) return first.second > second.second;
+                              return first.first < second.first;
+                          });
+        uint64_t symbols[MAX_SYMBOLS];
+        uint8_t lengths[MAX_SYMBOLS];
+        for (std::size_t i = 0; i != num_symbols; ++i) {
+            symbols[i] = candidates[i].first;
+            lengths[i] = (64 - __builtin_clzll(symbols[i]) + 7) / 8;
+        }
+        table = SymbolTable(symbols, lengths, num_symbols);
+    }
+    return table;
+}
+
+
+/*======================================================================================================================
+ * Encoding selection
+ *====================================================================================================================*/
+
+const char * dbms::encoding_name(Encoding encoding)
+{
+    static const char *names[] = { ENUM_TO_STR(Encoding) };
+    return names[encoding];
+}
+
+namespace {
+
+/** The number of consecutive elements per block of a sample.  Runs and bit widths are estimated within blocks. */
+constexpr std::size_t SAMPLE_BLOCK_SIZE = Column<BitPacked<uint32_t>>::BLOCK_SIZE;
+
+/* Decode times in nanoseconds, measured by scanning the columns of 200K lineitem rows in batches of 1024 elements.
+ * Plain columns are read in place. */
+constexpr double PLAIN_NS = 0.1; ///< per element of a plain column
+constexpr double PACKED_NS = 0.45; ///< per element of a bit-packed or frame-of-reference column
+constexpr double DELTA_NS = 0.65; ///< per element of a delta encoded column
+constexpr double DICTIONARY_NS = 0.7; ///< per element of a dictionary column
+constexpr double RUN_NS = 1.5; ///< per run of a run length encoded column
+constexpr double RUN_ELEMENT_NS = 1.5; ///< per element of a run length encoded column
+constexpr double FSST_NS = 4; ///< per element of a string compressed column
+constexpr double FSST_CODE_NS = 6; ///< per code of a string compressed column
+/** Looking up values in a dictionary larger than LARGE_DICTIONARY bytes misses the caches, and takes
+ * LARGE_DICTIONARY_NS more per element. */
+constexpr std::size_t LARGE_DICTIONARY = 256 * 1024;
+constexpr double LARGE_DICTIONARY_NS = 1.8;
+
+/** The sizes N of Char(N) attributes whose columns can be encoded.  Columns of other Char(N) attributes stay plain. */
+using CharSizes = std::index_sequence<1, 8, 10, 11, 15, 16, 25, 26, 44, 45, 79, 80>;
+
+template<typename F, std::size_t... N>
+bool dispatch_char(std::size_t size, F &&f, std::index_sequence<N...>)
+{
+    return ((size == N and (f(static_cast<Char<N>*>(nullptr)), true)) or ...);
+}
+
+/** Calls f with a null pointer to the type of the values of attr and returns true, or returns false if columns of attr
+ * cannot be encoded. */
+template<typename F>
+bool dispatch_type(const Attribute &attr, F &&f)
+{
+    switch (attr.type) {
+        case Attribute::TY_Int:
+            switch (attr.size) {
+                case 1: f(static_cast<int8_t*>(nullptr)); return true;
+                case 2: f(static_cast<int16_t*>(nullptr)); return true;
+                case 4: f(static_cast<int32_t*>(nullptr)); return true;
+                case 8: f(static_cast<int64_t*>(nullptr)); return true;
+            }
+            return false;
+        case Attribute::TY_Float: f(static_cast<float*>(nullptr)); return true;
+        case Attribute::TY_Double: f(static_cast<double*>(nullptr)); return true;
+        case Attribute::TY_Char: return dispatch_char(attr.size, f, CharSizes());
+        case Attribute::TY_Varchar: return false;
+    }
+    dbms_unreachable("unknown attribute type");
+}
+
+/** Reads about sample_size elements of column in blocks of SAMPLE_BLOCK_SIZE consecutive elements, that are spread
+ * evenly over the column. */
+template<typename T>
+std::vector<T> sample_column(const ColumnBase &column, std::size_t sample_size)
+{
+    const std::size_t num_rows = column.size();
+    const std::size_t num_blocks = std::max<std::size_t>(sample_size / SAMPLE_BLOCK_SIZE, 1);
+    const std::size_t stride = num_rows <= num_blocks * SAMPLE_BLOCK_SIZE ? SAMPLE_BLOCK_SIZE : num_rows / num_blocks;
+    std::vector<T> sample, buffer(SAMPLE_BLOCK_SIZE);
+    for (std::size_t begin = 0; begin < num_rows and sample.size() < num_blocks * SAMPLE_BLOCK_SIZE; begin += stride) {
+        ColumnCursor cursor = column.cursor(begin);
+        const T *values = static_cast<const T*>(column.read(cursor, SAMPLE_BLOCK_SIZE, buffer.data()));
+        sample.insert(sample.end(), values, values + (cursor.idx - begin));
+    }
+    return sample;
+}
+
+template<typename T>
+struct is_char : std::false_type { };
+template<std::size_t N>
+struct is_char<Char<N>> : std::true_type { };
+
+/** Estimates the size and decode time of a string compressed column of num_rows elements, by training a symbol table
+ * on the sample and encoding the sample. */
+template<std::size_t N>
+EncodingEstimate estimate_fsst(const std::vector<Char<N>> &sample, std::size_t num_rows)
+{
+    using column_type = Column<FSST<Char<N>>>;
+    if (sample.empty()) return { EN_FSST, 0, 0 };
+    std::vector<const char*> strings;
+    const std::size_t stride = std::max<std::size_t>(sample.size() / column_type::TRAINING_SIZE, 1);
+    for (std::size_t i = 0; i < sample.size() and strings.size() < column_type::TRAINING_SIZE; i += stride)
+        strings.push_back(sample[i].data);
+    const SymbolTable table = SymbolTable::Train(strings.data(), strings.size());
+
+    std::size_t num_bytes = 0, num_codes = 0;
+    uint8_t codes[2 * N];
+    for (const Char<N> &value : sample) {
+        const std::size_t len = table.encode(value.data, strnlen(value.data, N), codes);
+        num_bytes += len;
+        num_codes += len - std::count(codes, codes + len, SymbolTable::ESCAPE);
+    }
+    const double scale = double(num_rows) / sample.size();
+    const std::size_t size = num_bytes * scale + num_rows * sizeof(uint16_t) +
+                             (num_rows + column_type::BLOCK_SIZE - 1) / column_type::BLOCK_SIZE * sizeof(uint64_t) +
+                             table.size_in_bytes();
+    return { EN_FSST, size, num_rows * FSST_NS + num_codes * scale * FSST_CODE_NS };
+}
+
+/** Returns the size in bytes of a packed block of n elements, whose largest difference to the reference is range. */
+std::size_t packed_block_size(uint64_t range, std::size_t n)
+{
+    const std::size_t bits = range == 0 ? 0 : 64 - __builtin_clzll(range);
+    /* A block has a header of 3 words, and a word of padding if it has any bits. */
+    return 3 * sizeof(uint64_t) + (bits == 0 ? 0 : (n * bits + 63) / 64 * sizeof(uint64_t) + sizeof(uint64_t));
+}
+
+/** Estimates the size and decode time of a column of num_rows elements from a sample for every encoding applicable to
+ * values of type T. */
+template<typename T>
+std::vector<EncodingEstimate> estimate_encodings(const std::vector<T> &sample, std::size_t num_rows)
+{
+    const double scale = sample.empty() ? 0 : double(num_rows) / sample.size();
+    std::size_t num_runs = 0;
+    std::unordered_map<T, std::size_t> counts;
+    for (std::size_t i = 0; i != sample.size(); ++i) {
+        if (i % SAMPLE_BLOCK_SIZE == 0 or not (sample[i] == sample[i - 1]))
+            ++num_runs;
+        ++counts[sample[i]];
+    }
+    /* Estimate the number of distinct values of the column by scaling the number of values seen once in the sample
+     * with the square root of the inverse sampling rate (GEE estimator). */
+    const std::size_t once = std::count_if(counts.begin(), counts.end(), [](const auto &c) { return c.second == 1; });
+    const double num_distinct = std::min<double>(num_rows, std::sqrt(scale) * once + (counts.size() - once));
+    const double runs = num_runs * scale;
+    const double dictionary_size = num_distinct * sizeof(T);
+    const double lookup_ns = dictionary_size > LARGE_DICTIONARY ? LARGE_DICTIONARY_NS : 0;
+
+    std::vector<EncodingEstimate> estimates = {
+        { EN_Plain, num_rows * sizeof(T), num_rows * PLAIN_NS },
+        { EN_RLE, std::size_t(runs * sizeof(RLE<T>)), num_rows * RUN_ELEMENT_NS + runs * RUN_NS },
+        { EN_Dictionary, std::size_t(num_rows * sizeof(uint32_t) + dictionary_size),
+          num_rows * (DICTIONARY_NS + lookup_ns) },
+        { EN_RLE_Dictionary, std::size_t(runs * sizeof(RLE<uint32_t>) + dictionary_size),
+          num_rows * RUN_ELEMENT_NS + runs * (RUN_NS + lookup_ns) },
+    };
+
+    if constexpr (std::is_integral<T>::value) {
+        using U = std::make_unsigned_t<T>;
+        std::size_t bitpacked = 0, frame = 0, delta = 0;
+        for (std::size_t begin = 0; begin < sample.size(); begin += SAMPLE_BLOCK_SIZE) {
+            const std::size_t end = std::min(begin + SAMPLE_BLOCK_SIZE, sample.size());
+            U max_unsigned = 0;
+            T min = sample[begin], max = sample[begin];
+            T min_difference = 0, max_difference = 0;
+            for (std::size_t i = begin; i != end; ++i) {
+                max_unsigned = std::max(max_unsigned, U(sample[i]));
+                min = std::min(min, sample[i]);
+                max = std::max(max, sample[i]);
+                if (i != begin) {
+                    const T difference = T(U(U(sample[i]) - U(sample[i - 1])));
+                    min_difference = std::min(min_difference, difference);
+                    max_difference = std::max(max_difference, difference);
+                }
+            }
+            bitpacked += packed_block_size(max_unsigned, end - begin);
+            frame += packed_block_size(U(U(max) - U(min)), end - begin);
+            delta += packed_block_size(U(U(max_difference) - U(min_difference)), end - begin) + sizeof(T);
+        }
+        estimates.push_back({ EN_BitPacked, std::size_t(bitpacked * scale), num_rows * PACKED_NS });
+        estimates.push_back({ EN_FOR, std::size_t(frame * scale), num_rows * PACKED_NS });
+        estimates.push_back({ EN_Delta, std::size_t(delta * scale), num_rows * DELTA_NS });
+    }
+    if constexpr (is_char<T>::value)
+        estimates.push_back(estimate_fsst(sample, num_rows));
+    return estimates;
+}
+
+/** Appends the elements of the uncompressed column other to column and returns column. */
+template<typename C>
+C * append_all(C *column, const GenericColumn &other)
+{
+    column->append(other, other.size());
+    return column;
+}
+
+/** Returns a new column holding the elements of the uncompressed column, which holds values of type T, encoded with
+ * encoding, or nullptr if the encoding is not applicable to T. */
+template<typename T>
+ColumnBase * encode(const GenericColumn &column, Encoding encoding)
+{
+    switch (encoding) {
+        case EN_Plain: return append_all(new GenericColumn(sizeof(T)), column);
+        case EN_RLE: return append_all(new Column<RLE<T>>(), column);
+        case EN_Dictionary: {
+            auto encoded = new Column<Dictionary<T>>();
+            encoded->build(column, column.size(), false);
+            return encoded;
+        }
+        case EN_RLE_Dictionary: {
+            auto encoded = new Column<RLE<Dictionary<T>>>();
+            encoded->build(column, column.size(), false);
+            return encoded;
+        }
+        case EN_BitPacked:
+        case EN_FOR:
+        case EN_Delta:
+            if constexpr (std::is_integral<T>::value) {
+                if (encoding == EN_BitPacked) return append_all(new Column<BitPacked<T>>(), column);
+                if (encoding == EN_FOR) return append_all(new Column<FOR<T>>(), column);
+                return append_all(new Column<Delta<T>>(), column);
+            }
+            return nullptr;
+        case EN_FSST:
+            if constexpr (is_char<T>::value)
+                return append_all(new Column<FSST<T>>(), column);
+            return nullptr;
+    }
+    dbms_unreachable("unknown encoding");
+}
+
+}
+
+ColumnAnalysis dbms::analyze_column(const Attribute &attr, const ColumnBase &column, const CompressionPolicy &policy)
+{
+    ColumnAnalysis analysis;
+    analysis.attr = attr;
+    analysis.num_rows = column.size();
+    const bool dispatched = dispatch_type(attr, [&](auto *type) {
+        using T = std::remove_pointer_t<decltype(type)>;
+        analysis.estimates = estimate_encodings(sample_column<T>(column, policy.sample_size), analysis.num_rows);
+    });
+    if (not dispatched)
+        analysis.estimates = { { EN_Plain, analysis.num_rows * attr.size, analysis.num_rows * PLAIN_NS } };
+
+    auto cost = [&](const EncodingEstimate &estimate) {
+        return estimate.size + policy.bytes_per_ns * estimate.decode_time;
+    };
+    analysis.encoding = std::min_element(analysis.estimates.begin(), analysis.estimates.end(),
+                                         [&](const auto &first, const auto &second) {
+                                             return cost(first) < cost(second);
+                                         })->encoding;
+    return analysis;
+}
+
+std::vector<ColumnAnalysis> dbms::analyze_columnstore(const Relation &relation, const ColumnStore &store,
+                                                      const CompressionPolicy &policy)
+{
+    std::vector<ColumnAnalysis> analyses;
+    for (std::size_t i = 0; i != relation.size(); ++i)
+        analyses.push_back(analyze_column(relation[i], store.get_column(i), policy));
+    return analyses;
+}
+
+ColumnBase * dbms::encode_column(const Attribute &attr, const GenericColumn &column, Encoding encoding)
+{
+    assert(not column.is_compressed(), "the column must be uncompressed");
+    if (encoding == EN_Plain and attr.type == Attribute::TY_Varchar) {
+        /* Varchar elements own their strings, hence they are copied elementwise. */
+        auto plain = new Column<Varchar>();
+        const Varchar *values = static_cast<const Varchar*>(column.data());
+        for (std::size_t i = 0; i != column.size(); ++i)
+            plain->push_back(values[i]);
+        return plain;
+    }
+    if (encoding == EN_Plain)
+        return append_all(new GenericColumn(attr.size), column);
+
+    ColumnBase *encoded = nullptr;
+    dispatch_type(attr, [&](auto *type) {
+        using T = std::remove_pointer_t<decltype(type)>;
+        encoded = encode<T>(column, encoding);
+    });
+    assert(encoded, "the encoding is not applicable to the attribute");
+    return encoded;
+}
+
+ColumnStore * dbms::compress_columnstore(const ColumnStore &store, const std::vector<ColumnAnalysis> &analyses)
+{
+    std::vector<ColumnBase*> columns;
+    for (std::size_t i = 0; i != analyses.size(); ++i) {
+        const auto &column = dynamic_cast<const GenericColumn&>(store.get_column(i));
+        columns.push_back(encode_column(analyses[i].attr, column, analyses[i].encoding));
+    }
+    return new ColumnStore(ColumnStore::Create_Explicit(std::move(columns)));
+}
+
+ColumnStore * dbms::compress(const Relation &relation, const ColumnStore &store, const CompressionPolicy &policy,
+                             ThreadPool &pool, std::vector<ColumnAnalysis> *analyses)
+{
+    assert(relation.size() == store.num_columns(), "the relation does not match the store");
+    std::vector<ColumnAnalysis> column_analyses(relation.size());
+    std::vector<ColumnBase*> columns(relation.size());
+    /* Encoding a column is sequential, hence every column is a morsel of its own. */
+    pool.parallel_for(relation.size(), [&](std::size_t, std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i != end; ++i) {
+            const auto &column = dynamic_cast<const GenericColumn&>(store.get_column(i));
+            column_analyses[i] = analyze_column(relation[i], column, policy);
+            columns[i] = encode_column(relation[i], column, column_analyses[i].encoding);
+        }
+    }, 1);
+    if (analyses)
+        *analyses = std::move(column_analyses);
+    return new ColumnStore(ColumnStore::Create_Explicit(std::move(columns)));
 }
@@ -1,14 +1,30 @@
 #include "dbms/assert.hpp"
 #include "dbms/Compression.hpp"
+#include "dbms/Kernels.hpp"
+#include "dbms/Snapshot.hpp"
+#include <algorithm>
 #include <cstdint>
-#include <map>
+#include <functional>
+#include <limits>
+#include <type_traits>
 
 
 namespace dbms {
 
+/** Orders values of dictionaries.  Char(N) values are ordered lexicographically. */
+struct DictionaryLess
+{
+    template<typename T>
+    bool operator()(const T &first, const T &second) const { return first < second; }
+    template<std::size_t N>
+    bool operator()(const Char<N> &first, const Char<N> &second) const { return strcmp(first.data, second.data) < 0; }
+};
+
 /**
  * This class implements a generic dictionary.
- * It keeps an internal bi-directional mapping from input value to dictionary index.
+ * The values are kept densely in index order, and an open addressing hash table maps values to their index, such that
+ * encoding a value takes constant time.  A dictionary is sorted, if its indices compare like its values.  Then range
+ * predicates on values translate to ranges of indices.
  */
 template<typename T, typename S>
 struct Dictionary
@@ -16,31 +32,97 @@ struct Dictionary
     using value_type = T;
     using index_type = S;
 
+    /** Returns a sorted dictionary of the distinct values among the n values. */
+    static Dictionary Create_Sorted(const T *values, std::size_t n) {
+        Dictionary distinct;
+        for (std::size_t i = 0; i != n; ++i)
+            distinct(values[i]);
+        std::sort(distinct.values_.begin(), distinct.values_.end(), DictionaryLess{});
+        Dictionary dict;
+        for (const T &value : distinct.values_)
+            dict(value);
+        return dict;
+    }
+
     /** Returns the size of the dictionary, i.e. the number of distinct values. */
-    std::size_t size() const { return dictionary_table.size(); }
+    std::size_t size() const { return values_.size(); }
+    /** Returns true iff the indices of the dictionary compare like its values. */
+    bool is_sorted() const { return sorted_; }
+    /** Returns a pointer to the values of the dictionary in index order. */
+    const T * data() const { return values_.data(); }
+
+    /** Returns the index of the given value in the dictionary.  Values that are not in the dictionary are inserted.
+     * Inserting a value that does not order after all values unsorts the dictionary. */
+    index_type operator()(const T &value) {
+        if (2 * (values_.size() + 1) > slots_.size())
+            grow();
+        const std::size_t mask = slots_.size() - 1;
+        std::size_t slot = hash(value) & mask;
+        for (; slots_[slot] != EMPTY_SLOT; slot = (slot + 1) & mask) {
+            if (values_[slots_[slot]] == value)
+                return slots_[slot];
+        }
+        assert(values_.size() < EMPTY_SLOT, "index type of the dictionary exhausted");
+        sorted_ = sorted_ and (values_.empty() or DictionaryLess{}(values_.back(), value));
+        slots_[slot] = values_.size();
+        values_.push_back(value);
+        return values_.size() - 1;
+    }
 
-    /** Returns the index of the given value in the dictionary. */
-    index_type operator()(T value) {
-        for (auto it : dictionary_table) { 
-            if(it.second == value)
-				return it.first;
+    /** Returns the index of the given value in the dictionary, or size() if the value is not in the dictionary. */
+    std::size_t find(const T &value) const {
+        if (slots_.empty()) return size();
+        const std::size_t mask = slots_.size() - 1;
+        for (std::size_t slot = hash(value) & mask; slots_[slot] != EMPTY_SLOT; slot = (slot + 1) & mask) {
+            if (values_[slots_[slot]] == value)
+                return slots_[slot];
         }
-        dictionary_table[dictionary_table.size()] = value;
-        return dictionary_table.size() - 1;
+        return size();
+    }
+
+    /** Returns the first index whose value does not order before value.  The dictionary must be sorted. */
+    std::size_t lower_bound(const T &value) const {
+        assert(sorted_, "dictionary is not sorted");
+        return std::lower_bound(values_.begin(), values_.end(), value, DictionaryLess{}) - values_.begin();
+    }
+    /** Returns the first index whose value orders after value.  The dictionary must be sorted. */
+    std::size_t upper_bound(const T &value) const {
+        assert(sorted_, "dictionary is not sorted");
+        return std::upper_bound(values_.begin(), values_.end(), value, DictionaryLess{}) - values_.begin();
     }
 
     /** Returns the value at the given index in the dictionary. */
     const T & operator[](index_type idx) const {
-        return dictionary_table.at(idx);
+        assert(idx < values_.size(), "index out of bounds");
+        return values_[idx];
     }
 
-    friend std::ostream & operator<<(std::ostream &out, const Dictionary<T> &dict) {
-        dbms_unreachable("Not implemented.");
+    friend std::ostream & operator<<(std::ostream &out, const Dictionary &dict) {
+        return out << "Dictionary<" << typeid(T).name() << "> (" << dict.size() << " entries"
+                   << (dict.sorted_ ? ", sorted)" : ")");
     }
     DECLARE_DUMP
 
     private:
-    std::map<index_type, value_type> dictionary_table;
+    static constexpr index_type EMPTY_SLOT = std::numeric_limits<index_type>::max();
+
+    static std::size_t hash(const T &value) { return Murmur3{}(uint64_t(std::hash<T>{}(value))); }
+
+    /** Doubles the number of slots of the hash table. */
+    void grow() {
+        slots_.assign(std::max<std::size_t>(16, 2 * slots_.size()), EMPTY_SLOT);
+        const std::size_t mask = slots_.size() - 1;
+        for (std::size_t idx = 0; idx != values_.size(); ++idx) {
+            std::size_t slot = hash(values_[idx]) & mask;
+            while (slots_[slot] != EMPTY_SLOT)
+                slot = (slot + 1) & mask;
+            slots_[slot] = idx;
+        }
+    }
+
+    std::vector<T> values_; ///< the values in index order
+    std::vector<index_type> slots_; ///< open addressing hash table of indices into values_
+    bool sorted_ = true;
 };
 
 template<typename T>
@@ -53,6 +135,8 @@ void Column<RLE<T>>::push_back(T value)
         it->count++;
     else {
         new (run_iterator(*this, size_).operator->()) RLE<T>(value);
+        if (size_ % RUNS_PER_INDEX_ENTRY == 0)
+            index_.push_back(num_rows_);
         size_++;
     }
     num_rows_++;
@@ -61,7 +145,10 @@ void Column<RLE<T>>::push_back(T value)
 template<typename T, typename S>
 void Column<Dictionary<T, S>>::push_back(T value)
 {
-    Base::push_back(dict_(value));
+    const S idx = dict_(value);
+    if (Base::size() == 0 or static_cast<const S*>(Base::data())[Base::size() - 1] != idx)
+        ++num_runs_;
+    Base::push_back(idx);
 }
 
 template<typename T, typename S>
@@ -70,4 +157,704 @@ void Column<RLE<Dictionary<T, S>>>::push_back(T value)
     Base::push_back(dict_(value));
 }
 
+/** Pushes the first n elements of the uncompressed column other, which hold values of type T, to the back of
+ * column. */
+template<typename T, typename C>
+void push_back_all(C &column, const GenericColumn &other, std::size_t n)
+{
+    assert(other.elem_size() == sizeof(T), "element sizes differ");
+    assert(n <= other.size(), "not enough elements");
+    const T *values = static_cast<const T*>(other.data());
+    for (std::size_t i = 0; i != n; ++i)
+        column.push_back(values[i]);
+}
+
+template<typename T>
+void Column<RLE<T>>::append(const GenericColumn &other, std::size_t n)
+{
+    push_back_all<T>(*this, other, n);
+}
+
+template<typename T, typename S>
+void Column<Dictionary<T, S>>::append(const GenericColumn &other, std::size_t n)
+{
+    push_back_all<T>(*this, other, n);
+}
+
+template<typename T, typename S>
+void Column<RLE<Dictionary<T, S>>>::append(const GenericColumn &other, std::size_t n)
+{
+    push_back_all<T>(*this, other, n);
+}
+
+/** Encodes the first n elements of the uncompressed column other, which hold values of type T, to the empty column.
+ * Sorting the dictionary requires to know all distinct values before encoding. */
+template<typename T, typename C, typename D>
+void build_dictionary_column(C &column, D &dict, const GenericColumn &other, std::size_t n, bool sorted)
+{
+    assert(column.size() == 0, "column is not empty");
+    assert(other.elem_size() == sizeof(T), "element sizes differ");
+    assert(n <= other.size(), "not enough elements");
+    if (sorted)
+        dict = D::Create_Sorted(static_cast<const T*>(other.data()), n);
+    else
+        dict = D();
+    push_back_all<T>(column, other, n);
+}
+
+template<typename T, typename S>
+void Column<Dictionary<T, S>>::build(const GenericColumn &other, std::size_t n, bool sorted)
+{
+    Base::reserve(n);
+    build_dictionary_column<T>(*this, dict_, other, n, sorted);
+}
+
+template<typename T, typename S>
+void Column<RLE<Dictionary<T, S>>>::build(const GenericColumn &other, std::size_t n, bool sorted)
+{
+    build_dictionary_column<T>(*this, dict_, other, n, sorted);
+}
+
+template<typename T>
+typename Column<RLE<T>>::const_iterator Column<RLE<T>>::seek(std::size_t idx) const
+{
+    assert(idx <= num_rows_, "index out of bounds");
+    RLE<T> *run = static_cast<RLE<T>*>(data_);
+    if (idx == num_rows_) return const_iterator(run + size_, 0);
+    /* Find the last index entry at or before idx, and scan the runs from there. */
+    const std::size_t entry = std::upper_bound(index_.begin(), index_.end(), idx) - index_.begin() - 1;
+    run += entry * RUNS_PER_INDEX_ENTRY;
+    idx -= index_[entry];
+    while (idx >= run->count)
+        idx -= run++->count;
+    return const_iterator(run, idx);
+}
+
+template<typename T>
+void Column<RLE<T>>::build_index()
+{
+    const RLE<T> *runs = static_cast<const RLE<T>*>(data_);
+    index_.clear();
+    std::size_t idx = 0;
+    for (std::size_t run = 0; run != size_; ++run) {
+        if (run % RUNS_PER_INDEX_ENTRY == 0)
+            index_.push_back(idx);
+        idx += runs[run].count;
+    }
+}
+
+template<typename T>
+template<typename U, typename F>
+std::size_t Column<RLE<T>>::decode(const_iterator &it, std::size_t n, U *buffer, F &&f) const
+{
+    /* Work on copies of the iterator's state, as writes to buffer might alias it. */
+    const RLE<T> *run = it.run_;
+    const RLE<T> *end = static_cast<const RLE<T>*>(data_) + size_;
+    std::size_t idx = it.idx_;
+    std::size_t i = 0;
+    while (run != end) {
+        const std::size_t count = run->count - idx;
+        if (count > n - i) {
+            /* The batch ends within the run. */
+            std::fill_n(buffer + i, n - i, f(run->value));
+            idx += n - i;
+            i = n;
+            break;
+        }
+        std::fill_n(buffer + i, count, f(run->value));
+        i += count;
+        idx = 0;
+        ++run;
+    }
+    it = const_iterator(const_cast<RLE<T>*>(run), idx);
+    return i;
+}
+
+template<typename T>
+template<typename U, typename F>
+U * Column<RLE<T>>::read(ColumnCursor &cursor, std::size_t n, U *buffer, F &&f) const
+{
+    const_iterator it(static_cast<RLE<T>*>(data_) + cursor.run, cursor.run_idx);
+    cursor.idx += decode(it, n, buffer, f);
+    cursor.run = it.run_ - static_cast<RLE<T>*>(data_);
+    cursor.run_idx = it.idx_;
+    return buffer;
+}
+
+template<typename T>
+template<typename U, typename F>
+std::size_t Column<RLE<T>>::read_runs(ColumnCursor &cursor, std::size_t n, std::size_t max_runs, U *values,
+                                      uint32_t *ends, F &&f) const
+{
+    const RLE<T> *runs = static_cast<const RLE<T>*>(data_);
+    n = std::min(n, num_rows_ - cursor.idx);
+    std::size_t run = cursor.run;
+    std::size_t idx = cursor.run_idx;
+    std::size_t i = 0;
+    std::size_t num_runs = 0;
+    while (i != n and num_runs != max_runs) {
+        const std::size_t count = std::min<std::size_t>(runs[run].count - idx, n - i);
+        values[num_runs] = f(runs[run].value);
+        i += count;
+        ends[num_runs++] = i;
+        idx += count;
+        if (idx == runs[run].count) {
+            idx = 0;
+            ++run;
+        }
+    }
+    cursor.idx += i;
+    cursor.run = run;
+    cursor.run_idx = idx;
+    return num_runs;
+}
+
+template<typename T>
+void Column<RLE<T>>::skip(ColumnCursor &cursor, std::size_t n) const
+{
+    const RLE<T> *runs = static_cast<const RLE<T>*>(data_);
+    n = std::min(n, num_rows_ - cursor.idx);
+    cursor.idx += n;
+    n += cursor.run_idx;
+    while (n != 0 and n >= runs[cursor.run].count)
+        n -= runs[cursor.run++].count;
+    cursor.run_idx = n;
+}
+
+template<typename T>
+ColumnCursor Column<RLE<T>>::cursor(std::size_t idx) const
+{
+    const_iterator it = seek(idx);
+    ColumnCursor cursor;
+    cursor.idx = idx;
+    cursor.run = it.run_ - static_cast<RLE<T>*>(data_);
+    cursor.run_idx = it.idx_;
+    return cursor;
+}
+
+template<typename T, typename S>
+std::size_t Column<Dictionary<T, S>>::fetch(std::size_t start, std::size_t n, T *buffer) const
+{
+    auto indices = Base::fetch(start, n);
+    for (std::size_t i = 0; i != indices.size(); ++i)
+        buffer[i] = dict_[indices[i]];
+    return indices.size();
+}
+
+template<typename T, typename S>
+std::size_t Column<Dictionary<T, S>>::read_runs(ColumnCursor &cursor, std::size_t n, std::size_t max_runs,
+                                                void *values, uint32_t *ends) const
+{
+    const S *indices = static_cast<const S*>(Base::data()) + cursor.idx;
+    n = std::min(n, Base::size() - cursor.idx);
+    std::size_t i = 0;
+    std::size_t num_runs = 0;
+    while (i != n and num_runs != max_runs) {
+        const S idx = indices[i];
+        while (++i != n and indices[i] == idx);
+        static_cast<T*>(values)[num_runs] = dict_[idx];
+        ends[num_runs++] = i;
+    }
+    cursor.idx += i;
+    return num_runs;
+}
+
+template<typename T, typename S>
+std::size_t Column<Dictionary<T, S>>::read_index_runs(ColumnCursor &cursor, std::size_t n, std::size_t max_runs,
+                                                      uint32_t *indices, uint32_t *ends) const
+{
+    const S *idx = static_cast<const S*>(Base::data()) + cursor.idx;
+    n = std::min(n, Base::size() - cursor.idx);
+    std::size_t i = 0;
+    std::size_t num_runs = 0;
+    while (i != n and num_runs != max_runs) {
+        indices[num_runs] = idx[i];
+        while (++i != n and idx[i] == indices[num_runs]);
+        ends[num_runs++] = i;
+    }
+    cursor.idx += i;
+    return num_runs;
+}
+
+template<typename T>
+void Column<BitPacked<T>>::push_back(T value)
+{
+    tail_.push_back(value);
+    ++num_rows_;
+    if (tail_.size() == BLOCK_SIZE)
+        pack_tail();
+}
+
+template<typename T>
+void Column<BitPacked<T>>::append(const GenericColumn &other, std::size_t n)
+{
+    push_back_all<T>(*this, other, n);
+}
+
+template<typename T>
+void Column<BitPacked<T>>::pack_tail()
+{
+    /* Elements are packed as unsigned integers of the width of T, such that the differences of signed elements to the
+     * reference wrap around exactly. */
+    using U = std::make_unsigned_t<T>;
+    U min = tail_.empty() ? U(0) : U(*std::min_element(tail_.begin(), tail_.end()));
+    U max = tail_.empty() ? U(0) : U(*std::max_element(tail_.begin(), tail_.end()));
+    const U reference = use_reference_ ? min : U(0);
+    if (not use_reference_ and std::is_signed<T>::value) {
+        /* Negative elements are large unsigned integers. */
+        max = 0;
+        for (const T &value : tail_)
+            max = std::max(max, U(value));
+    }
+    const uint64_t max_difference = U(max - reference);
+    const unsigned bits = max_difference == 0 ? 0 : 64 - __builtin_clzll(max_difference);
+
+    /* Pad the block with a word, such that the 8 bytes following every packed element are readable. */
+    const std::size_t num_words = bits == 0 ? 0 : (tail_.size() * bits + 63) / 64 + 1;
+    blocks_.push_back(Block{ reference, size_, bits });
+    uint64_t *words = static_cast<uint64_t*>(GenericColumn::append(num_words));
+    std::fill_n(words, num_words, 0);
+    for (std::size_t i = 0; bits != 0 and i != tail_.size(); ++i) {
+        const uint64_t difference = U(U(tail_[i]) - reference);
+        const std::size_t bit = i * bits;
+        const std::size_t shift = bit % 64;
+        words[bit / 64] |= difference << shift;
+        if (shift + bits > 64)
+            words[bit / 64 + 1] |= difference >> (64 - shift);
+    }
+    tail_.clear();
+}
+
+template<typename T>
+void Column<BitPacked<T>>::unpack(const Block &block, std::size_t first, std::size_t n, T *buffer) const
+{
+    const uint64_t *words = static_cast<const uint64_t*>(data_) + block.offset;
+    if constexpr (sizeof(T) == sizeof(uint64_t)) {
+        unpack_bits(words, block.bits, first, n, block.reference, reinterpret_cast<uint64_t*>(buffer));
+    } else {
+        /* Unpack to 64 bit integers in chunks, and narrow them to T. */
+        constexpr std::size_t CHUNK_SIZE = 256;
+        uint64_t values[CHUNK_SIZE];
+        for (std::size_t i = 0; i < n; i += CHUNK_SIZE) {
+            const std::size_t m = std::min(CHUNK_SIZE, n - i);
+            unpack_bits(words, block.bits, first + i, m, block.reference, values);
+            for (std::size_t j = 0; j != m; ++j)
+                buffer[i + j] = T(std::make_unsigned_t<T>(values[j]));
+        }
+    }
+}
+
+template<typename T>
+T Column<BitPacked<T>>::at(std::size_t idx) const
+{
+    assert(idx < num_rows_, "index out of bounds");
+    const std::size_t num_packed = blocks_.size() * BLOCK_SIZE;
+    if (idx >= num_packed) return tail_[idx - num_packed];
+
+    /* Extract the single element from the words of its block, rather than unpacking a vector of elements. */
+    const Block &block = blocks_[idx / BLOCK_SIZE];
+    uint64_t value = 0;
+    if (block.bits != 0) {
+        const uint64_t *words = static_cast<const uint64_t*>(data_) + block.offset;
+        const std::size_t bit = idx % BLOCK_SIZE * block.bits;
+        const std::size_t shift = bit % 64;
+        value = words[bit / 64] >> shift;
+        if (shift + block.bits > 64)
+            value |= words[bit / 64 + 1] << (64 - shift);
+        if (block.bits != 64)
+            value &= (uint64_t(1) << block.bits) - 1;
+    }
+    return T(std::make_unsigned_t<T>(block.reference + value));
+}
+
+template<typename T>
+std::size_t Column<BitPacked<T>>::fetch(std::size_t start, std::size_t n, T *buffer) const
+{
+    assert(start <= num_rows_, "index out of bounds");
+    n = std::min(n, num_rows_ - start);
+    const std::size_t num_packed = blocks_.size() * BLOCK_SIZE;
+    std::size_t i = 0;
+    while (i != n and start + i < num_packed) {
+        const std::size_t first = (start + i) % BLOCK_SIZE;
+        const std::size_t m = std::min(n - i, BLOCK_SIZE - first);
+        unpack(blocks_[(start + i) / BLOCK_SIZE], first, m, buffer + i);
+        i += m;
+    }
+    if (i != n)
+        std::copy_n(tail_.data() + (start + i - num_packed), n - i, buffer + i);
+    return n;
+}
+
+template<typename T>
+void Column<BitPacked<T>>::write_snapshot(SnapshotWriter &out) const
+{
+    GenericColumn::write_snapshot(out);
+    out.put<uint64_t>(num_rows_);
+    out.put<uint64_t>(blocks_.size());
+    out.put_data(blocks_.data(), blocks_.size() * sizeof(Block));
+    out.put<uint64_t>(tail_.size());
+    out.put_data(tail_.data(), tail_.size() * sizeof(T));
+}
+
+template<typename T>
+void Column<BitPacked<T>>::read_snapshot(SnapshotReader &in)
+{
+    GenericColumn::read_snapshot(in);
+    num_rows_ = in.get<uint64_t>();
+    std::size_t num_bytes;
+    const uint64_t num_blocks = in.get<uint64_t>();
+    const Block *blocks = static_cast<const Block*>(in.get_data(num_bytes));
+    if (num_bytes != num_blocks * sizeof(Block))
+        in.layout_mismatch();
+    blocks_.assign(blocks, blocks + num_blocks);
+    const uint64_t tail_size = in.get<uint64_t>();
+    const T *tail = static_cast<const T*>(in.get_data(num_bytes));
+    if (num_bytes != tail_size * sizeof(T) or num_blocks * BLOCK_SIZE + tail_size != num_rows_)
+        in.layout_mismatch();
+    tail_.assign(tail, tail + tail_size);
+}
+
+template<typename T>
+void Column<Delta<T>>::push_back(T value)
+{
+    using U = std::make_unsigned_t<T>;
+    if (Base::size() % BLOCK_SIZE == 0)
+        bases_.push_back(value);
+    Base::push_back(Base::size() == 0 ? difference_type(0) : difference_type(U(U(value) - U(last_))));
+    last_ = value;
+}
+
+template<typename T>
+void Column<Delta<T>>::append(const GenericColumn &other, std::size_t n)
+{
+    push_back_all<T>(*this, other, n);
+}
+
+template<typename T>
+T Column<Delta<T>>::at(std::size_t idx) const
+{
+    using U = std::make_unsigned_t<T>;
+    assert(idx < Base::size(), "index out of bounds");
+    const std::size_t first = idx / BLOCK_SIZE * BLOCK_SIZE;
+    difference_type differences[BLOCK_SIZE];
+    const std::size_t n = Base::fetch(first, idx - first + 1, differences);
+    U value = bases_[first / BLOCK_SIZE];
+    for (std::size_t i = 1; i != n; ++i)
+        value += U(differences[i]);
+    return T(value);
+}
+
+template<typename T>
+ColumnCursor Column<Delta<T>>::cursor(std::size_t idx) const
+{
+    ColumnCursor cursor;
+    cursor.idx = idx;
+    if (idx % BLOCK_SIZE != 0)
+        cursor.previous = std::make_unsigned_t<T>(at(idx - 1));
+    return cursor;
+}
+
+template<typename T>
+const void * Column<Delta<T>>::read(ColumnCursor &cursor, std::size_t n, void *buffer) const
+{
+    using U = std::make_unsigned_t<T>;
+    U *values = static_cast<U*>(buffer);
+    n = Base::fetch(cursor.idx, n, reinterpret_cast<difference_type*>(values));
+    /* Sum the differences block wise, starting from the base of the block or from the preceding element. */
+    U previous = cursor.previous;
+    for (std::size_t i = 0; i != n;) {
+        const std::size_t idx = cursor.idx + i;
+        const std::size_t m = std::min(n - i, BLOCK_SIZE - idx % BLOCK_SIZE);
+        if (idx % BLOCK_SIZE == 0) {
+            previous = bases_[idx / BLOCK_SIZE];
+            values[i] = 0;
+        }
+        if constexpr (sizeof(U) == sizeof(uint32_t) or sizeof(U) == sizeof(uint64_t)) {
+            prefix_sum(values + i, m, previous);
+        } else {
+            for (std::size_t j = i; j != i + m; ++j)
+                values[j] = previous += values[j];
+        }
+        previous = values[i + m - 1];
+        i += m;
+    }
+    cursor.idx += n;
+    cursor.previous = previous;
+    return buffer;
+}
+
+template<typename T>
+void Column<Delta<T>>::write_snapshot(SnapshotWriter &out) const
+{
+    Base::write_snapshot(out);
+    out.put<uint64_t>(bases_.size());
+    out.put_data(bases_.data(), bases_.size() * sizeof(T));
+}
+
+template<typename T>
+void Column<Delta<T>>::read_snapshot(SnapshotReader &in)
+{
+    Base::read_snapshot(in);
+    const uint64_t num_bases = in.get<uint64_t>();
+    std::size_t num_bytes;
+    const T *bases = static_cast<const T*>(in.get_data(num_bytes));
+    if (num_bytes != num_bases * sizeof(T) or num_bases != (Base::size() + BLOCK_SIZE - 1) / BLOCK_SIZE)
+        in.layout_mismatch();
+    bases_.assign(bases, bases + num_bases);
+    last_ = Base::size() ? at(Base::size() - 1) : T();
+}
+
+template<std::size_t N>
+void Column<FSST<Char<N>>>::push_back(const value_type &value)
+{
+    ++num_rows_;
+    if (is_trained_) {
+        encode(value);
+        return;
+    }
+    plain_.push_back(value);
+    if (plain_.size() == TRAINING_SIZE) {
+        std::vector<const char*> strings;
+        for (const value_type &plain : plain_)
+            strings.push_back(plain.data);
+        train(strings.data(), strings.size());
+    }
+}
+
+template<std::size_t N>
+void Column<FSST<Char<N>>>::append(const GenericColumn &other, std::size_t n)
+{
+    assert(other.elem_size() == sizeof(value_type), "element sizes differ");
+    assert(n <= other.size(), "not enough elements");
+    const value_type *values = static_cast<const value_type*>(other.data());
+    if (not is_trained_ and n != 0) {
+        /* Train the table on the plain elements and on elements spread evenly over the appended ones. */
+        std::vector<const char*> strings;
+        for (const value_type &plain : plain_)
+            strings.push_back(plain.data);
+        const std::size_t stride = std::max<std::size_t>(n / TRAINING_SIZE, 1);
+        for (std::size_t i = 0; i < n and strings.size() < TRAINING_SIZE; i += stride)
+            strings.push_back(values[i].data);
+        train(strings.data(), strings.size());
+    }
+    for (std::size_t i = 0; i != n; ++i)
+        push_back(values[i]);
+}
+
+template<std::size_t N>
+void Column<FSST<Char<N>>>::train(const char * const *strings, std::size_t n)
+{
+    table_ = SymbolTable::Train(strings, n);
+    is_trained_ = true;
+    const std::vector<value_type> plain = std::move(plain_);
+    plain_ = std::vector<value_type>();
+    for (const value_type &value : plain)
+        encode(value);
+}
+
+template<std::size_t N>
+void Column<FSST<Char<N>>>::encode(const value_type &value)
+{
+    const std::size_t idx = ends_.size();
+    if (idx % BLOCK_SIZE == 0)
+        offsets_.push_back(GenericColumn::size());
+    uint8_t codes[2 * N];
+    const std::size_t len = table_.encode(value.data, strnlen(value.data, N), codes);
+    memcpy(GenericColumn::append(len), codes, len);
+    ends_.push_back(uint16_t((idx % BLOCK_SIZE == 0 ? 0 : ends_.back()) + len));
+}
+
+template<std::size_t N>
+std::size_t Column<FSST<Char<N>>>::fetch(std::size_t start, std::size_t n, value_type *buffer) const
+{
+    assert(start <= num_rows_, "index out of bounds");
+    n = std::min(n, num_rows_ - start);
+    if (not is_trained_) {
+        std::copy_n(plain_.data() + start, n, buffer);
+        return n;
+    }
+    /* Decoding writes up to 7 bytes past the string.  Elements are decoded in place, if the next element has room for
+     * these bytes, and are otherwise decoded to a padded buffer. */
+    char decoded[N + sizeof(uint64_t)];
+    const uint8_t *data = static_cast<const uint8_t*>(data_);
+    for (std::size_t i = 0; i != n; ++i) {
+        const std::size_t idx = start + i;
+        const std::size_t begin = idx % BLOCK_SIZE == 0 ? 0 : ends_[idx - 1];
+        const uint8_t *element_codes = data + offsets_[idx / BLOCK_SIZE] + begin;
+        char *out = buffer[i].data;
+        if (N >= sizeof(uint64_t) and i + 1 != n) {
+            const std::size_t length = table_.decode(element_codes, ends_[idx] - begin, out);
+            memset(out + length, 0, N - length);
+        } else {
+            const std::size_t length = table_.decode(element_codes, ends_[idx] - begin, decoded);
+            memcpy(out, decoded, length);
+            memset(out + length, 0, N - length);
+        }
+    }
+    return n;
+}
+
+template<std::size_t N>
+std::size_t Column<FSST<Char<N>>>::match(ColumnCursor &cursor, std::size_t n, const char *str, bool is_prefix,
+                                         uint8_t *mask) const
+{
+    n = std::min(n, num_rows_ - cursor.idx);
+    const std::size_t start = cursor.idx;
+    cursor.idx += n;
+    const std::size_t length = strlen(str);
+    if (not is_trained_) {
+        for (std::size_t i = 0; i != n; ++i) {
+            const char *value = plain_[start + i].data;
+            mask[i] = is_prefix ? strncmp(value, str, length) == 0 : strcmp(value, str) == 0;
+        }
+        return n;
+    }
+
+    std::size_t len;
+    if (is_prefix) {
+        for (std::size_t i = 0; i != n; ++i) {
+            const uint8_t *element_codes = codes(start + i, len);
+            mask[i] = table_.starts_with(element_codes, len, str, length);
+        }
+        return n;
+    }
+    if (length >= N) {
+        /* No element is that long. */
+        std::fill_n(mask, n, 0);
+        return n;
+    }
+    /* Equal strings have equal codes. */
+    uint8_t str_codes[2 * N];
+    const std::size_t str_len = table_.encode(str, length, str_codes);
+    for (std::size_t i = 0; i != n; ++i) {
+        const uint8_t *element_codes = codes(start + i, len);
+        mask[i] = len == str_len and memcmp(element_codes, str_codes, len) == 0;
+    }
+    return n;
+}
+
+template<std::size_t N>
+void Column<FSST<Char<N>>>::write_snapshot(SnapshotWriter &out) const
+{
+    GenericColumn::write_snapshot(out);
+    out.put<uint64_t>(num_rows_);
+    out.put<uint64_t>(is_trained_);
+    out.put<uint64_t>(table_.size());
+    out.put_data(table_.symbols(), table_.size() * sizeof(uint64_t));
+    out.put_data(table_.lengths(), table_.size() * sizeof(uint8_t));
+    out.put_data(offsets_.data(), offsets_.size() * sizeof(uint64_t));
+    out.put_data(ends_.data(), ends_.size() * sizeof(uint16_t));
+    out.put_data(plain_.data(), plain_.size() * sizeof(value_type));
+}
+
+template<std::size_t N>
+void Column<FSST<Char<N>>>::read_snapshot(SnapshotReader &in)
+{
+    GenericColumn::read_snapshot(in);
+    num_rows_ = in.get<uint64_t>();
+    is_trained_ = in.get<uint64_t>();
+    const uint64_t num_symbols = in.get<uint64_t>();
+    std::size_t num_bytes, num_length_bytes;
+    const uint64_t *symbols = static_cast<const uint64_t*>(in.get_data(num_bytes));
+    const uint8_t *lengths = static_cast<const uint8_t*>(in.get_data(num_length_bytes));
+    if (num_symbols > SymbolTable::MAX_SYMBOLS or num_bytes != num_symbols * sizeof(uint64_t) or
+        num_length_bytes != num_symbols)
+        in.layout_mismatch();
+    table_ = SymbolTable(symbols, lengths, num_symbols);
+
+    const uint64_t *offsets = static_cast<const uint64_t*>(in.get_data(num_bytes));
+    const std::size_t num_encoded = is_trained_ ? num_rows_ : 0;
+    if (num_bytes != (num_encoded + BLOCK_SIZE - 1) / BLOCK_SIZE * sizeof(uint64_t))
+        in.layout_mismatch();
+    offsets_.assign(offsets, offsets + num_bytes / sizeof(uint64_t));
+    const uint16_t *ends = static_cast<const uint16_t*>(in.get_data(num_bytes));
+    if (num_bytes != num_encoded * sizeof(uint16_t))
+        in.layout_mismatch();
+    ends_.assign(ends, ends + num_encoded);
+    const value_type *plain = static_cast<const value_type*>(in.get_data(num_bytes));
+    if (num_bytes != (num_rows_ - num_encoded) * sizeof(value_type))
+        in.layout_mismatch();
+    plain_.assign(plain, plain + (num_rows_ - num_encoded));
+}
+
+template<typename T>
+void Column<RLE<T>>::write_snapshot(SnapshotWriter &out) const
+{
+    GenericColumn::write_snapshot(out);
+    out.put<uint64_t>(num_rows_);
+}
+
+template<typename T>
+void Column<RLE<T>>::read_snapshot(SnapshotReader &in)
+{
+    GenericColumn::read_snapshot(in);
+    num_rows_ = in.get<uint64_t>();
+    build_index();
+}
+
+/** Writes the values of a dictionary in index order to a snapshot. */
+template<typename T, typename S>
+void write_dictionary(SnapshotWriter &out, const Dictionary<T, S> &dict)
+{
+    if constexpr (std::is_trivially_copyable<T>::value) {
+        out.put<uint64_t>(dict.size());
+        out.put_data(dict.data(), dict.size() * sizeof(T));
+    } else {
+        dbms_unreachable("dictionary type does not support snapshots");
+    }
+}
+
+/** Reads the values of a dictionary from a snapshot and inserts them into dict in index order. */
+template<typename T, typename S>
+void read_dictionary(SnapshotReader &in, Dictionary<T, S> &dict)
+{
+    if constexpr (std::is_trivially_copyable<T>::value) {
+        const uint64_t size = in.get<uint64_t>();
+        std::size_t num_bytes;
+        const T *values = static_cast<const T*>(in.get_data(num_bytes));
+        if (num_bytes != size * sizeof(T))
+            in.layout_mismatch();
+        for (std::size_t i = 0; i != size; ++i)
+            dict(values[i]);
+    } else {
+        dbms_unreachable("dictionary type does not support snapshots");
+    }
+}
+
+template<typename T, typename S>
+void Column<Dictionary<T, S>>::write_snapshot(SnapshotWriter &out) const
+{
+    Base::write_snapshot(out);
+    write_dictionary(out, dict_);
+}
+
+template<typename T, typename S>
+void Column<Dictionary<T, S>>::read_snapshot(SnapshotReader &in)
+{
+    Base::read_snapshot(in);
+    dict_ = dictionary_type();
+    dbms::read_dictionary(in, dict_);
+    const S *indices = static_cast<const S*>(Base::data());
+    num_runs_ = 0;
+    for (std::size_t i = 0; i != Base::size(); ++i) {
+        if (i == 0 or indices[i] != indices[i - 1])
+            ++num_runs_;
+    }
+}
+
+template<typename T, typename S>
+void Column<RLE<Dictionary<T, S>>>::write_snapshot(SnapshotWriter &out) const
+{
+    Base::write_snapshot(out);
+    write_dictionary(out, dict_);
+}
+
+template<typename T, typename S>
+void Column<RLE<Dictionary<T, S>>>::read_snapshot(SnapshotReader &in)
+{
+    Base::read_snapshot(in);
+    dict_ = dictionary_type();
+    dbms::read_dictionary(in, dict_);
+}
+
 }
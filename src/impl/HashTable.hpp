@@ -1,9 +1,11 @@
 #pragma once
 
 #include "dbms/assert.hpp"
+#include "dbms/Memory.hpp"
 #include "dbms/util.hpp"
 #include <cstdint>
 #include <functional>
+#include <new>
 #include <utility>
 
 
@@ -74,13 +76,14 @@ struct HashTable
     const_iterator cbegin() const { return begin(); }
     const_iterator cend()   const { return end(); }
 
-    HashTable(std::size_t capacity = 131072): table_(nullptr), size_(0), capacity_(capacity), min_index(capacity)
+    HashTable(std::size_t capacity = 131072, const MemoryPolicy &policy = MemoryPolicy::Default())
+        : table_(nullptr), size_(0), capacity_(capacity), min_index(capacity), policy_(policy)
     {
-        table_ = new std::pair<bool, key_type>[capacity];
+        table_ = allocate_table(capacity);
     }
 
     ~HashTable() {
-        delete[] table_;
+        deallocate_table(table_, capacity_);
     }
 
     size_type size() const { return size_; }
@@ -138,14 +141,28 @@ struct HashTable
         std::pair<bool, key_type> * old_table = table_;
         capacity_ += 2 * capacity_;
         size_ = 0;
-        table_ = new std::pair<bool, key_type>[capacity_];
+        table_ = allocate_table(capacity_);
 
         for (std::size_t i = 0; i < old_capacity; ++i) {
             if (old_table[i].first == true) 
                 insert_helper(old_table[i].second);
         }
 
-        delete[] old_table;
+        deallocate_table(old_table, old_capacity);
+    }
+
+    /** Allocates a table of capacity empty slots according to the memory policy. */
+    std::pair<bool, key_type> * allocate_table(std::size_t capacity) {
+        auto table = static_cast<std::pair<bool, key_type>*>(allocate(capacity * sizeof(*table_), policy_));
+        for (std::size_t i = 0; i != capacity; ++i)
+            new (&table[i]) std::pair<bool, key_type>();
+        return table;
+    }
+
+    void deallocate_table(std::pair<bool, key_type> *table, std::size_t capacity) {
+        for (std::size_t i = 0; i != capacity; ++i)
+            table[i].~pair();
+        deallocate(table, capacity * sizeof(*table_), policy_);
     }
 
     public:
@@ -166,6 +183,7 @@ struct HashTable
     std::size_t size_;
     std::size_t capacity_;
     std::size_t min_index;
+    MemoryPolicy policy_; ///< the policy to allocate table_ with
 };
 
 template<
@@ -0,0 +1,503 @@
+#include "dbms/Kernels.hpp"
+
+#include "dbms/assert.hpp"
+#include <algorithm>
+#include <cstring>
+#include <immintrin.h>
+
+
+using namespace dbms;
+
+
+namespace {
+
+/** The mask of all 8 lanes of 64 bits of an AVX-512 vector.  The AVX-512 kernels use masked forms of intrinsics with
+ * this mask and a zeroed source: GCC implements the unmasked forms by passing an undefined source vector, which it
+ * then reports as maybe uninitialized. */
+constexpr __mmask8 ALL_LANES = 0xff;
+/** The mask of all 16 lanes of 32 bits of an AVX-512 vector. */
+constexpr __mmask16 ALL_LANES_32 = 0xffff;
+
+}
+
+
+ISA dbms::best_isa()
+{
+    static const ISA isa = []() {
+        if (is_supported(ISA_AVX512)) return ISA_AVX512;
+        if (is_supported(ISA_AVX2)) return ISA_AVX2;
+        return ISA_Scalar;
+    }();
+    return isa;
+}
+
+bool dbms::is_supported(ISA isa)
+{
+    switch (isa) {
+        case ISA_Scalar: return true;
+        case ISA_AVX2: return __builtin_cpu_supports("avx2");
+        case ISA_AVX512:
+            return __builtin_cpu_supports("avx512f") and __builtin_cpu_supports("avx512dq") and
+                   __builtin_cpu_supports("avx512bw");
+    }
+    dbms_unreachable("unknown instruction set");
+}
+
+
+/*======================================================================================================================
+ * Sources of values
+ *
+ * The kernels are templates over the layout of the values they read.  A source provides scalar access to the values of
+ * a row, and loads the values of 4 (AVX2) or 8 (AVX-512) consecutive rows into vectors of 64 bit lanes.
+ *====================================================================================================================*/
+
+namespace {
+
+/** The values of the rows are stored in separate arrays. */
+struct Columns
+{
+    const uint32_t *date;
+    const int64_t *price;
+    const int64_t *discount;
+    const int64_t *tax;
+
+    uint32_t date_at(std::size_t i) const { return date[i]; }
+    int64_t price_at(std::size_t i) const { return price[i]; }
+    int64_t discount_at(std::size_t i) const { return discount[i]; }
+    int64_t tax_at(std::size_t i) const { return tax[i]; }
+
+    __attribute__((target("avx2")))
+    void load(std::size_t i, __m256i &d, __m256i &p, __m256i &disc, __m256i &t) const {
+        d = _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(date + i)));
+        p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(price + i));
+        disc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(discount + i));
+        t = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tax + i));
+    }
+
+    __attribute__((target("avx512f,avx512dq")))
+    void load(std::size_t i, __m512i &d, __m512i &p, __m512i &disc, __m512i &t) const {
+        d = _mm512_maskz_cvtepu32_epi64(ALL_LANES, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(date + i)));
+        p = _mm512_loadu_si512(price + i);
+        disc = _mm512_loadu_si512(discount + i);
+        t = _mm512_loadu_si512(tax + i);
+    }
+};
+
+/** The values of a row are stored together, at fixed offsets within the row.  Vectors are gathered from the rows. */
+struct Rows
+{
+    const uint8_t *rows;
+    std::size_t row_size;
+    std::size_t date;
+    std::size_t price;
+    std::size_t discount;
+    std::size_t tax;
+
+    template<typename T>
+    T get(std::size_t i, std::size_t offset) const {
+        T value;
+        memcpy(&value, rows + i * row_size + offset, sizeof(T));
+        return value;
+    }
+    uint32_t date_at(std::size_t i) const { return get<uint32_t>(i, date); }
+    int64_t price_at(std::size_t i) const { return get<int64_t>(i, price); }
+    int64_t discount_at(std::size_t i) const { return get<int64_t>(i, discount); }
+    int64_t tax_at(std::size_t i) const { return get<int64_t>(i, tax); }
+
+    __attribute__((target("avx2")))
+    void load(std::size_t i, __m256i &d, __m256i &p, __m256i &disc, __m256i &t) const {
+        const long long s = row_size;
+        const __m256i idx = _mm256_set_epi64x(3 * s, 2 * s, s, 0);
+        const uint8_t *row = rows + i * row_size;
+        d = _mm256_cvtepu32_epi64(_mm256_i64gather_epi32(reinterpret_cast<const int*>(row + date), idx, 1));
+        p = _mm256_i64gather_epi64(reinterpret_cast<const long long*>(row + price), idx, 1);
+        disc = _mm256_i64gather_epi64(reinterpret_cast<const long long*>(row + discount), idx, 1);
+        t = _mm256_i64gather_epi64(reinterpret_cast<const long long*>(row + tax), idx, 1);
+    }
+
+    __attribute__((target("avx512f,avx512dq")))
+    void load(std::size_t i, __m512i &d, __m512i &p, __m512i &disc, __m512i &t) const {
+        const long long s = row_size;
+        const __m512i idx = _mm512_set_epi64(7 * s, 6 * s, 5 * s, 4 * s, 3 * s, 2 * s, s, 0);
+        const uint8_t *row = rows + i * row_size;
+        const __m512i zero = _mm512_setzero_si512();
+        const __m256i dates = _mm512_mask_i64gather_epi32(_mm256_setzero_si256(), ALL_LANES, idx, row + date, 1);
+        d = _mm512_maskz_cvtepu32_epi64(ALL_LANES, dates);
+        p = _mm512_mask_i64gather_epi64(zero, ALL_LANES, idx, row + price, 1);
+        disc = _mm512_mask_i64gather_epi64(zero, ALL_LANES, idx, row + discount, 1);
+        t = _mm512_mask_i64gather_epi64(zero, ALL_LANES, idx, row + tax, 1);
+    }
+};
+
+
+/*======================================================================================================================
+ * sum_discounted_price
+ *====================================================================================================================*/
+
+/** Sums the discounted prices of the rows in [begin, end) of source without branching on the dates. */
+template<typename Source>
+int64_t sum_scalar(const Source &source, std::size_t begin, std::size_t end, uint32_t threshold)
+{
+    int64_t sum = 0;
+    for (std::size_t i = begin; i != end; ++i) {
+        const int64_t value = source.price_at(i) * (100 - source.discount_at(i)) * (100 + source.tax_at(i));
+        sum += source.date_at(i) < threshold ? value : 0;
+    }
+    return sum;
+}
+
+/** Multiplies the 64 bit lanes of a and b and returns the lower 64 bits of the products.  AVX2 has no such
+ * instruction, hence the products are composed from 32 bit multiplications. */
+__attribute__((target("avx2")))
+inline __m256i mullo_epi64(__m256i a, __m256i b)
+{
+    const __m256i lo = _mm256_mul_epu32(a, b);
+    const __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), b),
+                                           _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+    return _mm256_add_epi64(lo, _mm256_slli_epi64(cross, 32));
+}
+
+template<typename Source>
+__attribute__((target("avx2")))
+int64_t sum_avx2(const Source &source, std::size_t n, uint32_t threshold)
+{
+    const __m256i hundred = _mm256_set1_epi64x(100);
+    const __m256i limit = _mm256_set1_epi64x(threshold);
+    __m256i sum = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i date, price, discount, tax;
+        source.load(i, date, price, discount, tax);
+        /* Dates are zero extended to 64 bits, hence the signed comparison is exact. */
+        const __m256i mask = _mm256_cmpgt_epi64(limit, date);
+        const __m256i value = mullo_epi64(mullo_epi64(price, _mm256_sub_epi64(hundred, discount)),
+                                          _mm256_add_epi64(hundred, tax));
+        sum = _mm256_add_epi64(sum, _mm256_and_si256(mask, value));
+    }
+    alignas(32) int64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), sum);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + sum_scalar(source, i, n, threshold);
+}
+
+template<typename Source>
+__attribute__((target("avx512f,avx512dq")))
+int64_t sum_avx512(const Source &source, std::size_t n, uint32_t threshold)
+{
+    const __m512i hundred = _mm512_set1_epi64(100);
+    const __m512i limit = _mm512_set1_epi64(threshold);
+    __m512i sum = _mm512_setzero_si512();
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512i date, price, discount, tax;
+        source.load(i, date, price, discount, tax);
+        const __mmask8 mask = _mm512_cmplt_epu64_mask(date, limit);
+        const __m512i value = _mm512_mullo_epi64(_mm512_mullo_epi64(price, _mm512_sub_epi64(hundred, discount)),
+                                                 _mm512_add_epi64(hundred, tax));
+        sum = _mm512_mask_add_epi64(sum, mask, sum, value);
+    }
+    alignas(64) int64_t lanes[8];
+    _mm512_store_si512(lanes, sum);
+    int64_t total = sum_scalar(source, i, n, threshold);
+    for (int64_t lane : lanes)
+        total += lane;
+    return total;
+}
+
+template<typename Source>
+int64_t sum_discounted_price(const Source &source, std::size_t n, uint32_t threshold, ISA isa)
+{
+    assert(is_supported(isa), "the CPU does not support the instruction set");
+    switch (isa) {
+        case ISA_Scalar: return sum_scalar(source, 0, n, threshold);
+        case ISA_AVX2: return sum_avx2(source, n, threshold);
+        case ISA_AVX512: return sum_avx512(source, n, threshold);
+    }
+    dbms_unreachable("unknown instruction set");
+}
+
+}
+
+int64_t dbms::sum_discounted_price(const uint32_t *date, const int64_t *price, const int64_t *discount,
+                                   const int64_t *tax, std::size_t n, uint32_t threshold, ISA isa)
+{
+    return ::sum_discounted_price(Columns{ date, price, discount, tax }, n, threshold, isa);
+}
+
+int64_t dbms::sum_discounted_price(const void *rows, std::size_t row_size, std::size_t date_offset,
+                                   std::size_t price_offset, std::size_t discount_offset, std::size_t tax_offset,
+                                   std::size_t n, uint32_t threshold, ISA isa)
+{
+    const Rows source{ static_cast<const uint8_t*>(rows), row_size, date_offset, price_offset, discount_offset,
+                       tax_offset };
+    return ::sum_discounted_price(source, n, threshold, isa);
+}
+
+
+/*======================================================================================================================
+ * Bit unpacking
+ *
+ * Integers of up to MAX_VECTOR_UNPACK_BITS bits lie within the 8 bytes starting at the byte of their first bit.  The
+ * vectorized kernels gather these 8 bytes for 4 (AVX2) or 8 (AVX-512) integers at once, and shift and mask every lane.
+ *====================================================================================================================*/
+
+namespace {
+
+/** Returns the mask of the lowest bits bits. */
+inline uint64_t low_bits(unsigned bits) { return bits == 64 ? ~uint64_t(0) : (uint64_t(1) << bits) - 1; }
+
+void unpack_bits_scalar(const uint64_t *packed, unsigned bits, std::size_t first, std::size_t n, uint64_t reference,
+                        uint64_t *out)
+{
+    const uint64_t mask = low_bits(bits);
+    if (bits == 0) {
+        std::fill_n(out, n, reference);
+    } else if (bits <= MAX_VECTOR_UNPACK_BITS) {
+        const uint8_t *bytes = reinterpret_cast<const uint8_t*>(packed);
+        for (std::size_t i = 0; i != n; ++i) {
+            const std::size_t bit = (first + i) * bits;
+            uint64_t word;
+            memcpy(&word, bytes + bit / 8, sizeof(word));
+            out[i] = reference + ((word >> (bit % 8)) & mask);
+        }
+    } else {
+        for (std::size_t i = 0; i != n; ++i) {
+            const std::size_t bit = (first + i) * bits;
+            const std::size_t shift = bit % 64;
+            uint64_t value = packed[bit / 64] >> shift;
+            if (shift + bits > 64)
+                value |= packed[bit / 64 + 1] << (64 - shift);
+            out[i] = reference + (value & mask);
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+void unpack_bits_avx2(const uint64_t *packed, unsigned bits, std::size_t first, std::size_t n, uint64_t reference,
+                      uint64_t *out)
+{
+    const long long *bytes = reinterpret_cast<const long long*>(packed);
+    const __m256i mask = _mm256_set1_epi64x(low_bits(bits));
+    const __m256i ref = _mm256_set1_epi64x(reference);
+    const __m256i seven = _mm256_set1_epi64x(7);
+    const __m256i step = _mm256_set1_epi64x(4 * bits);
+    __m256i bit = _mm256_add_epi64(_mm256_set1_epi64x(first * bits), _mm256_setr_epi64x(0, bits, 2 * bits, 3 * bits));
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m256i words = _mm256_i64gather_epi64(bytes, _mm256_srli_epi64(bit, 3), 1);
+        const __m256i value = _mm256_and_si256(_mm256_srlv_epi64(words, _mm256_and_si256(bit, seven)), mask);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_add_epi64(value, ref));
+        bit = _mm256_add_epi64(bit, step);
+    }
+    unpack_bits_scalar(packed, bits, first + i, n - i, reference, out + i);
+}
+
+__attribute__((target("avx512f,avx512dq")))
+void unpack_bits_avx512(const uint64_t *packed, unsigned bits, std::size_t first, std::size_t n, uint64_t reference,
+                        uint64_t *out)
+{
+    const __m512i mask = _mm512_set1_epi64(low_bits(bits));
+    const __m512i ref = _mm512_set1_epi64(reference);
+    const __m512i seven = _mm512_set1_epi64(7);
+    const __m512i step = _mm512_set1_epi64(8 * bits);
+    const __m512i lanes = _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+    __m512i bit = _mm512_add_epi64(_mm512_set1_epi64(first * bits), _mm512_mullo_epi64(_mm512_set1_epi64(bits), lanes));
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m512i words = _mm512_mask_i64gather_epi64(_mm512_setzero_si512(), ALL_LANES,
+                                                          _mm512_maskz_srli_epi64(ALL_LANES, bit, 3), packed, 1);
+        const __m512i shift = _mm512_and_si512(bit, seven);
+        const __m512i value = _mm512_and_si512(_mm512_maskz_srlv_epi64(ALL_LANES, words, shift), mask);
+        _mm512_storeu_si512(out + i, _mm512_add_epi64(value, ref));
+        bit = _mm512_add_epi64(bit, step);
+    }
+    unpack_bits_scalar(packed, bits, first + i, n - i, reference, out + i);
+}
+
+}
+
+void dbms::unpack_bits(const uint64_t *packed, unsigned bits, std::size_t first, std::size_t n, uint64_t reference,
+                       uint64_t *out, ISA isa)
+{
+    assert(bits <= 64, "integers have at most 64 bits");
+    assert(is_supported(isa), "the CPU does not support the instruction set");
+    if (bits == 0 or bits > MAX_VECTOR_UNPACK_BITS) isa = ISA_Scalar;
+    switch (isa) {
+        case ISA_Scalar: return unpack_bits_scalar(packed, bits, first, n, reference, out);
+        case ISA_AVX2: return unpack_bits_avx2(packed, bits, first, n, reference, out);
+        case ISA_AVX512: return unpack_bits_avx512(packed, bits, first, n, reference, out);
+    }
+    dbms_unreachable("unknown instruction set");
+}
+
+
+/*======================================================================================================================
+ * Structural characters
+ *
+ * The vectorized kernels compare 32 (AVX2) or 64 (AVX-512) bytes at a time with the delimiter and the newline, and
+ * gather the results into a bitmask.
+ *====================================================================================================================*/
+
+namespace {
+
+uint64_t find_structurals_scalar(const char *block, char delimiter)
+{
+    uint64_t mask = 0;
+    for (unsigned i = 0; i != 64; ++i)
+        mask |= uint64_t(block[i] == delimiter or block[i] == '\n') << i;
+    return mask;
+}
+
+__attribute__((target("avx2")))
+uint64_t find_structurals_avx2(const char *block, char delimiter)
+{
+    const __m256i delim = _mm256_set1_epi8(delimiter);
+    const __m256i newline = _mm256_set1_epi8('\n');
+    uint64_t mask = 0;
+    for (unsigned i = 0; i != 2; ++i) {
+        const __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32 * i));
+        const __m256i eq = _mm256_or_si256(_mm256_cmpeq_epi8(data, delim), _mm256_cmpeq_epi8(data, newline));
+        mask |= uint64_t(uint32_t(_mm256_movemask_epi8(eq))) << (32 * i);
+    }
+    return mask;
+}
+
+__attribute__((target("avx512f,avx512bw")))
+uint64_t find_structurals_avx512(const char *block, char delimiter)
+{
+    const __m512i data = _mm512_loadu_si512(block);
+    return _mm512_cmpeq_epi8_mask(data, _mm512_set1_epi8(delimiter)) |
+           _mm512_cmpeq_epi8_mask(data, _mm512_set1_epi8('\n'));
+}
+
+}
+
+uint64_t dbms::find_structurals(const char *block, char delimiter, ISA isa)
+{
+    assert(is_supported(isa), "the CPU does not support the instruction set");
+    switch (isa) {
+        case ISA_Scalar: return find_structurals_scalar(block, delimiter);
+        case ISA_AVX2: return find_structurals_avx2(block, delimiter);
+        case ISA_AVX512: return find_structurals_avx512(block, delimiter);
+    }
+    dbms_unreachable("unknown instruction set");
+}
+
+
+/*======================================================================================================================
+ * Prefix sums
+ *
+ * The vectorized kernels compute the prefix sums within a vector in log2(lanes) steps of adding the vector shifted by 1,
+ * 2, 4, ... lanes, and add the broadcast sum of all preceding vectors.
+ *====================================================================================================================*/
+
+namespace {
+
+template<typename T>
+void prefix_sum_scalar(T *values, std::size_t n, T initial)
+{
+    for (std::size_t i = 0; i != n; ++i)
+        values[i] = initial += values[i];
+}
+
+__attribute__((target("avx2")))
+void prefix_sum_avx2(uint32_t *values, std::size_t n, uint32_t initial)
+{
+    /* Shifting bytes works within 128 bit lanes, hence the sum of the lower lane is added to the upper lane. */
+    const __m256i last_of_lower = _mm256_set1_epi32(3);
+    const __m256i last = _mm256_set1_epi32(7);
+    __m256i sum = _mm256_set1_epi32(initial);
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+        x = _mm256_add_epi32(x, _mm256_slli_si256(x, 4));
+        x = _mm256_add_epi32(x, _mm256_slli_si256(x, 8));
+        x = _mm256_add_epi32(x, _mm256_blend_epi32(_mm256_setzero_si256(),
+                                                   _mm256_permutevar8x32_epi32(x, last_of_lower), 0xf0));
+        x = _mm256_add_epi32(x, sum);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(values + i), x);
+        sum = _mm256_permutevar8x32_epi32(x, last);
+    }
+    prefix_sum_scalar(values + i, n - i, uint32_t(_mm256_cvtsi256_si32(sum)));
+}
+
+__attribute__((target("avx2")))
+void prefix_sum_avx2(uint64_t *values, std::size_t n, uint64_t initial)
+{
+    __m256i sum = _mm256_set1_epi64x(initial);
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+        x = _mm256_add_epi64(x, _mm256_slli_si256(x, 8));
+        x = _mm256_add_epi64(x, _mm256_blend_epi32(_mm256_setzero_si256(), _mm256_permute4x64_epi64(x, 0x55), 0xf0));
+        x = _mm256_add_epi64(x, sum);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(values + i), x);
+        sum = _mm256_permute4x64_epi64(x, 0xff);
+    }
+    prefix_sum_scalar(values + i, n - i, uint64_t(_mm256_extract_epi64(sum, 0)));
+}
+
+__attribute__((target("avx512f,avx512dq")))
+void prefix_sum_avx512(uint32_t *values, std::size_t n, uint32_t initial)
+{
+    /* alignr(x, 0, 16 - k) shifts x up by k lanes, shifting in zeros. */
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i last = _mm512_set1_epi32(15);
+    __m512i sum = _mm512_set1_epi32(initial);
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512i x = _mm512_loadu_si512(values + i);
+        x = _mm512_add_epi32(x, _mm512_maskz_alignr_epi32(ALL_LANES_32, x, zero, 15));
+        x = _mm512_add_epi32(x, _mm512_maskz_alignr_epi32(ALL_LANES_32, x, zero, 14));
+        x = _mm512_add_epi32(x, _mm512_maskz_alignr_epi32(ALL_LANES_32, x, zero, 12));
+        x = _mm512_add_epi32(x, _mm512_maskz_alignr_epi32(ALL_LANES_32, x, zero, 8));
+        x = _mm512_add_epi32(x, sum);
+        _mm512_storeu_si512(values + i, x);
+        sum = _mm512_maskz_permutexvar_epi32(ALL_LANES_32, last, x);
+    }
+    prefix_sum_scalar(values + i, n - i, uint32_t(_mm512_cvtsi512_si32(sum)));
+}
+
+__attribute__((target("avx512f,avx512dq")))
+void prefix_sum_avx512(uint64_t *values, std::size_t n, uint64_t initial)
+{
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i last = _mm512_set1_epi64(7);
+    __m512i sum = _mm512_set1_epi64(initial);
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512i x = _mm512_loadu_si512(values + i);
+        x = _mm512_add_epi64(x, _mm512_maskz_alignr_epi64(ALL_LANES, x, zero, 7));
+        x = _mm512_add_epi64(x, _mm512_maskz_alignr_epi64(ALL_LANES, x, zero, 6));
+        x = _mm512_add_epi64(x, _mm512_maskz_alignr_epi64(ALL_LANES, x, zero, 4));
+        x = _mm512_add_epi64(x, sum);
+        _mm512_storeu_si512(values + i, x);
+        sum = _mm512_maskz_permutexvar_epi64(ALL_LANES, last, x);
+    }
+    alignas(64) uint64_t lanes[8];
+    _mm512_store_si512(lanes, sum);
+    prefix_sum_scalar(values + i, n - i, lanes[0]);
+}
+
+template<typename T>
+void prefix_sum_isa(T *values, std::size_t n, T initial, ISA isa)
+{
+    assert(is_supported(isa), "the CPU does not support the instruction set");
+    switch (isa) {
+        case ISA_Scalar: return prefix_sum_scalar(values, n, initial);
+        case ISA_AVX2: return prefix_sum_avx2(values, n, initial);
+        case ISA_AVX512: return prefix_sum_avx512(values, n, initial);
+    }
+    dbms_unreachable("unknown instruction set");
+}
+
+}
+
+void dbms::prefix_sum(uint32_t *values, std::size_t n, uint32_t initial, ISA isa)
+{
+    prefix_sum_isa(values, n, initial, isa);
+}
+
+void dbms::prefix_sum(uint64_t *values, std::size_t n, uint64_t initial, ISA isa)
+{
+    prefix_sum_isa(values, n, initial, isa);
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "dbms/Loader.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace dbms {
+
+template<typename Store, typename MakeStore, typename Parse>
+std::size_t Loader::load_parallel(Loader &loader, Store &store, std::size_t max_rows, unsigned num_threads,
+                                  MakeStore make_store, Parse parse, bool in_place)
+{
+    constexpr std::size_t CHUNKS_PER_THREAD = 4; // more chunks than threads to balance the load
+    constexpr std::size_t MIN_CHUNK_SIZE = 1 << 20; // don't bother splitting small inputs
+    constexpr std::size_t MAX_CHUNK_SIZE = 64 << 20; // bounds the memory of a parsed chunk
+
+    if (num_threads == 0)
+        num_threads = std::max(1U, std::thread::hardware_concurrency());
+
+    /* Split the remaining input into chunks at line boundaries. */
+    const std::size_t input_size = loader.end_ - loader.pos_;
+    const std::size_t max_chunks = std::min(std::max(num_threads * CHUNKS_PER_THREAD, input_size / MAX_CHUNK_SIZE),
+                                            input_size / MIN_CHUNK_SIZE + 1);
+    if (in_place and (num_threads == 1 or max_chunks == 1))
+        return parse(loader, store, max_rows);
+
+    std::vector<const char*> bounds{ loader.pos_ };
+    const std::size_t chunk_size = input_size / max_chunks;
+    while (bounds.size() != max_chunks) {
+        const char *next = bounds.back() + chunk_size;
+        if (next >= loader.end_) break;
+        next = static_cast<const char*>(memchr(next, '\n', loader.end_ - next));
+        if (not next or ++next == loader.end_) break;
+        bounds.push_back(next);
+    }
+    bounds.push_back(loader.end_);
+    const std::size_t num_chunks = bounds.size() - 1;
+
+    /* Parse the chunks concurrently on the worker threads.  Chunks are claimed in input order, hence once the already
+     * parsed chunks provide max_rows rows, all remaining chunks can be skipped.  A worker parses chunk i only once
+     * fewer than num_threads chunks precede it that are not yet appended to store.  Thereby at most num_threads chunk
+     * stores exist at a time, even if appending, e.g. encoding compressed columns, is slower than parsing. */
+    std::vector<std::unique_ptr<Store>> chunk_stores(num_chunks);
+    std::vector<std::size_t> chunk_rows(num_chunks, 0);
+    std::mutex mutex; // guards chunk_stores, num_appended, and is_done
+    std::condition_variable chunk_parsed; // notifies the appender
+    std::condition_variable chunk_appended; // notifies the workers
+    std::size_t num_appended = 0; // the number of chunks appended to store and released
+    bool is_done = false; // whether the appender needs no more chunks
+    std::atomic<std::size_t> next_chunk(0);
+    std::atomic<std::size_t> num_parsed(0);
+
+    auto worker = [&]() {
+        while (num_parsed.load(std::memory_order_relaxed) < max_rows) {
+            const std::size_t i = next_chunk++;
+            if (i >= num_chunks) break;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                chunk_appended.wait(lock, [&]() { return is_done or i < num_appended + num_threads; });
+                if (is_done) break;
+            }
+            std::unique_ptr<Store> chunk_store(new Store(make_store()));
+            Loader chunk(loader, bounds[i], bounds[i + 1]);
+            chunk_rows[i] = parse(chunk, *chunk_store, max_rows);
+            num_parsed += chunk_rows[i];
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                chunk_stores[i] = std::move(chunk_store);
+            }
+            chunk_parsed.notify_one();
+        }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < std::min<std::size_t>(num_threads, num_chunks); ++i)
+        threads.emplace_back(worker);
+
+    /* Meanwhile, append the chunks to store in input order as soon as they are parsed, and release them. */
+    std::size_t num_rows = 0;
+    for (std::size_t i = 0; i != num_chunks and num_rows != max_rows; ++i) {
+        std::unique_ptr<Store> chunk_store;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            chunk_parsed.wait(lock, [&]() { return bool(chunk_stores[i]); });
+            chunk_store = std::move(chunk_stores[i]);
+        }
+        const std::size_t n = std::min(chunk_rows[i], max_rows - num_rows);
+        store.append(*chunk_store, n);
+        num_rows += n;
+        chunk_store.reset();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++num_appended;
+        }
+        chunk_appended.notify_all();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        is_done = true;
+    }
+    chunk_appended.notify_all();
+
+    for (auto &t : threads)
+        t.join();
+    loader.pos_ = loader.end_;
+
+    return num_rows;
+}
+
+}
@@ -0,0 +1,207 @@
+#include "dbms/Memory.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <err.h>
+#include <linux/mempolicy.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+
+using namespace dbms;
+
+
+/** Returns true iff an allocation of size bytes with policy is mapped from the operating system.  Small allocations
+ * are not worth a mapping of their own and are always served by malloc(). */
+static bool is_mapped(std::size_t size, const MemoryPolicy &policy)
+{
+    constexpr std::size_t MIN_MAPPING_SIZE = 64 << 10;
+    return not policy.is_regular() and size >= MIN_MAPPING_SIZE;
+}
+
+/** Returns the size of a mapping of size bytes with policy, i.e. size rounded up to the page size. */
+static std::size_t mapping_size(std::size_t size, const MemoryPolicy &policy)
+{
+    const std::size_t page_size = policy.pages == MemoryPolicy::PG_Explicit_Huge ? MemoryPolicy::HUGE_PAGE_SIZE
+                                                                                 : std::size_t(PAGESIZE);
+    return (size + page_size - 1) / page_size * page_size;
+}
+
+/** Applies the page size and placement of policy to the mapping of size bytes at addr. */
+static void apply(void *addr, std::size_t size, const MemoryPolicy &policy)
+{
+    if (policy.pages == MemoryPolicy::PG_Transparent_Huge and madvise(addr, size, MADV_HUGEPAGE))
+        warn("Failed to advise transparent huge pages");
+
+    if (policy.placement != MemoryPolicy::PL_First_Touch) {
+        const int mode = policy.placement == MemoryPolicy::PL_Bind ? MPOL_BIND : MPOL_INTERLEAVE;
+        const unsigned long nodes = policy.nodes;
+        if (syscall(SYS_mbind, addr, size, mode, &nodes, 8 * sizeof(nodes) + 1, 0))
+            warn("Failed to set the NUMA placement of memory");
+    }
+}
+
+/** Maps size bytes with policy. */
+static void * map(std::size_t size, const MemoryPolicy &policy, int flags)
+{
+    flags |= MAP_PRIVATE | MAP_ANONYMOUS;
+    void *addr = MAP_FAILED;
+    if (policy.pages == MemoryPolicy::PG_Explicit_Huge) {
+        addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB, -1, 0);
+        if (addr == MAP_FAILED) {
+            /* The pool of huge pages is exhausted.  Fall back to transparent huge pages. */
+            MemoryPolicy fallback = policy;
+            fallback.pages = MemoryPolicy::PG_Transparent_Huge;
+            return map(size, fallback, flags);
+        }
+    } else {
+        addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+    }
+    if (addr == MAP_FAILED)
+        err(EXIT_FAILURE, "Failed to map %zu bytes of memory", size);
+    apply(addr, size, policy);
+    return addr;
+}
+
+
+/*======================================================================================================================
+ * MemoryPolicy
+ *====================================================================================================================*/
+
+MemoryPolicy & MemoryPolicy::Default()
+{
+    static MemoryPolicy policy = []() {
+        const char *env = getenv("DBMS_MEMORY_POLICY");
+        return env ? Parse(env) : MemoryPolicy();
+    }();
+    return policy;
+}
+
+/** Parses a '+' separated list of NUMA nodes and ranges of nodes into a bitmask. */
+static uint64_t parse_nodes(const std::string &str)
+{
+    uint64_t nodes = 0;
+    std::size_t pos = 0;
+    while (pos <= str.size()) {
+        std::size_t end = str.find('+', pos);
+        if (end == std::string::npos) end = str.size();
+        const std::string range = str.substr(pos, end - pos);
+        char *p;
+        const unsigned long first = strtoul(range.c_str(), &p, 10);
+        const unsigned long last = *p == '-' ? strtoul(p + 1, &p, 10) : first;
+        if (range.empty() or *p or first > last or last >= 64)
+            errx(EXIT_FAILURE, "Invalid NUMA nodes '%s'", str.c_str());
+        for (unsigned long node = first; node <= last; ++node)
+            nodes |= uint64_t(1) << node;
+        pos = end + 1;
+    }
+    return nodes;
+}
+
+MemoryPolicy MemoryPolicy::Parse(const char *str)
+{
+    MemoryPolicy policy;
+    const std::string spec(str);
+    std::size_t pos = 0;
+    while (pos <= spec.size()) {
+        std::size_t end = spec.find(',', pos);
+        if (end == std::string::npos) end = spec.size();
+        const std::string option = spec.substr(pos, end - pos);
+        const std::size_t eq = option.find('=');
+        const std::string name = option.substr(0, eq);
+
+        if (name == "regular") {
+            policy = MemoryPolicy();
+        } else if (name == "thp") {
+            policy.pages = PG_Transparent_Huge;
+        } else if (name == "hugetlb") {
+            policy.pages = PG_Explicit_Huge;
+        } else if ((name == "bind" or name == "interleave") and eq != std::string::npos) {
+            policy.placement = name == "bind" ? PL_Bind : PL_Interleave;
+            policy.nodes = parse_nodes(option.substr(eq + 1));
+        } else {
+            errx(EXIT_FAILURE, "Invalid memory policy option '%s'", option.c_str());
+        }
+        pos = end + 1;
+    }
+    return policy;
+}
+
+
+/*======================================================================================================================
+ * Allocation
+ *====================================================================================================================*/
+
+void * dbms::allocate(std::size_t size, const MemoryPolicy &policy)
+{
+    if (size == 0) return nullptr;
+    if (not is_mapped(size, policy)) {
+        void *ptr = malloc(size);
+        if (not ptr)
+            err(EXIT_FAILURE, "Failed to allocate %zu bytes of memory", size);
+        return ptr;
+    }
+    return map(mapping_size(size, policy), policy, 0);
+}
+
+void * dbms::reallocate(void *ptr, std::size_t old_size, std::size_t new_size, const MemoryPolicy &policy)
+{
+    if (not ptr) return allocate(new_size, policy);
+    if (new_size == 0) {
+        deallocate(ptr, old_size, policy);
+        return nullptr;
+    }
+    if (not is_mapped(old_size, policy) and not is_mapped(new_size, policy)) {
+        void *new_ptr = realloc(ptr, new_size);
+        if (not new_ptr)
+            err(EXIT_FAILURE, "Failed to allocate %zu bytes of memory", new_size);
+        return new_ptr;
+    }
+
+    if (is_mapped(old_size, policy) and is_mapped(new_size, policy)) {
+        const std::size_t old_mapping = mapping_size(old_size, policy);
+        const std::size_t new_mapping = mapping_size(new_size, policy);
+        if (old_mapping == new_mapping) return ptr;
+
+        /* Let the kernel move the pages instead of copying the data. */
+        void *new_ptr = mremap(ptr, old_mapping, new_mapping, MREMAP_MAYMOVE);
+        if (new_ptr != MAP_FAILED) {
+            apply(new_ptr, new_mapping, policy);
+            return new_ptr;
+        }
+    }
+
+    void *new_ptr = allocate(new_size, policy);
+    memcpy(new_ptr, ptr, std::min(old_size, new_size));
+    deallocate(ptr, old_size, policy);
+    return new_ptr;
+}
+
+void dbms::deallocate(void *ptr, std::size_t size, const MemoryPolicy &policy)
+{
+    if (not ptr) return;
+    if (not is_mapped(size, policy))
+        free(ptr);
+    else if (munmap(ptr, mapping_size(size, policy)))
+        warn("Failed to unmap %zu bytes of memory", size);
+}
+
+void * dbms::reserve_pages(std::size_t size, const MemoryPolicy &policy)
+{
+    /* Explicit huge pages cannot be committed lazily: touching a page of the reservation would fail with SIGBUS once
+     * the pool is exhausted.  Use transparent huge pages instead. */
+    MemoryPolicy reservation = policy;
+    if (reservation.pages == MemoryPolicy::PG_Explicit_Huge)
+        reservation.pages = MemoryPolicy::PG_Transparent_Huge;
+    return map(mapping_size(size, policy), reservation, MAP_NORESERVE);
+}
+
+void dbms::release_pages(void *addr, std::size_t size, const MemoryPolicy &policy)
+{
+    if (munmap(addr, mapping_size(size, policy)))
+        warn("Failed to release %zu bytes of address space", size);
+}
@@ -0,0 +1,1854 @@
+#include "dbms/Operator.hpp"
+
+#include "dbms/util.hpp"
+#include "impl/ColumnStore.hpp"
+#include "impl/RowStore.hpp"
+#include <algorithm>
+#include <cstring>
+#include <err.h>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <strings.h>
+
+
+using namespace dbms;
+
+
+std::size_t dbms::index_of(const Schema &schema, const std::string &name)
+{
+    for (std::size_t i = 0; i != schema.size(); ++i) {
+        if (strcasecmp(schema[i].name.c_str(), name.c_str()) == 0)
+            return i;
+    }
+    errx(EXIT_FAILURE, "Unknown attribute '%s'", name.c_str());
+}
+
+/** Returns a buffer for a batch of values of size bytes. */
+static std::vector<uint64_t> make_buffer(std::size_t size)
+{
+    return std::vector<uint64_t>((BATCH_SIZE * size + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+}
+
+static bool is_numeric(Attribute::Type type)
+{
+    return type == Attribute::TY_Int or type == Attribute::TY_Float or type == Attribute::TY_Double;
+}
+
+/** Calls f with a null pointer to the C++ type of the numeric values of type and size, and returns its result. */
+template<typename F>
+static decltype(auto) dispatch_numeric(Attribute::Type type, std::size_t size, F &&f)
+{
+    switch (type) {
+        case Attribute::TY_Int:
+            switch (size) {
+                case 1: return f((uint8_t*) nullptr);
+                case 2: return f((uint16_t*) nullptr);
+                case 4: return f((uint32_t*) nullptr);
+                case 8: return f((int64_t*) nullptr);
+            }
+            break;
+        case Attribute::TY_Float: return f((float*) nullptr);
+        case Attribute::TY_Double: return f((double*) nullptr);
+        default: break;
+    }
+    dbms_unreachable("not a numeric type");
+}
+
+/** Calls f with the function object of the comparison op, and returns its result. */
+template<typename F>
+static decltype(auto) dispatch_comparison(Expr::Operation op, F &&f)
+{
+    switch (op) {
+        case Expr::OP_Eq: return f(std::equal_to<>());
+        case Expr::OP_Ne: return f(std::not_equal_to<>());
+        case Expr::OP_Lt: return f(std::less<>());
+        case Expr::OP_Le: return f(std::less_equal<>());
+        case Expr::OP_Gt: return f(std::greater<>());
+        case Expr::OP_Ge: return f(std::greater_equal<>());
+        default: dbms_unreachable("not a comparison");
+    }
+}
+
+/** Copies n values of S bytes to dst, placing consecutive values dst_stride bytes apart.  The i-th value is read from
+ * src + src_stride * index(i). */
+template<std::size_t S, typename Index>
+static void copy_values(uint8_t *dst, std::size_t dst_stride, const uint8_t *src, std::size_t src_stride,
+                        std::size_t n, Index index)
+{
+    for (std::size_t i = 0; i != n; ++i)
+        memcpy(dst + i * dst_stride, src + index(i) * src_stride, S);
+}
+
+/** Same as above for values of size bytes. */
+template<typename Index>
+static void copy_values(uint8_t *dst, std::size_t dst_stride, const uint8_t *src, std::size_t src_stride,
+                        std::size_t size, std::size_t n, Index index)
+{
+    switch (size) {
+        case 1: return copy_values<1>(dst, dst_stride, src, src_stride, n, index);
+        case 2: return copy_values<2>(dst, dst_stride, src, src_stride, n, index);
+        case 4: return copy_values<4>(dst, dst_stride, src, src_stride, n, index);
+        case 8: return copy_values<8>(dst, dst_stride, src, src_stride, n, index);
+        default:
+            if (size > 8 and size < 16) {
+                /* Copy two overlapping words per value, rather than calling memcpy. */
+                copy_values<8>(dst, dst_stride, src, src_stride, n, index);
+                copy_values<8>(dst + size - 8, dst_stride, src + size - 8, src_stride, n, index);
+                return;
+            }
+            for (std::size_t i = 0; i != n; ++i)
+                memcpy(dst + i * dst_stride, src + index(i) * src_stride, size);
+    }
+}
+
+/** Copies the values of the selected rows of batch in vector v to dst, placing consecutive values dst_stride bytes
+ * apart. */
+static void copy_selected(uint8_t *dst, std::size_t dst_stride, const Vector &v, const Batch &batch)
+{
+    const uint8_t *src = v.as<uint8_t>();
+    if (const uint16_t *selection = batch.selection)
+        copy_values(dst, dst_stride, src, v.elem_size, v.elem_size, batch.num_selected,
+                    [selection](std::size_t i) { return selection[i]; });
+    else
+        copy_values(dst, dst_stride, src, v.elem_size, v.elem_size, batch.size, [](std::size_t i) { return i; });
+}
+
+/** Returns the value of the constant numeric vector v as T. */
+template<typename T>
+static T scalar(const Vector &v)
+{
+    return dispatch_numeric(v.type, v.elem_size, [&](auto *type) {
+        using U = std::remove_pointer_t<decltype(type)>;
+        return T(*v.as<U>());
+    });
+}
+
+/** Returns the first n values of the numeric vector v as T.  Values are converted to buffer, unless v holds values of
+ * type T.  Constants are broadcast to buffer. */
+template<typename T>
+static const T * convert(const Vector &v, std::size_t n, T *buffer)
+{
+    if (v.is_constant) {
+        std::fill_n(buffer, n, scalar<T>(v));
+        return buffer;
+    }
+    return dispatch_numeric(v.type, v.elem_size, [&](auto *type) -> const T* {
+        using U = std::remove_pointer_t<decltype(type)>;
+        if constexpr (std::is_same<T, U>::value) {
+            return v.as<T>();
+        } else {
+            const U *values = v.as<U>();
+            for (std::size_t i = 0; i != n; ++i)
+                buffer[i] = T(values[i]);
+            return buffer;
+        }
+    });
+}
+
+/** Returns the hash of the key of num_words words. */
+static uint64_t hash_key(const uint64_t *key, std::size_t num_words)
+{
+    uint64_t hash = 0;
+    for (std::size_t i = 0; i != num_words; ++i)
+        hash = Murmur3{}(hash ^ key[i]);
+    return hash;
+}
+
+/** Returns true iff the keys of num_words words are equal. */
+static bool equal_keys(const uint64_t *first, const uint64_t *second, std::size_t num_words)
+{
+    for (std::size_t i = 0; i != num_words; ++i) {
+        if (first[i] != second[i]) return false;
+    }
+    return true;
+}
+
+
+/*======================================================================================================================
+ * Expressions
+ *====================================================================================================================*/
+
+namespace dbms {
+
+/**
+ * A node of the tree of an expression, as constructed by the user.  Before evaluation, an expression is compiled to a
+ * tree of ExprEvaluators for the schema it is evaluated on.
+ */
+struct ExprNode
+{
+    enum Kind { EX_Column, EX_Constant, EX_Operation };
+
+    Kind kind;
+    Expr::Operation op = Expr::OP_Add; ///< the operation, for EX_Operation
+    std::string name; ///< the name of the attribute, for EX_Column
+    Vector value; ///< the value, for EX_Constant
+    uint64_t constant = 0; ///< the storage of numeric values
+    std::string str; ///< the storage of string values
+    std::vector<std::shared_ptr<const ExprNode>> args; ///< the operands, for EX_Operation
+};
+
+/**
+ * The base class of compiled expressions.
+ */
+struct ExprEvaluator
+{
+    Attribute::Type type = Attribute::TY_Int; ///< the type of the result
+    std::size_t elem_size = sizeof(int64_t); ///< the size of a value of the result
+    bool is_boolean = false; ///< whether the result is a boolean
+
+    virtual ~ExprEvaluator() { }
+
+    /** Evaluates the expression for all rows of batch.  The vector remains valid until the next evaluation. */
+    virtual Vector eval(const Batch &batch) = 0;
+
+    protected:
+    Vector make_vector(const void *data, bool is_constant) const {
+        Vector v;
+        v.type = type;
+        v.elem_size = elem_size;
+        v.data = data;
+        v.is_constant = is_constant;
+        return v;
+    }
+};
+
+}
+
+namespace {
+
+struct ColumnEvaluator : ExprEvaluator
+{
+    ColumnEvaluator(const Schema &schema, const std::string &name) : idx_(index_of(schema, name)) {
+        type = schema[idx_].type;
+        elem_size = schema[idx_].size;
+        if (type == Attribute::TY_Varchar)
+            errx(EXIT_FAILURE, "Expressions on attribute '%s' of type Varchar are not supported", name.c_str());
+    }
+
+    Vector eval(const Batch &batch) { return batch.vectors[idx_]; }
+
+    private:
+    std::size_t idx_;
+};
+
+struct ConstantEvaluator : ExprEvaluator
+{
+    /* The evaluator copies the constant, as the expression may be destroyed after compilation. */
+    ConstantEvaluator(const ExprNode &node) : constant_(node.constant), str_(node.str) {
+        type = node.value.type;
+        elem_size = node.value.elem_size;
+    }
+
+    Vector eval(const Batch&) {
+        return make_vector(type == Attribute::TY_Char ? static_cast<const void*>(str_.c_str()) : &constant_, true);
+    }
+
+    private:
+    uint64_t constant_;
+    std::string str_;
+};
+
+/** Computes f for the values of l and r, and writes the results to out.  Operands are converted to T.  Returns true, if
+ * both operands are constant and thus a single result was computed. */
+template<typename T, typename R, typename F>
+bool binary(const Vector &l, const Vector &r, std::size_t n, T *l_buffer, T *r_buffer, R *out, F f)
+{
+    if (l.is_constant and r.is_constant) {
+        out[0] = f(scalar<T>(l), scalar<T>(r));
+        return true;
+    }
+    if (r.is_constant) {
+        const T *a = convert<T>(l, n, l_buffer);
+        const T b = scalar<T>(r);
+        for (std::size_t i = 0; i != n; ++i)
+            out[i] = f(a[i], b);
+    } else if (l.is_constant) {
+        const T a = scalar<T>(l);
+        const T *b = convert<T>(r, n, r_buffer);
+        for (std::size_t i = 0; i != n; ++i)
+            out[i] = f(a, b[i]);
+    } else {
+        const T *a = convert<T>(l, n, l_buffer);
+        const T *b = convert<T>(r, n, r_buffer);
+        for (std::size_t i = 0; i != n; ++i)
+            out[i] = f(a[i], b[i]);
+    }
+    return false;
+}
+
+struct ArithmeticEvaluator : ExprEvaluator
+{
+    ArithmeticEvaluator(Expr::Operation op, std::unique_ptr<ExprEvaluator> lhs, std::unique_ptr<ExprEvaluator> rhs)
+        : op_(op), lhs_(std::move(lhs)), rhs_(std::move(rhs))
+        , out_(make_buffer(sizeof(int64_t))), l_buffer_(make_buffer(sizeof(int64_t)))
+        , r_buffer_(make_buffer(sizeof(int64_t)))
+    {
+        if (not is_numeric(lhs_->type) or not is_numeric(rhs_->type))
+            errx(EXIT_FAILURE, "Operands of arithmetic must be numeric");
+        const bool is_integral = lhs_->type == Attribute::TY_Int and rhs_->type == Attribute::TY_Int;
+        type = is_integral ? Attribute::TY_Int : Attribute::TY_Double;
+        elem_size = sizeof(int64_t);
+    }
+
+    Vector eval(const Batch &batch) {
+        const Vector l = lhs_->eval(batch);
+        const Vector r = rhs_->eval(batch);
+        const bool is_constant = type == Attribute::TY_Int ? compute<int64_t>(l, r, batch.size)
+                                                           : compute<double>(l, r, batch.size);
+        return make_vector(out_.data(), is_constant);
+    }
+
+    private:
+    template<typename T>
+    bool compute(const Vector &l, const Vector &r, std::size_t n) {
+        T *out = reinterpret_cast<T*>(out_.data());
+        T *l_buffer = reinterpret_cast<T*>(l_buffer_.data());
+        T *r_buffer = reinterpret_cast<T*>(r_buffer_.data());
+        switch (op_) {
+            case Expr::OP_Add: return binary(l, r, n, l_buffer, r_buffer, out, std::plus<T>());
+            case Expr::OP_Sub: return binary(l, r, n, l_buffer, r_buffer, out, std::minus<T>());
+            case Expr::OP_Mul: return binary(l, r, n, l_buffer, r_buffer, out, std::multiplies<T>());
+            case Expr::OP_Div:
+                /* Rows that are not selected are evaluated, too.  Avoid trapping on their integer division by 0. */
+                if constexpr (std::is_integral<T>::value)
+                    return binary(l, r, n, l_buffer, r_buffer, out, [](T a, T b) { return b ? a / b : 0; });
+                else
+                    return binary(l, r, n, l_buffer, r_buffer, out, std::divides<T>());
+            default: dbms_unreachable("not an arithmetic operation");
+        }
+    }
+
+    Expr::Operation op_;
+    std::unique_ptr<ExprEvaluator> lhs_;
+    std::unique_ptr<ExprEvaluator> rhs_;
+    std::vector<uint64_t> out_;
+    std::vector<uint64_t> l_buffer_;
+    std::vector<uint64_t> r_buffer_;
+};
+
+/** Returns the comparison that yields the same result as op with swapped operands. */
+Expr::Operation mirror(Expr::Operation op)
+{
+    switch (op) {
+        case Expr::OP_Lt: return Expr::OP_Gt;
+        case Expr::OP_Le: return Expr::OP_Ge;
+        case Expr::OP_Gt: return Expr::OP_Lt;
+        case Expr::OP_Ge: return Expr::OP_Le;
+        default: return op;
+    }
+}
+
+struct ComparisonEvaluator : ExprEvaluator
+{
+    ComparisonEvaluator(Expr::Operation op, std::unique_ptr<ExprEvaluator> lhs, std::unique_ptr<ExprEvaluator> rhs)
+        : op_(op), lhs_(std::move(lhs)), rhs_(std::move(rhs))
+        , out_(make_buffer(sizeof(uint8_t))), l_buffer_(make_buffer(sizeof(int64_t)))
+        , r_buffer_(make_buffer(sizeof(int64_t)))
+    {
+        const bool is_string = lhs_->type == Attribute::TY_Char and rhs_->type == Attribute::TY_Char;
+        if (not is_string and (not is_numeric(lhs_->type) or not is_numeric(rhs_->type)))
+            errx(EXIT_FAILURE, "Operands of comparison must both be numeric or strings");
+        type = Attribute::TY_Int;
+        elem_size = sizeof(uint8_t);
+        is_boolean = true;
+    }
+
+    Vector eval(const Batch &batch) {
+        Vector l = lhs_->eval(batch);
+        Vector r = rhs_->eval(batch);
+        Expr::Operation op = op_;
+        /* Move a single constant to the right hand side. */
+        if (l.is_constant and not r.is_constant) {
+            std::swap(l, r);
+            op = mirror(op);
+        }
+        const bool is_constant = l.is_constant and r.is_constant;
+        const std::size_t n = is_constant ? 1 : batch.size;
+        uint8_t *out = reinterpret_cast<uint8_t*>(out_.data());
+
+        if (l.type == Attribute::TY_Char) {
+            const char *a = l.as<char>();
+            const char *b = r.as<char>();
+            const std::size_t b_stride = r.is_constant ? 0 : r.elem_size;
+            dispatch_comparison(op, [&](auto cmp) {
+                for (std::size_t i = 0; i != n; ++i)
+                    out[i] = cmp(strcmp(a + i * l.elem_size, b + i * b_stride), 0);
+            });
+        } else if (not (r.is_constant and compare_native(l, r, op, n, out))) {
+            if (l.type == Attribute::TY_Int and r.type == Attribute::TY_Int)
+                compare<int64_t>(l, r, op, n, out);
+            else
+                compare<double>(l, r, op, n, out);
+        }
+        return make_vector(out, is_constant);
+    }
+
+    private:
+    /** Compares the values of l with the constant r in the type of the values of l, if r is representable in that
+     * type.  Returns false, if not. */
+    static bool compare_native(const Vector &l, const Vector &r, Expr::Operation op, std::size_t n, uint8_t *out) {
+        return dispatch_numeric(l.type, l.elem_size, [&](auto *type) {
+            using T = std::remove_pointer_t<decltype(type)>;
+            if (r.type != Attribute::TY_Int) return false;
+            const int64_t c = scalar<int64_t>(r);
+            if constexpr (std::is_integral<T>::value) {
+                if (c < int64_t(std::numeric_limits<T>::min()) or c > int64_t(std::numeric_limits<T>::max()))
+                    return false;
+            }
+            const T *a = l.as<T>();
+            const T b = T(c);
+            dispatch_comparison(op, [&](auto cmp) {
+                for (std::size_t i = 0; i != n; ++i)
+                    out[i] = cmp(a[i], b);
+            });
+            return true;
+        });
+    }
+
+    template<typename T>
+    void compare(const Vector &l, const Vector &r, Expr::Operation op, std::size_t n, uint8_t *out) {
+        T *l_buffer = reinterpret_cast<T*>(l_buffer_.data());
+        T *r_buffer = reinterpret_cast<T*>(r_buffer_.data());
+        dispatch_comparison(op, [&](auto cmp) {
+            binary(l, r, n, l_buffer, r_buffer, out, [cmp](T a, T b) -> uint8_t { return cmp(a, b); });
+        });
+    }
+
+    Expr::Operation op_;
+    std::unique_ptr<ExprEvaluator> lhs_;
+    std::unique_ptr<ExprEvaluator> rhs_;
+    std::vector<uint64_t> out_;
+    std::vector<uint64_t> l_buffer_;
+    std::vector<uint64_t> r_buffer_;
+};
+
+/** Returns the evaluator of a boolean for expr: expr itself if it is a boolean, otherwise whether expr is not 0. */
+std::unique_ptr<ExprEvaluator> predicate(std::unique_ptr<ExprEvaluator> expr)
+{
+    if (expr->is_boolean) return expr;
+    const Expr zero(0);
+    auto zero_eval = std::make_unique<ConstantEvaluator>(*zero.node);
+    return std::make_unique<ComparisonEvaluator>(Expr::OP_Ne, std::move(expr), std::move(zero_eval));
+}
+
+struct LogicalEvaluator : ExprEvaluator
+{
+    LogicalEvaluator(Expr::Operation op, std::unique_ptr<ExprEvaluator> lhs, std::unique_ptr<ExprEvaluator> rhs)
+        : op_(op), lhs_(predicate(std::move(lhs))), rhs_(rhs ? predicate(std::move(rhs)) : nullptr)
+        , out_(make_buffer(sizeof(uint8_t))), l_buffer_(make_buffer(sizeof(uint8_t)))
+        , r_buffer_(make_buffer(sizeof(uint8_t)))
+    {
+        type = Attribute::TY_Int;
+        elem_size = sizeof(uint8_t);
+        is_boolean = true;
+    }
+
+    Vector eval(const Batch &batch) {
+        const Vector l = lhs_->eval(batch);
+        uint8_t *out = reinterpret_cast<uint8_t*>(out_.data());
+        uint8_t *l_buffer = reinterpret_cast<uint8_t*>(l_buffer_.data());
+        uint8_t *r_buffer = reinterpret_cast<uint8_t*>(r_buffer_.data());
+        bool is_constant;
+        if (op_ == Expr::OP_Not) {
+            is_constant = l.is_constant;
+            const std::size_t n = is_constant ? 1 : batch.size;
+            const uint8_t *a = l.as<uint8_t>();
+            for (std::size_t i = 0; i != n; ++i)
+                out[i] = not a[i];
+        } else {
+            const Vector r = rhs_->eval(batch);
+            if (op_ == Expr::OP_And)
+                is_constant = binary(l, r, batch.size, l_buffer, r_buffer, out, std::bit_and<uint8_t>());
+            else
+                is_constant = binary(l, r, batch.size, l_buffer, r_buffer, out, std::bit_or<uint8_t>());
+        }
+        return make_vector(out, is_constant);
+    }
+
+    private:
+    Expr::Operation op_;
+    std::unique_ptr<ExprEvaluator> lhs_;
+    std::unique_ptr<ExprEvaluator> rhs_;
+    std::vector<uint64_t> out_;
+    std::vector<uint64_t> l_buffer_;
+    std::vector<uint64_t> r_buffer_;
+};
+
+struct LengthEvaluator : ExprEvaluator
+{
+    LengthEvaluator(std::unique_ptr<ExprEvaluator> arg) : arg_(std::move(arg)), out_(make_buffer(sizeof(int64_t))) {
+        if (arg_->type != Attribute::TY_Char)
+            errx(EXIT_FAILURE, "Operand of length must be a string");
+        type = Attribute::TY_Int;
+        elem_size = sizeof(int64_t);
+    }
+
+    Vector eval(const Batch &batch) {
+        const Vector v = arg_->eval(batch);
+        const std::size_t n = v.is_constant ? 1 : batch.size;
+        const char *str = v.as<char>();
+        for (std::size_t i = 0; i != n; ++i)
+            out_[i] = strnlen(str + i * v.elem_size, v.elem_size);
+        return make_vector(out_.data(), v.is_constant);
+    }
+
+    private:
+    std::unique_ptr<ExprEvaluator> arg_;
+    std::vector<uint64_t> out_;
+};
+
+struct StartsWithEvaluator : ExprEvaluator
+{
+    StartsWithEvaluator(std::unique_ptr<ExprEvaluator> str, std::unique_ptr<ExprEvaluator> prefix)
+        : str_(std::move(str)), prefix_(std::move(prefix)), out_(make_buffer(sizeof(uint8_t)))
+    {
+        if (str_->type != Attribute::TY_Char or prefix_->type != Attribute::TY_Char)
+            errx(EXIT_FAILURE, "Operands of starts_with must be strings");
+        type = Attribute::TY_Int;
+        elem_size = sizeof(uint8_t);
+        is_boolean = true;
+    }
+
+    Vector eval(const Batch &batch) {
+        const Vector s = str_->eval(batch);
+        const Vector p = prefix_->eval(batch);
+        const bool is_constant = s.is_constant and p.is_constant;
+        const std::size_t n = is_constant ? 1 : batch.size;
+        const std::size_t s_stride = s.is_constant ? 0 : s.elem_size;
+        const std::size_t p_stride = p.is_constant ? 0 : p.elem_size;
+        uint8_t *out = reinterpret_cast<uint8_t*>(out_.data());
+        for (std::size_t i = 0; i != n; ++i) {
+            const char *prefix = p.as<char>() + i * p_stride;
+            out[i] = strncmp(s.as<char>() + i * s_stride, prefix, strnlen(prefix, p.elem_size)) == 0;
+        }
+        return make_vector(out, is_constant);
+    }
+
+    private:
+    std::unique_ptr<ExprEvaluator> str_;
+    std::unique_ptr<ExprEvaluator> prefix_;
+    std::vector<uint64_t> out_;
+};
+
+/** Compiles the expression with root node to an evaluator on batches of schema. */
+std::unique_ptr<ExprEvaluator> compile(const ExprNode &node, const Schema &schema)
+{
+    switch (node.kind) {
+        case ExprNode::EX_Column:
+            return std::make_unique<ColumnEvaluator>(schema, node.name);
+
+        case ExprNode::EX_Constant:
+            return std::make_unique<ConstantEvaluator>(node);
+
+        case ExprNode::EX_Operation: {
+            auto lhs = compile(*node.args[0], schema);
+            auto rhs = node.args.size() > 1 ? compile(*node.args[1], schema) : nullptr;
+            switch (node.op) {
+                case Expr::OP_Add:
+                case Expr::OP_Sub:
+                case Expr::OP_Mul:
+                case Expr::OP_Div:
+                    return std::make_unique<ArithmeticEvaluator>(node.op, std::move(lhs), std::move(rhs));
+
+                case Expr::OP_Eq:
+                case Expr::OP_Ne:
+                case Expr::OP_Lt:
+                case Expr::OP_Le:
+                case Expr::OP_Gt:
+                case Expr::OP_Ge:
+                    return std::make_unique<ComparisonEvaluator>(node.op, std::move(lhs), std::move(rhs));
+
+                case Expr::OP_And:
+                case Expr::OP_Or:
+                case Expr::OP_Not:
+                    return std::make_unique<LogicalEvaluator>(node.op, std::move(lhs), std::move(rhs));
+
+                case Expr::OP_Length:
+                    return std::make_unique<LengthEvaluator>(std::move(lhs));
+
+                case Expr::OP_StartsWith:
+                    return std::make_unique<StartsWithEvaluator>(std::move(lhs), std::move(rhs));
+            }
+        }
+    }
+    dbms_unreachable("invalid expression");
+}
+
+Expr make_operation(Expr::Operation op, std::initializer_list<Expr> args)
+{
+    auto node = std::make_shared<ExprNode>();
+    node->kind = ExprNode::EX_Operation;
+    node->op = op;
+    for (auto &arg : args)
+        node->args.push_back(arg.node);
+    return Expr(node);
+}
+
+}
+
+Expr::Expr(int64_t value)
+{
+    auto node = std::make_shared<ExprNode>();
+    node->kind = ExprNode::EX_Constant;
+    memcpy(&node->constant, &value, sizeof(value));
+    node->value.type = Attribute::TY_Int;
+    node->value.elem_size = sizeof(value);
+    node->value.data = &node->constant;
+    node->value.is_constant = true;
+    this->node = node;
+}
+
+Expr::Expr(double value)
+{
+    auto node = std::make_shared<ExprNode>();
+    node->kind = ExprNode::EX_Constant;
+    memcpy(&node->constant, &value, sizeof(value));
+    node->value.type = Attribute::TY_Double;
+    node->value.elem_size = sizeof(value);
+    node->value.data = &node->constant;
+    node->value.is_constant = true;
+    this->node = node;
+}
+
+Expr::Expr(const char *value)
+{
+    auto node = std::make_shared<ExprNode>();
+    node->kind = ExprNode::EX_Constant;
+    node->str = value;
+    node->value.type = Attribute::TY_Char;
+    node->value.elem_size = node->str.size() + 1;
+    node->value.data = node->str.c_str();
+    node->value.is_constant = true;
+    this->node = node;
+}
+
+Expr dbms::col(const char *name)
+{
+    auto node = std::make_shared<ExprNode>();
+    node->kind = ExprNode::EX_Column;
+    node->name = name;
+    return Expr(node);
+}
+
+Expr dbms::operator+(Expr lhs, Expr rhs) { return make_operation(Expr::OP_Add, { lhs, rhs }); }
+Expr dbms::operator-(Expr lhs, Expr rhs) { return make_operation(Expr::OP_Sub, { lhs, rhs }); }
+Expr dbms::operator*(Expr lhs, Expr rhs) { return make_operation(Expr::OP_Mul, { lhs, rhs }); }
+Expr dbms::operator/(Expr lhs, Expr rhs) { return make_operation(Expr::OP_Div, { lhs, rhs }); }
+Expr dbms::operator==(Expr lhs, Expr rhs) { return make_operation(Expr::OP_Eq, { lhs, rhs }); }
+Expr dbms::operator!=(Expr lhs, Expr rhs) { return make_operation(Expr::OP_Ne, { lhs, rhs }); }
+Expr dbms::operator<(Expr lhs, Expr rhs) { return make_operation(Expr::OP_Lt, { lhs, rhs }); }
+Expr dbms::operator<=(Expr lhs, Expr rhs) { return make_operation(Expr::OP_Le, { lhs, rhs }); }
+Expr dbms::operator>(Expr lhs, Expr rhs) { return make_operation(Expr::OP_Gt, { lhs, rhs }); }
+Expr dbms::operator>=(Expr lhs, Expr rhs) { return make_operation(Expr::OP_Ge, { lhs, rhs }); }
+Expr dbms::operator&&(Expr lhs, Expr rhs) { return make_operation(Expr::OP_And, { lhs, rhs }); }
+Expr dbms::operator||(Expr lhs, Expr rhs) { return make_operation(Expr::OP_Or, { lhs, rhs }); }
+Expr dbms::operator!(Expr expr) { return make_operation(Expr::OP_Not, { expr }); }
+Expr dbms::length(Expr expr) { return make_operation(Expr::OP_Length, { expr }); }
+Expr dbms::starts_with(Expr expr, Expr prefix) { return make_operation(Expr::OP_StartsWith, { expr, prefix }); }
+
+
+/*======================================================================================================================
+ * Scan
+ *====================================================================================================================*/
+
+Scan::Scan(const ColumnStore &store, const Relation &relation, std::initializer_list<const char*> names,
+           std::size_t begin, std::size_t end)
+    : column_store_(&store), pos_(std::min(begin, store.size())), end_(std::min(end, store.size()))
+{
+    init(relation, names);
+    for (auto attr : attrs_)
+        cursors_.push_back(store.get_column(attr).cursor(pos_));
+}
+
+Scan::Scan(const RowStore &store, const Relation &relation, std::initializer_list<const char*> names,
+           std::size_t begin, std::size_t end)
+    : row_store_(&store), pos_(std::min(begin, store.size())), end_(std::min(end, store.size()))
+{
+    init(relation, names);
+}
+
+Scan::Scan(const ColumnStore &store, const Relation &relation, std::initializer_list<const char*> names,
+           std::vector<RowRange> ranges)
+    : Scan(store, relation, names, 0, 0)
+{
+    has_ranges_ = true;
+    ranges_ = std::move(ranges);
+    selection_.resize(BATCH_SIZE);
+}
+
+Scan::Scan(const ColumnStore &store, const Relation &relation, std::initializer_list<const char*> names,
+           Morsels &morsels, std::size_t worker)
+    : Scan(store, relation, names, 0, 0)
+{
+    morsels_ = &morsels;
+    worker_ = worker;
+}
+
+Scan::Scan(const RowStore &store, const Relation &relation, std::initializer_list<const char*> names,
+           Morsels &morsels, std::size_t worker)
+    : Scan(store, relation, names, 0, 0)
+{
+    morsels_ = &morsels;
+    worker_ = worker;
+}
+
+void Scan::init(const Relation &relation, std::initializer_list<const char*> names)
+{
+    for (auto name : names) {
+        if (not relation.has(name))
+            errx(EXIT_FAILURE, "Relation '%s' has no attribute '%s'", relation.name.c_str(), name);
+        const Attribute &attr = relation[name];
+        if (attr.type == Attribute::TY_Varchar)
+            errx(EXIT_FAILURE, "Scans of attribute '%s' of type Varchar are not supported", name);
+        attrs_.push_back(attr.offset());
+        schema_.push_back(attr);
+        buffers_.push_back(make_buffer(attr.size));
+    }
+}
+
+bool Scan::next_morsel()
+{
+    if (not morsels_) return false;
+    std::size_t begin, end;
+    do {
+        if (not morsels_->next(worker_, begin, end)) return false;
+        begin = std::min(begin, column_store_ ? column_store_->size() : row_store_->size());
+        end = std::min(end, column_store_ ? column_store_->size() : row_store_->size());
+    } while (begin == end);
+
+    /* Morsels of the worker's own stripe are consecutive, and the cursors are already in place.  Only reposition the
+     * cursors after stealing, as seeking within a compressed column may be expensive. */
+    if (column_store_ and begin != pos_) {
+        for (std::size_t i = 0; i != attrs_.size(); ++i)
+            cursors_[i] = column_store_->get_column(attrs_[i]).cursor(begin);
+    }
+    pos_ = begin;
+    end_ = end;
+    return true;
+}
+
+bool Scan::produce_runs()
+{
+    /* Runs pay off only if they are long: every produced run is decoded, gathered, and processed by the consumer like
+     * a row, but stands for many. */
+    constexpr std::size_t MIN_ROWS_PER_RUN = 3;
+    if (not column_store_ or attrs_.empty() or has_ranges_) return false;
+    std::size_t num_runs = 0;
+    for (auto attr : attrs_) {
+        const ColumnBase &column = column_store_->get_column(attr);
+        if (not column.has_runs()) return false;
+        num_runs += column.num_runs();
+    }
+    if (num_runs * MIN_ROWS_PER_RUN > column_store_->size()) return false;
+
+    runs_ = true;
+    for (std::size_t i = 0; i != attrs_.size(); ++i) {
+        run_values_.push_back(make_buffer(schema_[i].size));
+        run_ends_.emplace_back(BATCH_SIZE);
+        run_indices_.emplace_back(BATCH_SIZE);
+    }
+    counts_.resize(BATCH_SIZE);
+    return true;
+}
+
+void Scan::next_runs(Batch &batch, std::size_t n)
+{
+    /* Limit the rows to read, such that the runs of all columns together fit into a batch.  The number of produced
+     * runs is at most the sum of the numbers of runs of the columns. */
+    const std::size_t max_runs = BATCH_SIZE / attrs_.size();
+    std::vector<ColumnCursor> cursors(cursors_);
+    std::vector<std::size_t> num_runs(attrs_.size());
+    std::vector<std::size_t> num_rows(attrs_.size());
+    for (std::size_t i = 0; i != attrs_.size(); ++i) {
+        const ColumnBase &column = column_store_->get_column(attrs_[i]);
+        num_runs[i] = column.read_runs(cursors[i], n, max_runs, run_values_[i].data(), run_ends_[i].data());
+        num_rows[i] = run_ends_[i][num_runs[i] - 1];
+        n = std::min(n, num_rows[i]);
+    }
+    for (std::size_t i = 0; i != attrs_.size(); ++i) {
+        if (num_rows[i] == n) {
+            cursors_[i] = cursors[i];
+        } else {
+            /* The runs read exceed the rows of the batch, read the runs anew. */
+            const ColumnBase &column = column_store_->get_column(attrs_[i]);
+            num_runs[i] = column.read_runs(cursors_[i], n, max_runs, run_values_[i].data(), run_ends_[i].data());
+        }
+    }
+
+    /* Split the rows at the end of every run of every column. */
+    std::vector<std::size_t> run(attrs_.size()); // the current run of each column
+    std::size_t num_produced = 0;
+    for (std::size_t begin = 0; begin != n; ++num_produced) {
+        std::size_t end = n;
+        for (std::size_t i = 0; i != attrs_.size(); ++i)
+            end = std::min<std::size_t>(end, run_ends_[i][run[i]]);
+        for (std::size_t i = 0; i != attrs_.size(); ++i) {
+            run_indices_[i][num_produced] = run[i];
+            run[i] += run_ends_[i][run[i]] == end;
+        }
+        counts_[num_produced] = end - begin;
+        begin = end;
+    }
+
+    batch.size = num_produced;
+    batch.select_all();
+    batch.counts = counts_.data();
+    batch.vectors.resize(attrs_.size());
+    for (std::size_t i = 0; i != attrs_.size(); ++i) {
+        Vector &v = batch.vectors[i];
+        v.type = schema_[i].type;
+        v.elem_size = schema_[i].size;
+        v.is_constant = false;
+        uint8_t *dst = reinterpret_cast<uint8_t*>(buffers_[i].data());
+        const uint16_t *indices = run_indices_[i].data();
+        copy_values(dst, v.elem_size, reinterpret_cast<const uint8_t*>(run_values_[i].data()), v.elem_size,
+                    v.elem_size, num_produced, [indices](std::size_t i) { return indices[i]; });
+        v.data = dst;
+    }
+    pos_ += n;
+}
+
+bool Scan::next_in_ranges(Batch &batch)
+{
+    /* Skip the rows up to the next range. */
+    const std::size_t size = column_store_->size();
+    while (range_ != ranges_.size() and std::min(ranges_[range_].second, size) <= pos_)
+        ++range_;
+    if (range_ == ranges_.size()) return false;
+    const std::size_t begin = std::max(pos_, ranges_[range_].first);
+    for (std::size_t i = 0; i != attrs_.size(); ++i)
+        column_store_->get_column(attrs_[i]).skip(cursors_[i], begin - pos_);
+    pos_ = begin;
+
+    /* Read a batch of rows up to the end of the last range, and select the rows within ranges. */
+    const std::size_t n = std::min(BATCH_SIZE, std::min(ranges_.back().second, size) - pos_);
+    std::size_t num_selected = 0;
+    for (std::size_t r = range_; r != ranges_.size() and ranges_[r].first < pos_ + n; ++r) {
+        const std::size_t end = std::min(ranges_[r].second, pos_ + n);
+        for (std::size_t row = std::max(ranges_[r].first, pos_); row < end; ++row)
+            selection_[num_selected++] = row - pos_;
+    }
+    read(batch, n);
+    if (num_selected != n) {
+        batch.selection = selection_.data();
+        batch.num_selected = num_selected;
+    }
+    return true;
+}
+
+bool Scan::next(Batch &batch)
+{
+    if (has_ranges_) return next_in_ranges(batch);
+    if (pos_ == end_ and not next_morsel()) return false;
+    if (runs_) {
+        next_runs(batch, end_ - pos_);
+        return true;
+    }
+    read(batch, std::min(BATCH_SIZE, end_ - pos_));
+    return true;
+}
+
+void Scan::read(Batch &batch, std::size_t n)
+{
+    batch.size = n;
+    batch.select_all();
+    batch.vectors.resize(attrs_.size());
+    for (std::size_t i = 0; i != attrs_.size(); ++i) {
+        Vector &v = batch.vectors[i];
+        v.type = schema_[i].type;
+        v.elem_size = schema_[i].size;
+        v.is_constant = false;
+        if (column_store_) {
+            v.data = column_store_->get_column(attrs_[i]).read(cursors_[i], n, buffers_[i].data());
+        } else {
+            /* Gather the values of the attribute from the rows. */
+            const uint8_t *rows = static_cast<const uint8_t*>(*row_store_->cbegin());
+            const uint8_t *src = rows + pos_ * row_store_->row_size() + row_store_->offset_of(attrs_[i]);
+            uint8_t *dst = reinterpret_cast<uint8_t*>(buffers_[i].data());
+            copy_values(dst, v.elem_size, src, row_store_->row_size(), v.elem_size, n,
+                        [](std::size_t i) { return i; });
+            v.data = dst;
+        }
+    }
+    pos_ += n;
+}
+
+
+/*======================================================================================================================
+ * select
+ *====================================================================================================================*/
+
+/** Returns true iff node compares the attribute name with a string constant by equality, inequality, or
+ * starts_with(), and sets str to the constant, is_prefix for starts_with(), and is_negated for inequality. */
+static bool is_string_match(const ExprNode &node, const char *name, const char *&str, bool &is_prefix,
+                            bool &is_negated)
+{
+    if (node.kind != ExprNode::EX_Operation) return false;
+    if (node.op != Expr::OP_Eq and node.op != Expr::OP_Ne and node.op != Expr::OP_StartsWith) return false;
+    const ExprNode *attribute = node.args[0].get();
+    const ExprNode *constant = node.args[1].get();
+    if (node.op != Expr::OP_StartsWith and attribute->kind == ExprNode::EX_Constant)
+        std::swap(attribute, constant);
+    if (attribute->kind != ExprNode::EX_Column or attribute->name != name) return false;
+    if (constant->kind != ExprNode::EX_Constant or constant->value.type != Attribute::TY_Char) return false;
+    str = constant->str.c_str();
+    is_prefix = node.op == Expr::OP_StartsWith;
+    is_negated = node.op == Expr::OP_Ne;
+    return true;
+}
+
+std::vector<RowRange> dbms::select(const ColumnStore &store, const Relation &relation, const char *name,
+                                   Expr predicate)
+{
+    if (not relation.has(name))
+        errx(EXIT_FAILURE, "Relation '%s' has no attribute '%s'", relation.name.c_str(), name);
+    const Attribute &attr = relation[name];
+    if (attr.type == Attribute::TY_Varchar)
+        errx(EXIT_FAILURE, "Selections on attribute '%s' of type Varchar are not supported", name);
+    const auto eval = ::predicate(compile(*predicate.node, Schema{ attr }));
+    const ColumnBase &column = store.get_column(attr.offset());
+
+    std::vector<RowRange> ranges;
+    auto add = [&ranges](std::size_t begin, std::size_t end) {
+        if (not ranges.empty() and ranges.back().second == begin) ranges.back().second = end;
+        else ranges.emplace_back(begin, end);
+    };
+
+    /* Evaluates the predicate for the n values and returns the mask of the values that satisfy it. */
+    std::vector<uint64_t> buffer = make_buffer(attr.size);
+    std::vector<uint8_t> mask(BATCH_SIZE);
+    Batch batch;
+    batch.vectors.resize(1);
+    batch.vectors[0].type = attr.type;
+    batch.vectors[0].elem_size = attr.size;
+    auto evaluate = [&](const void *values, std::size_t n) {
+        batch.size = n;
+        batch.select_all();
+        batch.vectors[0].data = values;
+        const Vector v = eval->eval(batch);
+        if (v.is_constant) std::fill_n(mask.begin(), n, *v.as<uint8_t>());
+        else std::copy_n(v.as<uint8_t>(), n, mask.begin());
+        return mask.data();
+    };
+
+    std::vector<uint32_t> ends(BATCH_SIZE);
+    ColumnCursor cursor = column.cursor(0);
+    std::size_t row = 0;
+    const char *str;
+    bool is_prefix, is_negated;
+    if (column.has_string_matching() and is_string_match(*predicate.node, name, str, is_prefix, is_negated)) {
+        /* Compare the string with the encoded elements, without decoding them. */
+        for (const std::size_t size = store.size(); row != size; ) {
+            const std::size_t n = column.match(cursor, BATCH_SIZE, str, is_prefix, mask.data());
+            for (std::size_t i = 0; i != n; ++i) {
+                if (mask[i] != is_negated)
+                    add(row + i, row + i + 1);
+            }
+            row += n;
+        }
+    } else if (const std::size_t dictionary_size = column.dictionary_size()) {
+        /* Evaluate the predicate once per dictionary entry, and select the runs of satisfying indices. */
+        std::vector<uint8_t> is_selected(dictionary_size);
+        for (std::size_t begin = 0; begin != dictionary_size; ) {
+            const std::size_t n = std::min(BATCH_SIZE, dictionary_size - begin);
+            column.read_dictionary(begin, n, buffer.data());
+            std::copy_n(evaluate(buffer.data(), n), n, is_selected.begin() + begin);
+            begin += n;
+        }
+        std::vector<uint32_t> indices(BATCH_SIZE);
+        while (std::size_t num_runs = column.read_index_runs(cursor, SIZE_MAX, BATCH_SIZE, indices.data(), ends.data())) {
+            for (std::size_t r = 0; r != num_runs; ++r) {
+                if (is_selected[indices[r]])
+                    add(row + (r ? ends[r - 1] : 0), row + ends[r]);
+            }
+            row += ends[num_runs - 1];
+        }
+    } else if (column.has_runs()) {
+        /* Evaluate the predicate once per run. */
+        while (std::size_t num_runs = column.read_runs(cursor, SIZE_MAX, BATCH_SIZE, buffer.data(), ends.data())) {
+            const uint8_t *selected = evaluate(buffer.data(), num_runs);
+            for (std::size_t r = 0; r != num_runs; ++r) {
+                if (selected[r])
+                    add(row + (r ? ends[r - 1] : 0), row + ends[r]);
+            }
+            row += ends[num_runs - 1];
+        }
+    } else {
+        for (const std::size_t size = store.size(); row != size; ) {
+            const std::size_t n = std::min(BATCH_SIZE, size - row);
+            const uint8_t *selected = evaluate(column.read(cursor, n, buffer.data()), n);
+            for (std::size_t i = 0; i != n; ++i) {
+                if (selected[i])
+                    add(row + i, row + i + 1);
+            }
+            row += n;
+        }
+    }
+    return ranges;
+}
+
+
+/*======================================================================================================================
+ * Filter
+ *====================================================================================================================*/
+
+Filter::Filter(Operator *child, Expr predicate)
+    : child_(child)
+    , predicate_(::predicate(compile(*predicate.node, child->schema())))
+{
+    schema_ = child_->schema();
+}
+
+Filter::~Filter() { }
+
+bool Filter::next(Batch &batch)
+{
+    while (child_->next(batch)) {
+        const Vector mask_vector = predicate_->eval(batch);
+        if (mask_vector.is_constant) {
+            if (*mask_vector.as<uint8_t>()) return true;
+            continue;
+        }
+
+        /* Refine the selection by the mask, without branching on the mask. */
+        const uint8_t *mask = mask_vector.as<uint8_t>();
+        std::size_t n = 0;
+        if (const uint16_t *selection = batch.selection) {
+            for (std::size_t i = 0; i != batch.num_selected; ++i) {
+                selection_[n] = selection[i];
+                n += mask[selection[i]];
+            }
+        } else {
+            for (std::size_t i = 0; i != batch.size; ++i) {
+                selection_[n] = i;
+                n += mask[i];
+            }
+        }
+        if (n == 0) continue;
+        if (n == batch.size) return true; // all rows remain selected
+        batch.selection = selection_;
+        batch.num_selected = n;
+        return true;
+    }
+    return false;
+}
+
+
+/*======================================================================================================================
+ * Project
+ *====================================================================================================================*/
+
+Project::Project(Operator *child, std::vector<std::pair<const char*, Expr>> exprs)
+    : child_(child)
+{
+    for (auto &e : exprs) {
+        exprs_.push_back(compile(*e.second.node, child_->schema()));
+        const ExprEvaluator &eval = *exprs_.back();
+        schema_.push_back(Attribute(eval.type, eval.elem_size, e.first));
+        buffers_.push_back(make_buffer(eval.elem_size));
+    }
+}
+
+Project::~Project() { }
+
+bool Project::next(Batch &batch)
+{
+    Batch input;
+    if (not child_->next(input)) return false;
+
+    batch.size = input.size;
+    batch.num_selected = input.num_selected;
+    batch.selection = input.selection;
+    batch.counts = input.counts;
+    batch.vectors.resize(exprs_.size());
+    for (std::size_t i = 0; i != exprs_.size(); ++i) {
+        Vector v = exprs_[i]->eval(input);
+        if (v.is_constant) {
+            /* Broadcast the constant, as operators expect a value per row. */
+            uint8_t *dst = reinterpret_cast<uint8_t*>(buffers_[i].data());
+            copy_values(dst, v.elem_size, v.as<uint8_t>(), 0, v.elem_size, input.size,
+                        [](std::size_t) { return 0; });
+            v.data = dst;
+            v.is_constant = false;
+        }
+        batch.vectors[i] = v;
+    }
+    return true;
+}
+
+
+/*======================================================================================================================
+ * HashAggregate
+ *====================================================================================================================*/
+
+/** Clears the bytes of key that follow the terminating NUL byte of a string.  ranges[w] masks the bytes of the w-th
+ * word of key that belong to the string, for the num_words words starting at the first word of the string.  Works on
+ * whole little endian words, without branching on the length of the string, which varies randomly from row to row. */
+static void clear_after_nul(uint64_t *key, const uint64_t *ranges, std::size_t num_words)
+{
+    constexpr uint64_t ONES = 0x0101010101010101UL;
+    constexpr uint64_t HIGHS = 0x8080808080808080UL;
+    uint64_t is_cleared = 0; // all ones, once the NUL byte was found in a previous word
+    for (std::size_t w = 0; w != num_words; ++w) {
+        /* Find the first NUL byte of the string in the word.  Bytes after the first NUL may be reported, too. */
+        const uint64_t bytes = key[w] | ~ranges[w];
+        const uint64_t nuls = (bytes - ONES) & ~bytes & HIGHS;
+        const uint64_t from_nul = -((nuls & -nuls) >> 7);
+        key[w] &= ~((is_cleared | from_nul) & ranges[w]);
+        is_cleared |= -uint64_t(nuls != 0);
+    }
+}
+
+static constexpr uint32_t EMPTY_SLOT = std::numeric_limits<uint32_t>::max();
+
+HashAggregate::HashAggregate(Operator *child, std::vector<const char*> group_by, std::vector<Aggregate> aggregates)
+    : child_(child)
+{
+    const Schema &input = child_->schema();
+    for (auto name : group_by) {
+        const std::size_t idx = index_of(input, name);
+        if (input[idx].type == Attribute::TY_Varchar)
+            errx(EXIT_FAILURE, "Grouping by attribute '%s' of type Varchar is not supported", name);
+        keys_.push_back(idx);
+        key_offsets_.push_back(key_size_);
+        key_size_ += input[idx].size;
+        schema_.push_back(input[idx]);
+        buffers_.push_back(make_buffer(input[idx].size));
+    }
+    /* Pad keys to whole words, such that they are hashed and compared word wise.  The padding remains 0. */
+    key_words_ = (key_size_ + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    batch_keys_.assign(BATCH_SIZE * key_words_, 0);
+
+    for (auto &aggregate : aggregates) {
+        exprs_.push_back(compile(*aggregate.expr.node, input));
+        const ExprEvaluator &eval = *exprs_.back();
+        if (aggregate.function != Aggregate::AG_Count and not is_numeric(eval.type))
+            errx(EXIT_FAILURE, "Aggregate '%s' of a non-numeric expression", aggregate.name.c_str());
+        const bool is_avg = aggregate.function == Aggregate::AG_Avg;
+        outputs_.push_back(Output{ functions_.size(), is_avg ? functions_.size() + 1 : NO_COUNT });
+        functions_.push_back(is_avg ? Aggregate::AG_Sum : aggregate.function);
+        is_double_.push_back(aggregate.function != Aggregate::AG_Count and eval.type != Attribute::TY_Int);
+        if (is_avg) {
+            exprs_.push_back(compile(*Expr(0).node, input));
+            functions_.push_back(Aggregate::AG_Count);
+            is_double_.push_back(false);
+        }
+        const bool is_double = is_avg or is_double_[outputs_.back().state];
+        schema_.push_back(Attribute(is_double ? Attribute::TY_Double : Attribute::TY_Int, sizeof(int64_t),
+                                    aggregate.name.c_str()));
+        buffers_.push_back(make_buffer(sizeof(int64_t)));
+    }
+
+    slots_.assign(1024, EMPTY_SLOT);
+    child_->produce_runs();
+}
+
+HashAggregate::~HashAggregate() { }
+
+uint32_t HashAggregate::find_group(const uint64_t *key, uint64_t hash)
+{
+    const std::size_t mask = slots_.size() - 1;
+    for (std::size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+        const uint32_t group = slots_[slot];
+        if (group == EMPTY_SLOT) {
+            /* Insert a new group. */
+            const uint32_t new_group = num_groups_++;
+            group_keys_.insert(group_keys_.end(), key, key + key_words_);
+            group_hashes_.push_back(hash);
+            for (std::size_t i = 0; i != functions_.size(); ++i) {
+                State state;
+                switch (functions_[i]) {
+                    case Aggregate::AG_Count:
+                    case Aggregate::AG_Sum:
+                        state.i = 0;
+                        if (is_double_[i]) state.d = 0;
+                        break;
+                    case Aggregate::AG_Min:
+                        if (is_double_[i]) state.d = std::numeric_limits<double>::infinity();
+                        else state.i = std::numeric_limits<int64_t>::max();
+                        break;
+                    case Aggregate::AG_Max:
+                        if (is_double_[i]) state.d = -std::numeric_limits<double>::infinity();
+                        else state.i = std::numeric_limits<int64_t>::min();
+                        break;
+                    case Aggregate::AG_Avg:
+                        dbms_unreachable("averages are computed from sums and counts");
+                }
+                states_.push_back(state);
+            }
+            slots_[slot] = new_group;
+            if (2 * num_groups_ > slots_.size()) grow();
+            return new_group;
+        }
+        if (group_hashes_[group] == hash and equal_keys(&group_keys_[group * key_words_], key, key_words_))
+            return group;
+    }
+}
+
+uint32_t HashAggregate::find_group(uint64_t key, uint64_t hash)
+{
+    /* Keys of a single word are equal iff their hashes are equal, hence the hashes need not be compared. */
+    const std::size_t mask = slots_.size() - 1;
+    for (std::size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+        const uint32_t group = slots_[slot];
+        if (group == EMPTY_SLOT) return find_group(&key, hash);
+        if (group_keys_[group] == key) return group;
+    }
+}
+
+void HashAggregate::grow()
+{
+    slots_.assign(2 * slots_.size(), EMPTY_SLOT);
+    const std::size_t mask = slots_.size() - 1;
+    for (uint32_t group = 0; group != num_groups_; ++group) {
+        std::size_t slot = group_hashes_[group] & mask;
+        while (slots_[slot] != EMPTY_SLOT)
+            slot = (slot + 1) & mask;
+        slots_[slot] = group;
+    }
+}
+
+void HashAggregate::merge(const HashAggregate &other)
+{
+    const std::size_t num_aggregates = functions_.size();
+    for (uint32_t g = 0; g != other.num_groups_; ++g) {
+        const uint32_t group = find_group(other.group_keys_.data() + g * key_words_, other.group_hashes_[g]);
+        for (std::size_t a = 0; a != num_aggregates; ++a) {
+            State &state = states_[group * num_aggregates + a];
+            const State &partial = other.states_[g * num_aggregates + a];
+            switch (functions_[a]) {
+                case Aggregate::AG_Count:
+                case Aggregate::AG_Sum:
+                    if (is_double_[a]) state.d += partial.d;
+                    else state.i += partial.i;
+                    break;
+                case Aggregate::AG_Min:
+                    if (is_double_[a]) state.d = std::min(state.d, partial.d);
+                    else state.i = std::min(state.i, partial.i);
+                    break;
+                case Aggregate::AG_Max:
+                    if (is_double_[a]) state.d = std::max(state.d, partial.d);
+                    else state.i = std::max(state.i, partial.i);
+                    break;
+                case Aggregate::AG_Avg:
+                    dbms_unreachable("averages are computed from sums and counts");
+            }
+        }
+    }
+}
+
+void HashAggregate::find_groups(const Batch &batch, uint32_t *groups)
+{
+    if (keys_.empty()) {
+        if (num_groups_ == 0) find_group(nullptr, 0);
+        std::fill_n(groups, batch.num_selected, 0);
+        return;
+    }
+
+    /* Assemble the keys of the selected rows.  Strings are padded with NUL bytes, such that equal keys are bytewise
+     * equal. */
+    const std::size_t key_stride = key_words_ * sizeof(uint64_t);
+    uint8_t *keys = reinterpret_cast<uint8_t*>(batch_keys_.data());
+    for (std::size_t k = 0; k != keys_.size(); ++k) {
+        const Vector &v = batch.vectors[keys_[k]];
+        uint8_t *dst = keys + key_offsets_[k];
+        copy_selected(dst, key_stride, v, batch);
+        if (v.type == Attribute::TY_Char) {
+            const std::size_t offset = key_offsets_[k];
+            const std::size_t first_word = offset / 8, num_words = (offset + v.elem_size + 7) / 8 - first_word;
+            std::vector<uint64_t> ranges(num_words);
+            for (std::size_t w = 0; w != num_words; ++w) {
+                const std::size_t begin = 8 * (first_word + w), end = begin + 8;
+                const std::size_t first = std::max(offset, begin) - begin;
+                const std::size_t last = std::min(offset + v.elem_size, end) - begin;
+                ranges[w] = (last == 8 ? ~0UL : (1UL << 8 * last) - 1) & ~((1UL << 8 * first) - 1);
+            }
+            for (std::size_t i = 0; i != batch.num_selected; ++i)
+                clear_after_nul(&batch_keys_[i * key_words_ + first_word], ranges.data(), num_words);
+        }
+    }
+
+    /* Hash all keys before probing, such that the hash computations do not wait for the probes. */
+    if (key_words_ == 1) {
+        const uint64_t *keys = batch_keys_.data();
+        for (std::size_t i = 0; i != batch.num_selected; ++i)
+            hashes_[i] = hash_key(&keys[i], 1);
+        for (std::size_t i = 0; i != batch.num_selected; ++i)
+            groups[i] = find_group(keys[i], hashes_[i]);
+        return;
+    }
+    for (std::size_t i = 0; i != batch.num_selected; ++i)
+        hashes_[i] = hash_key(&batch_keys_[i * key_words_], key_words_);
+    for (std::size_t i = 0; i != batch.num_selected; ++i)
+        groups[i] = find_group(&batch_keys_[i * key_words_], hashes_[i]);
+}
+
+template<typename T>
+void HashAggregate::update(std::size_t aggregate, const Batch &batch, const uint32_t *groups, const T *values)
+{
+    const std::size_t num_aggregates = functions_.size();
+    State *states = states_.data() + aggregate;
+    auto apply = [&](auto f) {
+        if (keys_.empty()) {
+            /* All rows belong to the single group.  Aggregate in a local, that the compiler keeps in a register. */
+            T &state = reinterpret_cast<T&>(states[0]);
+            T result = state;
+            if (const uint16_t *selection = batch.selection) {
+                for (std::size_t i = 0; i != batch.num_selected; ++i)
+                    result = f(result, values[selection[i]]);
+            } else {
+                for (std::size_t i = 0; i != batch.num_selected; ++i)
+                    result = f(result, values[i]);
+            }
+            state = result;
+            return;
+        }
+        for (std::size_t i = 0; i != batch.num_selected; ++i) {
+            const std::size_t row = batch.selection ? batch.selection[i] : i;
+            T &state = reinterpret_cast<T&>(states[groups[i] * num_aggregates]);
+            state = f(state, values[row]);
+        }
+    };
+    switch (functions_[aggregate]) {
+        case Aggregate::AG_Count: dbms_unreachable("counts are not computed from values");
+        case Aggregate::AG_Sum: return apply(std::plus<T>());
+        case Aggregate::AG_Min: return apply([](T a, T b) { return std::min(a, b); });
+        case Aggregate::AG_Max: return apply([](T a, T b) { return std::max(a, b); });
+        case Aggregate::AG_Avg: dbms_unreachable("averages are computed from sums and counts");
+    }
+}
+
+template<typename T>
+void HashAggregate::update_runs(std::size_t aggregate, const Batch &batch, const uint32_t *groups, const T *values)
+{
+    if (functions_[aggregate] != Aggregate::AG_Sum)
+        return update(aggregate, batch, groups, values); // minima and maxima do not depend on the lengths of runs
+    const std::size_t num_aggregates = functions_.size();
+    State *states = states_.data() + aggregate;
+    for (std::size_t i = 0; i != batch.num_selected; ++i) {
+        const std::size_t row = batch.selection ? batch.selection[i] : i;
+        T &state = reinterpret_cast<T&>(states[groups[i] * num_aggregates]);
+        state += values[row] * T(batch.counts[row]);
+    }
+}
+
+void HashAggregate::build()
+{
+    std::vector<uint32_t> groups(BATCH_SIZE);
+    std::vector<uint64_t> buffer = make_buffer(sizeof(int64_t));
+    Batch batch;
+    while (child_->next(batch)) {
+        find_groups(batch, groups.data());
+        for (std::size_t a = 0; a != functions_.size(); ++a) {
+            if (functions_[a] == Aggregate::AG_Count) {
+                if (keys_.empty() and not batch.counts) {
+                    states_[a].i += batch.num_selected; // all rows belong to the single group
+                } else if (const uint32_t *counts = batch.counts) {
+                    for (std::size_t i = 0; i != batch.num_selected; ++i)
+                        states_[groups[i] * functions_.size() + a].i += counts[batch.selection ? batch.selection[i] : i];
+                } else {
+                    for (std::size_t i = 0; i != batch.num_selected; ++i)
+                        ++states_[groups[i] * functions_.size() + a].i;
+                }
+                continue;
+            }
+            const Vector v = exprs_[a]->eval(batch);
+            if (is_double_[a]) {
+                const double *values = convert(v, batch.size, reinterpret_cast<double*>(buffer.data()));
+                if (batch.counts) update_runs(a, batch, groups.data(), values);
+                else update(a, batch, groups.data(), values);
+            } else {
+                const int64_t *values = convert(v, batch.size, reinterpret_cast<int64_t*>(buffer.data()));
+                if (batch.counts) update_runs(a, batch, groups.data(), values);
+                else update(a, batch, groups.data(), values);
+            }
+        }
+    }
+    /* Without grouping attributes, there is a single group even if there are no rows. */
+    if (keys_.empty() and num_groups_ == 0) find_group(nullptr, 0);
+}
+
+bool HashAggregate::next(Batch &batch)
+{
+    if (not built_) {
+        build();
+        built_ = true;
+    }
+    if (pos_ == num_groups_) return false;
+    const std::size_t n = std::min(BATCH_SIZE, num_groups_ - pos_);
+
+    batch.size = n;
+    batch.select_all();
+    batch.vectors.resize(schema_.size());
+    auto index = [this](std::size_t i) { return pos_ + i; };
+    for (std::size_t k = 0; k != keys_.size(); ++k) {
+        uint8_t *dst = reinterpret_cast<uint8_t*>(buffers_[k].data());
+        const uint8_t *src = reinterpret_cast<const uint8_t*>(group_keys_.data()) + key_offsets_[k];
+        copy_values(dst, schema_[k].size, src, key_words_ * sizeof(uint64_t), schema_[k].size, n, index);
+    }
+    const std::size_t num_states = functions_.size();
+    for (std::size_t a = 0; a != outputs_.size(); ++a) {
+        const Output &output = outputs_[a];
+        uint8_t *dst = reinterpret_cast<uint8_t*>(buffers_[keys_.size() + a].data());
+        if (output.count == NO_COUNT) {
+            const uint8_t *src = reinterpret_cast<const uint8_t*>(states_.data() + output.state);
+            copy_values(dst, sizeof(State), src, num_states * sizeof(State), sizeof(State), n, index);
+            continue;
+        }
+        double *avg = reinterpret_cast<double*>(dst);
+        for (std::size_t i = 0; i != n; ++i) {
+            const State *states = &states_[(pos_ + i) * num_states];
+            const double sum = is_double_[output.state] ? states[output.state].d : double(states[output.state].i);
+            avg[i] = sum / states[output.count].i;
+        }
+    }
+    for (std::size_t i = 0; i != schema_.size(); ++i) {
+        Vector &v = batch.vectors[i];
+        v.type = schema_[i].type;
+        v.elem_size = schema_[i].size;
+        v.data = buffers_[i].data();
+        v.is_constant = false;
+    }
+    pos_ += n;
+    return true;
+}
+
+
+/*======================================================================================================================
+ * ParallelAggregate
+ *====================================================================================================================*/
+
+ParallelAggregate::ParallelAggregate(std::size_t num_rows, Pipeline pipeline, std::vector<const char*> group_by,
+                                     std::vector<Aggregate> aggregates, ThreadPool &pool, std::size_t morsel_size)
+    : pipeline_(std::move(pipeline))
+    , group_by_(std::move(group_by))
+    , aggregates_(std::move(aggregates))
+    , pool_(pool)
+    , morsels_(num_rows, pool.num_workers(), morsel_size)
+    , partials_(pool.num_workers())
+{
+    /* Create the aggregate of worker 0 right away, to provide the schema. */
+    partials_[0] = std::make_unique<HashAggregate>(pipeline_(morsels_, 0), group_by_, aggregates_);
+    schema_ = partials_[0]->schema();
+}
+
+ParallelAggregate::~ParallelAggregate() { }
+
+void ParallelAggregate::build()
+{
+    pool_.run([this](std::size_t worker) {
+        if (not partials_[worker])
+            partials_[worker] = std::make_unique<HashAggregate>(pipeline_(morsels_, worker), group_by_, aggregates_);
+        partials_[worker]->build();
+        partials_[worker]->built_ = true;
+    });
+    /* A nested run() executes on worker 0 only, and the other workers create no aggregate. */
+    for (std::size_t w = 1; w != partials_.size(); ++w) {
+        if (partials_[w])
+            partials_[0]->merge(*partials_[w]);
+    }
+    partials_.resize(1);
+}
+
+bool ParallelAggregate::next(Batch &batch)
+{
+    if (not built_) {
+        build();
+        built_ = true;
+    }
+    return partials_[0]->next(batch);
+}
+
+
+/*======================================================================================================================
+ * Sort
+ *====================================================================================================================*/
+
+/** Materializes the selected rows of batch with schema at the end of rows, in the layout given by offsets. */
+static void materialize(std::vector<uint8_t> &rows, std::size_t row_size, const std::vector<std::size_t> &offsets,
+                        const Batch &batch)
+{
+    const std::size_t first = rows.size();
+    rows.resize(first + batch.num_selected * row_size);
+    for (std::size_t i = 0; i != batch.vectors.size(); ++i)
+        copy_selected(rows.data() + first + offsets[i], row_size, batch.vectors[i], batch);
+}
+
+/** Materializes all rows of child like materialize(), and appends the value of their attribute key to keys. */
+static void materialize(Operator &child, std::vector<uint8_t> &rows, std::size_t row_size,
+                        const std::vector<std::size_t> &offsets, std::size_t key, std::vector<int64_t> &keys)
+{
+    std::vector<int64_t> buffer(BATCH_SIZE);
+    Batch batch;
+    while (child.next(batch)) {
+        materialize(rows, row_size, offsets, batch);
+        const int64_t *values = convert(batch.vectors[key], batch.size, buffer.data());
+        for (std::size_t i = 0; i != batch.num_selected; ++i)
+            keys.push_back(values[batch.selection ? batch.selection[i] : i]);
+    }
+}
+
+/** Computes the offsets of the attributes of schema within a materialized row and returns the size of a row. */
+static std::size_t layout(const Schema &schema, std::vector<std::size_t> &offsets)
+{
+    std::size_t row_size = 0;
+    for (auto &attr : schema) {
+        offsets.push_back(row_size);
+        row_size += attr.size;
+    }
+    return row_size;
+}
+
+/** Produces a batch of the n materialized rows with the indices index(i).  The attributes of schema are stored in the
+ * vectors of the batch from index first on. */
+template<typename Index>
+static void produce(Batch &batch, const Schema &schema, const uint8_t *rows, std::size_t row_size,
+                    const std::vector<std::size_t> &offsets, std::vector<std::vector<uint64_t>> &buffers,
+                    std::size_t n, Index index, std::size_t first = 0)
+{
+    batch.size = n;
+    batch.select_all();
+    batch.vectors.resize(std::max(batch.vectors.size(), first + schema.size()));
+    for (std::size_t i = 0; i != schema.size(); ++i) {
+        uint8_t *dst = reinterpret_cast<uint8_t*>(buffers[first + i].data());
+        copy_values(dst, schema[i].size, rows + offsets[i], row_size, schema[i].size, n, index);
+        Vector &v = batch.vectors[first + i];
+        v.type = schema[i].type;
+        v.elem_size = schema[i].size;
+        v.data = dst;
+        v.is_constant = false;
+    }
+}
+
+Sort::Sort(Operator *child, std::initializer_list<Key> keys)
+    : child_(child)
+{
+    schema_ = child_->schema();
+    for (auto &key : keys) {
+        const std::size_t idx = index_of(schema_, key.name);
+        if (schema_[idx].type == Attribute::TY_Varchar)
+            errx(EXIT_FAILURE, "Sorting by attribute '%s' of type Varchar is not supported", key.name);
+        keys_.emplace_back(idx, key.ascending);
+    }
+    row_size_ = layout(schema_, offsets_);
+    for (auto &attr : schema_)
+        buffers_.push_back(make_buffer(attr.size));
+}
+
+void Sort::build()
+{
+    Batch batch;
+    while (child_->next(batch))
+        materialize(rows_, row_size_, offsets_, batch);
+    order_.resize(rows_.size() / std::max<std::size_t>(row_size_, 1));
+    std::iota(order_.begin(), order_.end(), 0);
+
+    /* Compares the rows with indices first and second by the key with index k.  Returns a negative number, zero, or a
+     * positive number, if the first row is less, equal, or greater. */
+    auto compare = [this](std::size_t k, uint32_t first, uint32_t second) {
+        const Attribute &attr = schema_[keys_[k].first];
+        const uint8_t *a = rows_.data() + first * row_size_ + offsets_[keys_[k].first];
+        const uint8_t *b = rows_.data() + second * row_size_ + offsets_[keys_[k].first];
+        if (attr.type == Attribute::TY_Char)
+            return strncmp(reinterpret_cast<const char*>(a), reinterpret_cast<const char*>(b), attr.size);
+        return dispatch_numeric(attr.type, attr.size, [&](auto *type) {
+            using T = std::remove_pointer_t<decltype(type)>;
+            T x, y;
+            memcpy(&x, a, sizeof(T));
+            memcpy(&y, b, sizeof(T));
+            return int(y < x) - int(x < y);
+        });
+    };
+    std::stable_sort(order_.begin(), order_.end(), [&](uint32_t first, uint32_t second) {
+        for (std::size_t k = 0; k != keys_.size(); ++k) {
+            const int cmp = compare(k, first, second);
+            if (cmp) return keys_[k].second ? cmp < 0 : cmp > 0;
+        }
+        return false;
+    });
+}
+
+bool Sort::next(Batch &batch)
+{
+    if (not built_) {
+        build();
+        built_ = true;
+    }
+    if (pos_ == order_.size()) return false;
+    const std::size_t n = std::min(BATCH_SIZE, order_.size() - pos_);
+    produce(batch, schema_, rows_.data(), row_size_, offsets_, buffers_, n,
+            [this](std::size_t i) { return order_[pos_ + i]; });
+    pos_ += n;
+    return true;
+}
+
+
+/*======================================================================================================================
+ * Limit
+ *====================================================================================================================*/
+
+Limit::Limit(Operator *child, std::size_t n)
+    : child_(child), remaining_(n)
+{
+    schema_ = child_->schema();
+}
+
+bool Limit::next(Batch &batch)
+{
+    if (remaining_ == 0 or not child_->next(batch)) return false;
+    if (batch.num_selected > remaining_) {
+        if (not batch.selection) batch.size = remaining_;
+        batch.num_selected = remaining_;
+    }
+    remaining_ -= batch.num_selected;
+    return true;
+}
+
+
+/*======================================================================================================================
+ * HashJoin
+ *====================================================================================================================*/
+
+static constexpr uint32_t NO_ROW = std::numeric_limits<uint32_t>::max();
+static constexpr uint32_t NEXT_PROBE_ROW = NO_ROW - 1;
+
+HashJoin::HashJoin(Operator *build, Operator *probe, const char *build_key, const char *probe_key)
+    : build_(build)
+    , probe_(probe)
+    , build_key_(index_of(build->schema(), build_key))
+    , probe_key_(index_of(probe->schema(), probe_key))
+    , probe_keys_(BATCH_SIZE)
+    , match_(NEXT_PROBE_ROW)
+{
+    if (build_->schema()[build_key_].type != Attribute::TY_Int or probe_->schema()[probe_key_].type != Attribute::TY_Int)
+        errx(EXIT_FAILURE, "Join attributes must be integers");
+    schema_ = build_->schema();
+    schema_.insert(schema_.end(), probe_->schema().begin(), probe_->schema().end());
+    row_size_ = layout(build_->schema(), offsets_);
+    for (auto &attr : schema_)
+        buffers_.push_back(make_buffer(attr.size));
+}
+
+void HashJoin::build()
+{
+    materialize(*build_, rows_, row_size_, offsets_, build_key_, row_keys_);
+
+    /* Chain the rows of each slot, such that a probe visits the rows in the order of the build child. */
+    const std::size_t num_rows = row_keys_.size();
+    slots_.assign(ceil_to_pow2(std::max<std::size_t>(2 * num_rows, 2)), NO_ROW);
+    next_.resize(num_rows);
+    const std::size_t mask = slots_.size() - 1;
+    for (std::size_t row = num_rows; row-- != 0; ) {
+        const std::size_t slot = Murmur3{}(uint64_t(row_keys_[row])) & mask;
+        next_[row] = slots_[slot];
+        slots_[slot] = row;
+    }
+}
+
+bool HashJoin::next(Batch &batch)
+{
+    if (not built_) {
+        build();
+        built_ = true;
+    }
+
+    /* Collect pairs of matching rows.  A produced batch holds probe rows of a single batch of the probe child. */
+    std::size_t n = 0;
+    const std::size_t mask = slots_.size() - 1;
+    while (n != BATCH_SIZE) {
+        if (probe_pos_ == probe_batch_.num_selected) {
+            if (n) break;
+            if (not probe_->next(probe_batch_)) return false;
+            const Vector &keys = probe_batch_.vectors[probe_key_];
+            const int64_t *converted = convert(keys, probe_batch_.size, probe_keys_.data());
+            if (converted != probe_keys_.data())
+                std::copy_n(converted, probe_batch_.size, probe_keys_.data());
+            probe_pos_ = 0;
+            match_ = NEXT_PROBE_ROW;
+            continue;
+        }
+
+        const std::size_t row = probe_batch_.selection ? probe_batch_.selection[probe_pos_] : probe_pos_;
+        const int64_t key = probe_keys_[row];
+        if (match_ == NEXT_PROBE_ROW)
+            match_ = slots_[Murmur3{}(uint64_t(key)) & mask];
+        for (; match_ != NO_ROW and n != BATCH_SIZE; match_ = next_[match_]) {
+            if (row_keys_[match_] == key) {
+                build_rows_[n] = match_;
+                probe_rows_[n] = row;
+                ++n;
+            }
+        }
+        if (match_ != NO_ROW) break; // the batch is full, continue with the current probe row
+        ++probe_pos_;
+        match_ = NEXT_PROBE_ROW;
+    }
+
+    const std::size_t num_build = build_->schema().size();
+    produce(batch, build_->schema(), rows_.data(), row_size_, offsets_, buffers_, n,
+            [this](std::size_t i) { return build_rows_[i]; });
+    batch.vectors.resize(schema_.size());
+    for (std::size_t i = num_build; i != schema_.size(); ++i) {
+        const Vector &src = probe_batch_.vectors[i - num_build];
+        uint8_t *dst = reinterpret_cast<uint8_t*>(buffers_[i].data());
+        copy_values(dst, src.elem_size, src.as<uint8_t>(), src.elem_size, src.elem_size, n,
+                    [this](std::size_t i) { return probe_rows_[i]; });
+        Vector &v = batch.vectors[i];
+        v = src;
+        v.data = dst;
+    }
+    return true;
+}
+
+
+/*======================================================================================================================
+ * RadixJoin
+ *====================================================================================================================*/
+
+namespace {
+
+/** A row within a partition. */
+struct PartitionEntry
+{
+    int64_t key;
+    uint32_t hash; ///< the bits of the hash of key above the bits of the partition
+    uint32_t row; ///< the index of the row
+};
+
+/** Partitions the rows with keys into 2^bits partitions by the lowest bits of the hashes of their keys.  Returns the
+ * entries of the rows ordered by partition, and sets bounds[p] to the index of the first entry of partition p.  Every
+ * worker of pool counts and scatters the rows of a contiguous chunk. */
+std::vector<PartitionEntry> partition(const std::vector<int64_t> &keys, unsigned bits, std::vector<std::size_t> &bounds,
+                                      ThreadPool &pool)
+{
+    const std::size_t num_partitions = std::size_t(1) << bits;
+    const std::size_t mask = num_partitions - 1;
+    const std::size_t num_chunks = pool.num_workers();
+    auto chunk_begin = [&](std::size_t chunk) { return keys.size() * chunk / num_chunks; };
+
+    /* Count the rows of each partition in each chunk. */
+    std::vector<std::size_t> positions(num_chunks * num_partitions);
+    pool.parallel_for(num_chunks, [&](std::size_t, std::size_t begin, std::size_t end) {
+        for (std::size_t chunk = begin; chunk != end; ++chunk) {
+            std::size_t *histogram = &positions[chunk * num_partitions];
+            for (std::size_t i = chunk_begin(chunk), e = chunk_begin(chunk + 1); i != e; ++i)
+                ++histogram[Murmur3{}(uint64_t(keys[i])) & mask];
+        }
+    }, 1);
+
+    /* Compute where each chunk writes the rows of each partition. */
+    bounds.resize(num_partitions + 1);
+    std::size_t offset = 0;
+    for (std::size_t p = 0; p != num_partitions; ++p) {
+        bounds[p] = offset;
+        for (std::size_t chunk = 0; chunk != num_chunks; ++chunk) {
+            const std::size_t count = positions[chunk * num_partitions + p];
+            positions[chunk * num_partitions + p] = offset;
+            offset += count;
+        }
+    }
+    bounds[num_partitions] = offset;
+
+    /* Scatter the rows to their partitions. */
+    std::vector<PartitionEntry> entries(keys.size());
+    pool.parallel_for(num_chunks, [&](std::size_t, std::size_t begin, std::size_t end) {
+        for (std::size_t chunk = begin; chunk != end; ++chunk) {
+            std::size_t *position = &positions[chunk * num_partitions];
+            for (std::size_t i = chunk_begin(chunk), e = chunk_begin(chunk + 1); i != e; ++i) {
+                const uint64_t hash = Murmur3{}(uint64_t(keys[i]));
+                entries[position[hash & mask]++] = PartitionEntry{ keys[i], uint32_t(hash >> bits), uint32_t(i) };
+            }
+        }
+    }, 1);
+    return entries;
+}
+
+}
+
+RadixJoin::RadixJoin(Operator *build, Operator *probe, const char *build_key, const char *probe_key, ThreadPool &pool,
+                     std::size_t partition_size)
+    : build_(build)
+    , probe_(probe)
+    , build_key_(index_of(build->schema(), build_key))
+    , probe_key_(index_of(probe->schema(), probe_key))
+    , pool_(pool)
+    , partition_size_(partition_size)
+{
+    if (build_->schema()[build_key_].type != Attribute::TY_Int or probe_->schema()[probe_key_].type != Attribute::TY_Int)
+        errx(EXIT_FAILURE, "Join attributes must be integers");
+    schema_ = build_->schema();
+    schema_.insert(schema_.end(), probe_->schema().begin(), probe_->schema().end());
+    build_row_size_ = layout(build_->schema(), build_offsets_);
+    probe_row_size_ = layout(probe_->schema(), probe_offsets_);
+    for (auto &attr : schema_)
+        buffers_.push_back(make_buffer(attr.size));
+}
+
+void RadixJoin::build()
+{
+    std::vector<int64_t> build_keys, probe_keys;
+    materialize(*build_, build_rows_, build_row_size_, build_offsets_, build_key_, build_keys);
+    materialize(*probe_, probe_rows_, probe_row_size_, probe_offsets_, probe_key_, probe_keys);
+
+    /* Choose the number of partitions, such that a partition of the build rows and its hash table, of an entry and
+     * about three words per row, fit into partition_size_ bytes.  Create some partitions per worker in any case, to
+     * balance the load. */
+    constexpr std::size_t BYTES_PER_ROW = sizeof(PartitionEntry) + 3 * sizeof(uint32_t);
+    const std::size_t num_workers = pool_.num_workers();
+    unsigned bits = 0;
+    while (bits < 16 and ((build_keys.size() * BYTES_PER_ROW >> bits) > partition_size_ or
+                          (std::size_t(1) << bits) < 4 * num_workers))
+        ++bits;
+
+    std::vector<std::size_t> build_bounds, probe_bounds;
+    const auto build_entries = partition(build_keys, bits, build_bounds, pool_);
+    const auto probe_entries = partition(probe_keys, bits, probe_bounds, pool_);
+
+    /* Join the partitions.  Every worker reuses its hash table, which chains the build rows of a slot. */
+    std::vector<std::vector<uint32_t>> heads(num_workers);
+    std::vector<std::vector<uint32_t>> next(num_workers);
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> matches(num_workers);
+    pool_.parallel_for(std::size_t(1) << bits, [&](std::size_t worker, std::size_t begin, std::size_t end) {
+        for (std::size_t p = begin; p != end; ++p) {
+            const PartitionEntry *build = build_entries.data() + build_bounds[p];
+            const std::size_t num_build = build_bounds[p + 1] - build_bounds[p];
+            if (num_build == 0) continue;
+            const std::size_t mask = ceil_to_pow2(std::max<std::size_t>(2 * num_build, 2)) - 1;
+            heads[worker].assign(mask + 1, NO_ROW);
+            next[worker].resize(num_build);
+            for (std::size_t i = num_build; i-- != 0; ) {
+                const std::size_t slot = build[i].hash & mask;
+                next[worker][i] = heads[worker][slot];
+                heads[worker][slot] = i;
+            }
+
+            for (std::size_t j = probe_bounds[p]; j != probe_bounds[p + 1]; ++j) {
+                const PartitionEntry &probe = probe_entries[j];
+                for (uint32_t i = heads[worker][probe.hash & mask]; i != NO_ROW; i = next[worker][i]) {
+                    if (build[i].key == probe.key)
+                        matches[worker].emplace_back(build[i].row, probe.row);
+                }
+            }
+        }
+    }, 1);
+
+    for (auto &m : matches)
+        matches_.insert(matches_.end(), m.begin(), m.end());
+}
+
+bool RadixJoin::next(Batch &batch)
+{
+    if (not built_) {
+        build();
+        built_ = true;
+    }
+    if (pos_ == matches_.size()) return false;
+    const std::size_t n = std::min(BATCH_SIZE, matches_.size() - pos_);
+    produce(batch, build_->schema(), build_rows_.data(), build_row_size_, build_offsets_, buffers_, n,
+            [this](std::size_t i) { return matches_[pos_ + i].first; });
+    produce(batch, probe_->schema(), probe_rows_.data(), probe_row_size_, probe_offsets_, buffers_, n,
+            [this](std::size_t i) { return matches_[pos_ + i].second; }, build_->schema().size());
+    pos_ += n;
+    return true;
+}
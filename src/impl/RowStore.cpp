@@ -1,5 +1,9 @@
 #include "impl/RowStore.hpp"
+
+#include "dbms/Memory.hpp"
+#include "dbms/Snapshot.hpp"
 #include <algorithm>
+#include <err.h>
 
 
 using namespace dbms;
@@ -25,10 +29,28 @@ std::size_t get_alignment_requirement(const Attribute &attr)
 
 RowStore::~RowStore()
 {
-    free(data_);
+    release_data();
     free(offsets_);
 }
 
+RowStore::RowStore(RowStore &&other)
+    : data_(other.data_)
+    , offsets_(other.offsets_)
+    , num_attributes_(other.num_attributes_)
+    , row_size_(other.row_size_)
+    , size_(other.size_)
+    , capacity_(other.capacity_)
+    , reserved_(other.reserved_)
+    , owns_data_(other.owns_data_)
+    , has_varchar_(other.has_varchar_)
+    , policy_(other.policy_)
+    , snapshot_(std::move(other.snapshot_))
+{
+    other.data_ = nullptr;
+    other.offsets_ = nullptr;
+    other.size_ = other.capacity_ = other.reserved_ = 0;
+}
+
 RowStore RowStore::Create_Naive(const Relation &relation)
 {
     RowStore row_store;
@@ -57,6 +79,7 @@ RowStore RowStore::Create_Naive(const Relation &relation)
 
             case Attribute::TY_Varchar:
                 elem_size = elem_alignment = sizeof(void*);
+                row_store.has_varchar_ = true;
                 break;
 
             default: dbms_unreachable("unknown attribute type");
@@ -123,6 +146,7 @@ RowStore RowStore::Create_Optimized(const Relation &relation)
 
             case Attribute::TY_Varchar:
                 elem_size = elem_alignment = sizeof(void*);
+                row_store.has_varchar_ = true;
                 break;
 
             default: dbms_unreachable("unknown attribute type");
@@ -172,6 +196,7 @@ RowStore RowStore::Create_Explicit(const Relation &relation, std::size_t *order)
 
             case Attribute::TY_Varchar:
                 elem_size = elem_alignment = sizeof(void*);
+                row_store.has_varchar_ = true;
                 break;
 
             default: dbms_unreachable("unknown attribute type");
@@ -192,24 +217,119 @@ RowStore RowStore::Create_Explicit(const Relation &relation, std::size_t *order)
     return row_store;
 }
 
+RowStore RowStore::Create_Like(const RowStore &other)
+{
+    RowStore row_store;
+
+    row_store.num_attributes_ = other.num_attributes_;
+    row_store.offsets_ = static_cast<decltype(offsets_)>(malloc(other.num_attributes_ * sizeof(*offsets_)));
+    std::copy(other.offsets_, other.offsets_ + other.num_attributes_, row_store.offsets_);
+    row_store.row_size_ = other.row_size_;
+    row_store.has_varchar_ = other.has_varchar_;
+    row_store.policy_ = other.policy_;
+
+    return row_store;
+}
+
+RowStore RowStore::Open_Snapshot(const char *filename)
+{
+    RowStore row_store;
+    SnapshotReader in(filename, Snapshot::SK_RowStore);
+
+    row_store.num_attributes_ = in.get<uint64_t>();
+    row_store.offsets_ = static_cast<decltype(offsets_)>(malloc(row_store.num_attributes_ * sizeof(*offsets_)));
+    for (std::size_t i = 0; i != row_store.num_attributes_; ++i)
+        row_store.offsets_[i] = in.get<uint64_t>();
+    row_store.row_size_ = in.get<uint64_t>();
+    row_store.size_ = row_store.capacity_ = in.get<uint64_t>();
+
+    std::size_t num_bytes;
+    row_store.data_ = in.get_data(num_bytes);
+    if (num_bytes != row_store.size_ * row_store.row_size_)
+        in.layout_mismatch();
+    row_store.owns_data_ = false;
+    row_store.snapshot_ = in.mapping();
+
+    return row_store;
+}
+
+void RowStore::save_snapshot(const char *filename) const
+{
+    /* Check before the file is created, such that no partial snapshot remains. */
+    if (has_varchar_)
+        errx(EXIT_FAILURE, "Cannot save a snapshot of a RowStore with Varchar attributes to file '%s'", filename);
+    SnapshotWriter out(filename, Snapshot::SK_RowStore);
+    out.put<uint64_t>(num_attributes_);
+    for (std::size_t i = 0; i != num_attributes_; ++i)
+        out.put<uint64_t>(offsets_[i]);
+    out.put<uint64_t>(row_size_);
+    out.put<uint64_t>(size_);
+    out.put_data(data_, size_ * row_size_);
+    out.close();
+}
 
 void RowStore::reserve(std::size_t new_cap)
 {
-    if (new_cap > capacity()) {
-        void *new_data_ = realloc(data_, row_size_ * new_cap);
-        if (new_data_ != NULL) {
-            data_ = new_data_;
-            capacity_ = new_cap;
-        }
-    //TODO handle memory allocation failure
+    if (new_cap > capacity() and reserved_) {
+        /* The reservation is exhausted.  Move to a larger one. */
+        reserve_address_space(std::max(new_cap, 2 * reserved_));
+    } else if (new_cap > capacity() and not owns_data_) {
+        /* The rows reference a snapshot.  Copy them to memory of our own. */
+        void *new_data_ = allocate(row_size_ * new_cap, policy_);
+        memcpy(new_data_, data_, row_size_ * size_);
+        data_ = new_data_;
+        capacity_ = new_cap;
+        owns_data_ = true;
+    } else if (new_cap > capacity()) {
+        data_ = reallocate(data_, row_size_ * capacity_, row_size_ * new_cap, policy_);
+        capacity_ = new_cap;
     }
 }
 
+void RowStore::reserve_address_space(std::size_t max_cap)
+{
+    max_cap = std::max({ max_cap, capacity_, std::size_t(1) });
+    if (max_cap <= reserved_) return;
+
+    void *new_data = reserve_pages(max_cap * row_size_, policy_);
+    if (size_) memcpy(new_data, data_, size_ * row_size_);
+    release_data();
+    data_ = new_data;
+    capacity_ = reserved_ = max_cap;
+    owns_data_ = true;
+}
+
+void RowStore::set_memory_policy(const MemoryPolicy &policy)
+{
+    void *new_data = reserved_ ? reserve_pages(reserved_ * row_size_, policy) : allocate(capacity_ * row_size_, policy);
+    if (size_) memcpy(new_data, data_, size_ * row_size_);
+    release_data();
+    data_ = new_data;
+    owns_data_ = true;
+    policy_ = policy;
+}
+
+void RowStore::release_data()
+{
+    if (reserved_)
+        release_pages(data_, reserved_ * row_size_, policy_);
+    else if (owns_data_)
+        deallocate(data_, capacity_ * row_size_, policy_);
+}
+
 RowStore::iterator RowStore::append(std::size_t n_rows)
 {
-    size_ += n_rows;
-    if (size_ > capacity_) {
+    if (size_ + n_rows > capacity_)
         reserve(capacity_ + std::max(n_rows, capacity_ + (capacity_ / 2)));
-    } 
+    size_ += n_rows;
     return iterator(*this, size_ - n_rows);
 }
+
+void RowStore::append(const RowStore &other, std::size_t n_rows)
+{
+    assert(row_size_ == other.row_size_, "stores have different row layouts");
+    assert(n_rows <= other.size_, "not enough rows");
+    if (not n_rows) return;
+    auto it = append(n_rows);
+    memcpy(*it, other.data_, n_rows * row_size_);
+}
@@ -0,0 +1,156 @@
+#include "dbms/Scheduler.hpp"
+
+#include "dbms/assert.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <err.h>
+
+
+using namespace dbms;
+
+
+/** Whether the current thread is executing a task of a pool. */
+static thread_local bool is_worker = false;
+
+
+/*======================================================================================================================
+ * Morsels
+ *====================================================================================================================*/
+
+static uint64_t make_range(uint64_t front, uint64_t back) { return front << 32 | back; }
+
+Morsels::Morsels(std::size_t num_items, std::size_t num_workers, std::size_t morsel_size)
+    : num_items_(num_items)
+    , num_workers_(std::max<std::size_t>(num_workers, 1))
+    , morsel_size_(std::max<std::size_t>(morsel_size, 1))
+    , stripes_(new Stripe[num_workers_])
+{
+    const std::size_t num_morsels = (num_items_ + morsel_size_ - 1) / morsel_size_;
+    assert(num_morsels < std::size_t(1) << 32, "too many morsels");
+    for (std::size_t w = 0; w != num_workers_; ++w) {
+        const uint64_t front = num_morsels * w / num_workers_;
+        const uint64_t back = num_morsels * (w + 1) / num_workers_;
+        stripes_[w].range.store(make_range(front, back), std::memory_order_relaxed);
+    }
+}
+
+bool Morsels::claim(Stripe &stripe, bool from_front, std::size_t &morsel)
+{
+    uint64_t range = stripe.range.load(std::memory_order_relaxed);
+    for (;;) {
+        const uint64_t front = range >> 32;
+        const uint64_t back = range & 0xffffffff;
+        if (front == back) return false;
+        const uint64_t claimed = from_front ? make_range(front + 1, back) : make_range(front, back - 1);
+        if (stripe.range.compare_exchange_weak(range, claimed, std::memory_order_relaxed)) {
+            morsel = from_front ? front : back - 1;
+            return true;
+        }
+    }
+}
+
+bool Morsels::next(std::size_t worker, std::size_t &begin, std::size_t &end)
+{
+    std::size_t morsel;
+    bool found = claim(stripes_[worker], true, morsel);
+    for (std::size_t i = 1; not found and i != num_workers_; ++i)
+        found = claim(stripes_[(worker + i) % num_workers_], false, morsel);
+    if (not found) return false;
+    begin = morsel * morsel_size_;
+    end = std::min(begin + morsel_size_, num_items_);
+    return true;
+}
+
+
+/*======================================================================================================================
+ * ThreadPool
+ *====================================================================================================================*/
+
+ThreadPool::ThreadPool(std::size_t num_workers)
+{
+    for (std::size_t w = 1; w < num_workers; ++w)
+        threads_.emplace_back(&ThreadPool::work, this, w);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        is_stopping_ = true;
+    }
+    task_available_.notify_all();
+    for (auto &thread : threads_)
+        thread.join();
+}
+
+void ThreadPool::work(std::size_t worker)
+{
+    is_worker = true;
+    uint64_t generation = 0;
+    for (;;) {
+        const std::function<void(std::size_t)> *task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            task_available_.wait(lock, [&]() { return is_stopping_ or generation_ != generation; });
+            if (is_stopping_) return;
+            generation = generation_;
+            task = task_;
+        }
+        (*task)(worker);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--num_running_ != 0) continue;
+        }
+        task_finished_.notify_one();
+    }
+}
+
+void ThreadPool::run(const std::function<void(std::size_t worker)> &task)
+{
+    if (is_worker or threads_.empty()) {
+        task(0);
+        return;
+    }
+
+    std::lock_guard<std::mutex> run_lock(run_mutex_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = &task;
+        num_running_ = threads_.size();
+        ++generation_;
+    }
+    task_available_.notify_all();
+
+    is_worker = true;
+    task(0);
+    is_worker = false;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    task_finished_.wait(lock, [this]() { return num_running_ == 0; });
+}
+
+void ThreadPool::parallel_for(std::size_t num_items, const std::function<void(std::size_t, std::size_t, std::size_t)> &f,
+                              std::size_t morsel_size)
+{
+    Morsels morsels(num_items, num_workers(), morsel_size);
+    run([&](std::size_t worker) {
+        std::size_t begin, end;
+        while (morsels.next(worker, begin, end))
+            f(worker, begin, end);
+    });
+}
+
+ThreadPool & ThreadPool::Default()
+{
+    static ThreadPool pool([]() -> std::size_t {
+        if (const char *env = getenv("DBMS_NUM_THREADS")) {
+            char *end;
+            const unsigned long n = strtoul(env, &end, 10);
+            if (*end or n == 0)
+                errx(EXIT_FAILURE, "Invalid number of threads '%s'", env);
+            return n;
+        }
+        return std::max(std::thread::hardware_concurrency(), 1U);
+    }());
+    return pool;
+}
@@ -0,0 +1,151 @@
+#include "dbms/Snapshot.hpp"
+
+#include <err.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+using namespace dbms;
+
+
+static uint64_t round_to_page(uint64_t n) { return (n + PAGESIZE - 1) / PAGESIZE * PAGESIZE; }
+
+
+/*======================================================================================================================
+ * SnapshotWriter
+ *====================================================================================================================*/
+
+SnapshotWriter::SnapshotWriter(const char *filename, Snapshot::Kind kind)
+    : filename_(nonnull(filename))
+    , file_(fopen(filename, "wb"))
+    , kind_(kind)
+    , offset_(round_to_page(sizeof(Snapshot::Header)))
+{
+    if (not file_)
+        err(EXIT_FAILURE, "Failed to open file '%s'", filename_);
+}
+
+SnapshotWriter::~SnapshotWriter()
+{
+    if (file_) close();
+}
+
+void SnapshotWriter::put_string(const char *str)
+{
+    const uint64_t len = strlen(str);
+    put(len);
+    metadata_.insert(metadata_.end(), str, str + len);
+}
+
+void SnapshotWriter::put_data(const void *data, std::size_t size)
+{
+    put<uint64_t>(offset_);
+    put<uint64_t>(size);
+    if (fseek(file_, offset_, SEEK_SET) or fwrite(data, 1, size, file_) != size)
+        err(EXIT_FAILURE, "Failed to write to file '%s'", filename_);
+    offset_ = round_to_page(offset_ + size);
+}
+
+void SnapshotWriter::close()
+{
+    Snapshot::Header header;
+    memcpy(header.magic, Snapshot::MAGIC, sizeof(header.magic));
+    header.version = Snapshot::VERSION;
+    header.kind = kind_;
+    header.byte_order = Snapshot::BYTE_ORDER_MARK;
+    header.metadata_offset = offset_;
+    header.metadata_size = metadata_.size();
+
+    if (fseek(file_, offset_, SEEK_SET) or fwrite(metadata_.data(), 1, metadata_.size(), file_) != metadata_.size())
+        err(EXIT_FAILURE, "Failed to write to file '%s'", filename_);
+    if (fseek(file_, 0, SEEK_SET) or fwrite(&header, sizeof(header), 1, file_) != 1)
+        err(EXIT_FAILURE, "Failed to write to file '%s'", filename_);
+    if (fclose(file_))
+        err(EXIT_FAILURE, "Failed to close file '%s'", filename_);
+    file_ = nullptr;
+}
+
+
+/*======================================================================================================================
+ * SnapshotReader
+ *====================================================================================================================*/
+
+SnapshotReader::SnapshotReader(const char *filename, Snapshot::Kind kind)
+    : filename_(nonnull(filename))
+{
+    const int fd = open(filename_, O_RDONLY);
+    if (fd == -1)
+        err(EXIT_FAILURE, "Failed to open file '%s'", filename_);
+
+    struct stat st;
+    if (fstat(fd, &st))
+        err(EXIT_FAILURE, "Failed to stat file '%s'", filename_);
+    const std::size_t size = st.st_size;
+    if (size < sizeof(Snapshot::Header))
+        errx(EXIT_FAILURE, "File '%s' is not a snapshot", filename_);
+
+    /* Map the file privately and writable, such that an opened store can be modified in place (copy on write). */
+    void *addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED)
+        err(EXIT_FAILURE, "Failed to map file '%s'", filename_);
+    if (close(fd))
+        warn("Failed to close file '%s'", filename_);
+    mapping_ = std::shared_ptr<void>(addr, [size](void *addr) { munmap(addr, size); });
+
+    const char *base = static_cast<const char*>(addr);
+    Snapshot::Header header;
+    memcpy(&header, base, sizeof(header));
+    if (memcmp(header.magic, Snapshot::MAGIC, sizeof(header.magic)))
+        errx(EXIT_FAILURE, "File '%s' is not a snapshot", filename_);
+    if (header.version == __builtin_bswap32(Snapshot::VERSION) or
+        (header.version == Snapshot::VERSION and header.byte_order != Snapshot::BYTE_ORDER_MARK))
+        errx(EXIT_FAILURE, "Snapshot '%s' was written with a different byte order", filename_);
+    if (header.version != Snapshot::VERSION)
+        errx(EXIT_FAILURE, "Snapshot '%s' has unsupported version %u", filename_, header.version);
+    if (header.kind != kind)
+        errx(EXIT_FAILURE, "Snapshot '%s' contains the wrong kind of store", filename_);
+    if (header.metadata_offset > size or header.metadata_size > size - header.metadata_offset)
+        errx(EXIT_FAILURE, "Snapshot '%s' is truncated", filename_);
+
+    data_size_ = header.metadata_offset;
+    pos_ = base + header.metadata_offset;
+    end_ = pos_ + header.metadata_size;
+}
+
+const char * SnapshotReader::next(std::size_t size)
+{
+    if (std::size_t(end_ - pos_) < size)
+        errx(EXIT_FAILURE, "Snapshot '%s' has corrupted metadata", filename_);
+    const char *p = pos_;
+    pos_ += size;
+    return p;
+}
+
+std::string SnapshotReader::get_string()
+{
+    const uint64_t len = get<uint64_t>();
+    return std::string(next(len), len);
+}
+
+void * SnapshotReader::get_data(std::size_t &size)
+{
+    const uint64_t offset = get<uint64_t>();
+    size = get<uint64_t>();
+    char *base = static_cast<char*>(mapping_.get());
+    if (offset > data_size_ or size > data_size_ - offset)
+        errx(EXIT_FAILURE, "Snapshot '%s' has corrupted metadata", filename_);
+    return base + offset;
+}
+
+void SnapshotReader::expect_string(const char *expected)
+{
+    if (get_string() != expected)
+        layout_mismatch();
+}
+
+void SnapshotReader::layout_mismatch() const
+{
+    errx(EXIT_FAILURE, "Snapshot '%s' does not match the expected layout", filename_);
+}
@@ -1,4 +1,6 @@
 #include "dbms/query.hpp"
+#include "dbms/Kernels.hpp"
+#include "dbms/Operator.hpp"
 #include "dbms/Store.hpp"
 #include "dbms/util.hpp"
 #include "impl/ColumnStore.hpp"
@@ -6,8 +8,9 @@
 #include "impl/RowStore.hpp"
 #include "impl/BPlusTree.hpp"
 #include "impl/HashTable.hpp"
-#include <unordered_map>
 #include <chrono>
+#include <cstring>
+#include <unordered_map>
 
 using namespace std::chrono;
 
@@ -15,6 +18,28 @@ namespace dbms {
 
 namespace query {
 
+/** Returns the string held by a Char<N>, which is not NUL terminated if it has N characters. */
+template<std::size_t N>
+static std::string to_string(const Char<N> &str) { return std::string(str.data, strnlen(str.data, N)); }
+
+/** Returns the slot of a shipmode in the counts of Q2, or -1 if the shipmode has no slot.  The first letters select
+ * the slot, the full string is compared to reject unknown shipmodes with the same first letters. */
+static int shipmode_slot(const Char<11> &mode)
+{
+    static constexpr const char *MODES[] = { "TRUCK", "MAIL", "AIR", "FOB", "SHIP", "REG AIR", "RAIL" };
+    int slot;
+    switch (mode.data[0]) {
+        case 'T': slot = 0; break;
+        case 'M': slot = 1; break;
+        case 'A': slot = 2; break;
+        case 'F': slot = 3; break;
+        case 'S': slot = 4; break;
+        case 'R': slot = mode.data[1] == 'E' ? 5 : 6; break;
+        default: return -1;
+    }
+    return strncmp(mode.data, MODES[slot], sizeof(mode.data)) == 0 ? slot : -1;
+}
+
 namespace milestone1 {
 
 /* Query 1
@@ -25,34 +50,23 @@ namespace milestone1 {
 
 uint64_t Q1(const RowStore &store)
 {
-  const uint32_t date_threshold = date_to_int(1998, 1, 1);
-  int64_t result = 0;
-
-  for (auto it = store.cbegin(), end = store.cend(); it != end; ++it) {
-      if (it.get<uint32_t>(11) < date_threshold)  {
-          result += (it.get<int64_t>(1) * (100 - it.get<int64_t>(5)) * (100 + it.get<int64_t>(3)));
-      }
-  }
-
-  return result/1000000;
+    const uint32_t date_threshold = date_to_int(1998, 1, 1);
+    if (store.size() == 0) return 0;
+    const int64_t result = sum_discounted_price(*store.cbegin(), store.row_size(), store.offset_of(11),
+                                                store.offset_of(1), store.offset_of(5), store.offset_of(3),
+                                                store.size(), date_threshold);
+    return result/1000000;
 }
 
 uint64_t Q1(const ColumnStore &store)
 {
     const uint32_t date_threshold = date_to_int(1998, 1, 1);
-    int64_t result = 0;
-
-    auto it_11 = store.get_column<uint32_t>(11).cbegin();
-    auto end_11 = store.get_column<uint32_t>(11).cend();
-    auto it_1 = store.get_column<int64_t>(1).cbegin();
-    auto it_5 = store.get_column<int64_t>(5).cbegin();
-    auto it_3 = store.get_column<int64_t>(3).cbegin();
-    
-    for (; it_11 != end_11; ++it_11, ++it_1, ++it_3, ++it_5) {
-        if (*it_11 < date_threshold)
-            result += *it_1  * (100 - *it_5) * (100 + *it_3);
-    }
-
+    const std::size_t size = store.size();
+    const int64_t result = sum_discounted_price(store.get_column<uint32_t>(11).fetch(0, size).data(),
+                                                store.get_column<int64_t>(1).fetch(0, size).data(),
+                                                store.get_column<int64_t>(5).fetch(0, size).data(),
+                                                store.get_column<int64_t>(3).fetch(0, size).data(),
+                                                size, date_threshold);
     return result/1000000;
 }
 
@@ -70,38 +84,20 @@ unsigned Q2(const RowStore &store)
     unsigned result = 0;
     
     std::vector<unsigned> mode_count{0, 0, 0, 0, 0, 0, 0};
+    std::unordered_map<std::string, unsigned> other_modes; ///< the counts of shipmodes not in mode_count
 
     for (auto it = store.cbegin(), end = store.cend(); it != end; ++it) {
-        switch (static_cast<char>((it.get<Char<11> >(13)).data[0])) {
-            case 'T':
-                ++mode_count[0];
-                break;
-            case 'M':
-                ++mode_count[1];
-                break;
-            case 'A':
-                ++mode_count[2];
-                break;
-            case 'F':
-                ++mode_count[3];
-                break;
-            case 'S':
-                ++mode_count[4];
-                break;
-            case 'R':
-                if (static_cast<char>(it.get<Char<11>>(13).data[1])  == 'E')
-                    ++mode_count[5];
-                else
-                    ++mode_count[6];
-                break;
-            default:
-                std::cout << it.get<Char<11>>(13) << std::endl;
-                exit(1);
-        }
+         const int slot = shipmode_slot(it.get<Char<11>>(13));
+        if (slot >= 0)
+            ++mode_count[slot];
+        else
+            ++other_modes[to_string(it.get<Char<11>>(13))];
     }
 
     for (auto it : mode_count)
         result = std::max(result, it);
+    for (auto &mode : other_modes)
+        result = std::max(result, mode.second);
 
     return result;
 }
@@ -110,41 +106,23 @@ unsigned Q2(const ColumnStore &store)
 {
     unsigned result = 0;
     std::vector<unsigned> mode_count{0, 0, 0, 0, 0, 0, 0};
+    std::unordered_map<std::string, unsigned> other_modes; ///< the counts of shipmodes not in mode_count
     auto it_13 = store.get_column<Char<11>>(13).cbegin();
     auto end_13 = store.get_column<Char<11>>(13).cend();
 
     while (it_13 != end_13) {
-       switch (static_cast<char>((*it_13).data[0])) {
-            case 'T':
-                ++mode_count[0];
-                break;
-            case 'M':
-                ++mode_count[1];
-                break;
-            case 'A':
-                ++mode_count[2];
-                break;
-            case 'F':
-                ++mode_count[3];
-                break;
-            case 'S':
-                ++mode_count[4];
-                break;
-            case 'R':
-                if (static_cast<char>((*it_13).data[1])  == 'E')
-                    ++mode_count[5];
-                else
-                    ++mode_count[6];
-                break;
-            default:
-                std::cout << *it_13 << std::endl;
-                exit(1);
-        }
+        const int slot = shipmode_slot(*it_13);
+        if (slot >= 0)
+            ++mode_count[slot];
+        else
+            ++other_modes[to_string(*it_13)];
        ++it_13;
     }
     
     for (auto it : mode_count)
         result = std::max(result, it);
+    for (auto &mode : other_modes)
+        result = std::max(result, mode.second);
 
     return result;
 }
@@ -157,41 +135,23 @@ unsigned Q2(const ColumnStore &store)
 {
     unsigned result = 0;
     std::vector<unsigned> mode_count{0, 0, 0, 0, 0, 0, 0};
+    std::unordered_map<std::string, unsigned> other_modes; ///< the counts of shipmodes not in mode_count
     auto it_13 = store.get_column<RLE<Char<11>>>(13).runs_begin();
     auto end_13 = store.get_column<RLE<Char<11>>>(13).runs_end();
 
     while (it_13 != end_13) {
-       switch (static_cast<char>((it_13->value).data[0])) {
-            case 'T':
-                mode_count[0] += it_13->count;
-                break;
-            case 'M':
-                mode_count[1] += it_13->count;
-                break;
-            case 'A':
-                mode_count[2] += it_13->count;
-                break;
-            case 'F':
-                mode_count[3] += it_13->count;
-                break;
-            case 'S':
-                mode_count[4] += it_13->count;
-                break;
-            case 'R':
-                if (static_cast<char>((it_13->value).data[1])  == 'E')
-                    mode_count[5] += it_13->count;
-                else
-                    mode_count[6] += it_13->count;
-                break;
-            default:
-                std::cout << *it_13 << std::endl;
-                exit(1);
-        }
+        const int slot = shipmode_slot(it_13->value);
+        if (slot >= 0)
+            mode_count[slot] += it_13->count;
+        else
+            other_modes[to_string(it_13->value)] += it_13->count;
        ++it_13;
     }
     
     for (auto it : mode_count)
         result = std::max(result, it);
+    for (auto &mode : other_modes)
+        result = std::max(result, mode.second);
 
     return result;
 }
@@ -199,41 +159,50 @@ unsigned Q2(const ColumnStore &store)
 unsigned Q3(const ColumnStore &store)
 {
     const uint32_t start_date = date_to_int(1993, 1, 1);
-    const uint32_t end_date = date_to_int(1993, 31, 12);
+    const uint32_t end_date = date_to_int(1993, 12, 31);
 
     unsigned result = 0;
 
-    auto it_11 = store.get_column<RLE<uint32_t>>(11).cbegin();
-    auto end_11 = store.get_column<RLE<uint32_t>>(11).cend();
-    auto it_15 = store.get_column<RLE<uint64_t>>(15).cbegin();
-    
+    /* Evaluate the predicate once per run of shipdate, and skip the quantities of rejected runs. */
+    auto it_11 = store.get_column<RLE<uint32_t>>(11).runs_cbegin();
+    auto end_11 = store.get_column<RLE<uint32_t>>(11).runs_cend();
+    auto it_15 = store.get_column<RLE<uint64_t>>(15).runs_cbegin();
+    std::size_t remaining_15 = store.size() ? it_15->count : 0; ///< the rows of the current run of quantity not passed
+
     while (it_11 != end_11) {
-        if (*it_11 >= start_date && *it_11 <= end_date)
-            result += *it_15;
-        ++it_11; ++it_15;
+        const bool is_selected = it_11->value >= start_date && it_11->value <= end_date;
+        for (std::size_t n = it_11->count; n != 0; ) {
+            const std::size_t count = std::min(n, remaining_15);
+            if (is_selected)
+                result += it_15->value * count;
+            n -= count;
+            remaining_15 -= count;
+            if (remaining_15 == 0 && n != 0)
+                remaining_15 = (++it_15)->count;
+        }
+        ++it_11;
     }
-    
+
     return result;
- 
 }
 
 unsigned Q4(const ColumnStore &store, uint32_t O, uint32_t L)
 {
-    unsigned result = 0;
-
-    auto it_4 = store.get_column<RLE<uint32_t>>(4).cbegin();
-    auto end_4 = store.get_column<RLE<uint32_t>>(4).cend();
-    auto it_12 = store.get_column<RLE<uint32_t>>(12).cbegin();
-    auto it_14 = store.get_column<Char<45>>(14).cbegin();
-
-    std::size_t store_size = store.size();
-
-    for (std::size_t i = 0; i < store_size; ++i) {
-        if (*it_4 == O && *it_12 == L)
-            return (unsigned)strlen(*it_14);
-        ++it_4; ++it_12; ++it_14;
+    /* Evaluate orderkey = O once per run, and decode linenumber and comment only for the rows of matching runs. */
+    const auto &linenumber = store.get_column<RLE<uint32_t>>(12);
+    const auto &comment = store.get_column<RLE<Char<45>>>(14);
+    auto it_4 = store.get_column<RLE<uint32_t>>(4).runs_cbegin();
+    auto end_4 = store.get_column<RLE<uint32_t>>(4).runs_cend();
+
+    for (std::size_t row = 0; it_4 != end_4; row += it_4->count, ++it_4) {
+        if (it_4->value != O) continue;
+        auto it_12 = linenumber.seek(row);
+        for (std::size_t i = 0; i != it_4->count; ++i, ++it_12) {
+            if (*it_12 == L)
+                return (unsigned)strnlen(*comment.seek(row + i), 45);
+        }
     }
-    return result;
+    return 0;
 }
 
 }
@@ -299,6 +268,232 @@ unsigned Q5(const ColumnStore &lineitem, const ColumnStore &orders)
 
 }
 
+namespace vectorized {
+
+/** Returns the value of the attribute with index attr of the first row produced by op, or value if op produces no
+ * rows. */
+template<typename T>
+static T first_value(Operator &op, std::size_t attr, T value)
+{
+    Batch batch;
+    if (op.next(batch)) {
+        const std::size_t row = batch.selection ? batch.selection[0] : 0;
+        value = batch.vectors[attr].as<T>()[row];
+    }
+    return value;
+}
+
+template<typename Store>
+static uint64_t Q1_impl(const Store &store, const Relation &relation)
+{
+    HashAggregate query(
+        new Filter(
+            new Scan(store, relation, { "shipdate", "extendedprice", "discount", "tax" }),
+            col("shipdate") < date_to_int(1998, 1, 1)
+        ),
+        {},
+        { Aggregate::Sum("revenue", col("extendedprice") * (100 - col("discount")) * (100 + col("tax"))) }
+    );
+    return first_value<int64_t>(query, 0, 0) / 1000000;
+}
+
+uint64_t Q1(const RowStore &store, const Relation &relation) { return Q1_impl(store, relation); }
+uint64_t Q1(const ColumnStore &store, const Relation &relation) { return Q1_impl(store, relation); }
+
+template<typename Store>
+static unsigned Q2_impl(const Store &store, const Relation &relation)
+{
+    Limit query(
+        new Sort(
+            new HashAggregate(new Scan(store, relation, { "shipmode" }), { "shipmode" }, { Aggregate::Count("num") }),
+            { { "num", false } }
+        ),
+        1
+    );
+    return first_value<int64_t>(query, 1, 0);
+}
+
+unsigned Q2(const RowStore &store, const Relation &relation) { return Q2_impl(store, relation); }
+unsigned Q2(const ColumnStore &store, const Relation &relation) { return Q2_impl(store, relation); }
+
+/* Query 3
+ * SELECT SUM(quantity)
+ * FROM lineitem
+ * WHERE shipdate BETWEEN DATE('1993-01-01') AND DATE('1993-12-31')
+ */
+unsigned Q3(const ColumnStore &store, const Relation &relation)
+{
+    HashAggregate query(
+        new Scan(store, relation, { "quantity" },
+                 select(store, relation, "shipdate",
+                        between(col("shipdate"), date_to_int(1993, 1, 1), date_to_int(1993, 12, 31)))),
+        {},
+        { Aggregate::Sum("quantity", col("quantity")) }
+    );
+    return first_value<int64_t>(query, 0, 0);
+}
+
+/* Query 4
+ * SELECT LENGTH(comment)
+ * FROM lineitem
+ * WHERE orderkey = O AND linenumber = L
+ */
+unsigned Q4(const ColumnStore &store, const Relation &relation, uint32_t O, uint32_t L)
+{
+    Project query(
+        new Limit(
+            new Filter(
+                new Scan(store, relation, { "linenumber", "comment" },
+                         select(store, relation, "orderkey", col("orderkey") == O)),
+                col("linenumber") == L
+            ),
+            1
+        ),
+        { { "length", length(col("comment")) } }
+    );
+    return first_value<int64_t>(query, 0, 0);
+}
+
+/* Query 5
+ * SELECT orderkey
+ * FROM (SELECT orderkey, SUM(extendedprice * tax) AS revenue
+ *       FROM lineitem
+ *       WHERE shipmode = 'AIR'
+ *       GROUP BY orderkey) AS l
+ *   JOIN orders ON l.orderkey = orders.orderkey
+ * WHERE orderstatus = 'F'
+ * ORDER BY revenue DESC
+ * LIMIT 1
+ */
+unsigned Q5(const ColumnStore &lineitem, const Relation &lineitem_relation,
+            const ColumnStore &orders, const Relation &orders_relation)
+{
+    Limit query(
+        new Sort(
+            new HashJoin(
+                new HashAggregate(
+                    new Filter(
+                        new Scan(lineitem, lineitem_relation, { "orderkey", "shipmode", "extendedprice", "tax" }),
+                        col("shipmode") == "AIR"
+                    ),
+                    { "orderkey" },
+                    { Aggregate::Sum("revenue", col("extendedprice") * col("tax")) }
+                ),
+                new Filter(
+                    new Scan(orders, orders_relation, { "orderkey", "orderstatus" }),
+                    col("orderstatus") == 'F'
+                ),
+                "orderkey", "orderkey"
+            ),
+            { { "revenue", false } }
+        ),
+        1
+    );
+    return first_value<uint32_t>(query, 0, 0);
+}
+
+}
+
+namespace parallel {
+
+template<typename Store>
+static uint64_t Q1_impl(const Store &store, const Relation &relation, ThreadPool &pool)
+{
+    ParallelAggregate query(
+        store.size(),
+        [&](Morsels &morsels, std::size_t worker) {
+            return new Filter(
+                new Scan(store, relation, { "shipdate", "extendedprice", "discount", "tax" }, morsels, worker),
+                col("shipdate") < date_to_int(1998, 1, 1)
+            );
+        },
+        {},
+        { Aggregate::Sum("revenue", col("extendedprice") * (100 - col("discount")) * (100 + col("tax"))) },
+        pool
+    );
+    return vectorized::first_value<int64_t>(query, 0, 0) / 1000000;
+}
+
+uint64_t Q1(const RowStore &store, const Relation &relation, ThreadPool &pool) { return Q1_impl(store, relation, pool); }
+uint64_t Q1(const ColumnStore &store, const Relation &relation, ThreadPool &pool) { return Q1_impl(store, relation, pool); }
+
+template<typename Store>
+static unsigned Q2_impl(const Store &store, const Relation &relation, ThreadPool &pool)
+{
+    Limit query(
+        new Sort(
+            new ParallelAggregate(
+                store.size(),
+                [&](Morsels &morsels, std::size_t worker) {
+                    return new Scan(store, relation, { "shipmode" }, morsels, worker);
+                },
+                { "shipmode" },
+                { Aggregate::Count("num") },
+                pool
+            ),
+            { { "num", false } }
+        ),
+        1
+    );
+    return vectorized::first_value<int64_t>(query, 1, 0);
+}
+
+unsigned Q2(const RowStore &store, const Relation &relation, ThreadPool &pool) { return Q2_impl(store, relation, pool); }
+unsigned Q2(const ColumnStore &store, const Relation &relation, ThreadPool &pool) { return Q2_impl(store, relation, pool); }
+
+unsigned Q3(const ColumnStore &store, const Relation &relation, ThreadPool &pool)
+{
+    ParallelAggregate query(
+        store.size(),
+        [&](Morsels &morsels, std::size_t worker) {
+            return new Filter(
+                new Scan(store, relation, { "shipdate", "quantity" }, morsels, worker),
+                between(col("shipdate"), date_to_int(1993, 1, 1), date_to_int(1993, 12, 31))
+            );
+        },
+        {},
+        { Aggregate::Sum("quantity", col("quantity")) },
+        pool
+    );
+    return vectorized::first_value<int64_t>(query, 0, 0);
+}
+
+/* The revenues of the orders are aggregated morsel-driven, and joined with the orders by a radix join.  Ties of the
+ * revenue are broken by the orderkey, as the radix join produces the joined rows in no particular order. */
+unsigned Q5(const ColumnStore &lineitem, const Relation &lineitem_relation,
+            const ColumnStore &orders, const Relation &orders_relation, ThreadPool &pool)
+{
+    Limit query(
+        new Sort(
+            new RadixJoin(
+                new ParallelAggregate(
+                    lineitem.size(),
+                    [&](Morsels &morsels, std::size_t worker) {
+                        return new Filter(
+                            new Scan(lineitem, lineitem_relation, { "orderkey", "shipmode", "extendedprice", "tax" },
+                                     morsels, worker),
+                            col("shipmode") == "AIR"
+                        );
+                    },
+                    { "orderkey" },
+                    { Aggregate::Sum("revenue", col("extendedprice") * col("tax")) },
+                    pool
+                ),
+                new Filter(
+                    new Scan(orders, orders_relation, { "orderkey", "orderstatus" }),
+                    col("orderstatus") == 'F'
+                ),
+                "orderkey", "orderkey", pool
+            ),
+            { { "revenue", false }, { "orderkey" } }
+        ),
+        1
+    );
+    return vectorized::first_value<uint32_t>(query, 0, 0);
+}
+
+}
+
 }
 
 }
@@ -2,6 +2,7 @@
 #include "dbms/Schema.hpp"
 #include "impl/ColumnStore.hpp"
 #include <cstdint>
+#include <cstring>
 #include <string>
 
 
@@ -80,4 +81,79 @@ TEST_CASE("ColumnStore/Naive", "[unit][milestone1]")
         CHECK(col_int8.capacity_in_bytes() >= 2 * old_cap * 8);
         REQUIRE(col_int8.size() == 2 * old_cap);
     }
+    SECTION("columns of another store can be appended") {
+        ColumnStore other = ColumnStore::Create_Naive(relation);
+        auto &col_int8 = other.get_column<int64_t>(2);
+        for (int64_t i = 0; i != 100; ++i)
+            col_int8.push_back(i);
+        store.get_column<int64_t>(2).push_back(-1);
+
+        store.get_column<int64_t>(2).append(col_int8, 42);
+        REQUIRE(store.get_column<int64_t>(2).size() == 43);
+
+        auto it = store.get_column<int64_t>(2).cbegin();
+        CHECK(*it++ == -1);
+        for (int64_t i = 0; i != 42; ++i)
+            CHECK(*it++ == i);
+    }
+
+    SECTION("appended Varchar columns own copies of the strings") {
+        {
+            ColumnStore other = ColumnStore::Create_Naive(relation);
+            for (unsigned i = 0; i != 10; ++i) {
+                other.get_column<Varchar>(5).push_back(std::to_string(i).c_str());
+                for (std::size_t c = 0; c != 5; ++c)
+                    memset(static_cast<GenericColumn&>(other.get_column(c)).append(1), 0, relation[c].size);
+            }
+            store.append(other, 7);
+        } // destroys other and its strings
+
+        auto &col_varchar = store.get_column<Varchar>(5);
+        REQUIRE(col_varchar.size() == 7);
+        unsigned i = 0;
+        for (auto elem : col_varchar)
+            CHECK(std::to_string(i++) == std::string(elem));
+    }
+
+    SECTION("columns grow in place within reserved address space") {
+        auto &col_int8 = store.get_column<int64_t>(2);
+        col_int8.push_back(42);
+        store.reserve_address_space(1000);
+        REQUIRE(col_int8.size() == 1);
+        CHECK(*col_int8.cbegin() == 42);
+
+        const int64_t *first = &*col_int8.cbegin();
+        for (int64_t i = 1; i != 1000; ++i)
+            col_int8.push_back(i);
+        CHECK(&*col_int8.cbegin() == first);
+
+        /* Growing beyond the reservation moves the elements. */
+        for (int64_t i = 1000; i != 3000; ++i)
+            col_int8.push_back(i);
+        REQUIRE(col_int8.size() == 3000);
+        auto it = col_int8.cbegin();
+        CHECK(*it++ == 42);
+        for (int64_t i = 1; i != 3000; ++i)
+            CHECK(*it++ == i);
+    }
+
+    SECTION("elements of a column can be fetched in batches") {
+        auto &col_int4 = store.get_column<uint32_t>(1);
+        for (uint32_t i = 0; i != 100; ++i)
+            col_int4.push_back(i);
+
+        auto batch = col_int4.fetch(10, 32);
+        REQUIRE(batch.size() == 32);
+        for (uint32_t i = 0; i != batch.size(); ++i)
+            CHECK(batch[i] == 10 + i);
+
+        /* A batch ends with the column. */
+        CHECK(col_int4.fetch(90, 32).size() == 10);
+        CHECK(col_int4.fetch(100, 32).empty());
+
+        uint32_t buffer[32];
+        REQUIRE(col_int4.fetch(80, 32, buffer) == 20);
+        for (uint32_t i = 0; i != 20; ++i)
+            CHECK(buffer[i] == 80 + i);
+    }
 }
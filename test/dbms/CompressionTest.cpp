@@ -3,7 +3,9 @@
 #include "impl/ColumnStore.hpp"
 #include "impl/Compression.hpp"
 #include <cstdint>
+#include <limits>
 #include <string>
+#include <vector>
 
 
 using namespace dbms;
@@ -77,6 +79,101 @@ TEST_CASE("RLE of int", "[unit][milestone2]")
     }
 }
 
+TEST_CASE("RLE/fetch", "[unit][milestone2]")
+{
+    Column<RLE<int>> rle_col;
+    std::vector<int> values;
+    for (int i = 0; i != 100; ++i) {
+        for (int j = 0; j <= i % 7; ++j) {
+            rle_col.push_back(i);
+            values.push_back(i);
+        }
+    }
+    REQUIRE(rle_col.size() == values.size());
+
+    SECTION("batches starting at an index") {
+        int buffer[50];
+        for (std::size_t start : { 0, 1, 3, 42, 300 }) {
+            REQUIRE(rle_col.fetch(start, 50, buffer) == 50);
+            for (std::size_t i = 0; i != 50; ++i)
+                CHECK(buffer[i] == values[start + i]);
+        }
+        CHECK(rle_col.fetch(values.size() - 5, 50, buffer) == 5);
+        CHECK(rle_col.fetch(values.size(), 50, buffer) == 0);
+    }
+
+    SECTION("random access") {
+        /* The column has more runs than are covered by a single entry of the run index. */
+        REQUIRE(rle_col.num_runs() == 100);
+        for (std::size_t i = 0; i != values.size(); ++i)
+            REQUIRE(rle_col.at(i) == values[i]);
+        CHECK(rle_col.seek(values.size()) == rle_col.cend());
+        auto it = rle_col.seek(values.size() - 1);
+        CHECK(*it == 99);
+        CHECK(++it == rle_col.cend());
+    }
+
+    SECTION("consecutive batches") {
+        int buffer[13];
+        std::vector<int> decoded;
+        auto it = rle_col.cbegin();
+        while (std::size_t n = rle_col.fetch(it, 13, buffer))
+            decoded.insert(decoded.end(), buffer, buffer + n);
+        CHECK(decoded == values);
+        CHECK(it == rle_col.cend());
+    }
+
+    SECTION("runs") {
+        int run_values[4];
+        uint32_t ends[4];
+        /* Start within a run, limited by the number of rows. */
+        ColumnCursor cursor = rle_col.cursor(2);
+        REQUIRE(rle_col.read_runs(cursor, 5, 4, run_values, ends) == 3);
+        CHECK(run_values[0] == 1);
+        CHECK(ends[0] == 1);
+        CHECK(run_values[1] == 2);
+        CHECK(ends[1] == 4);
+        CHECK(run_values[2] == 3);
+        CHECK(ends[2] == 5);
+        CHECK(cursor.idx == 7);
+
+        /* Limited by the number of runs. */
+        cursor = rle_col.cursor(0);
+        REQUIRE(rle_col.read_runs(cursor, 100, 2, run_values, ends) == 2);
+        CHECK(ends[1] == 3);
+        CHECK(cursor.idx == 3);
+
+        std::vector<int> decoded(3, 0);
+        decoded[1] = decoded[2] = 1;
+        while (std::size_t num_runs = rle_col.read_runs(cursor, 1000, 4, run_values, ends)) {
+            uint32_t begin = 0;
+            for (std::size_t r = 0; r != num_runs; ++r) {
+                decoded.insert(decoded.end(), ends[r] - begin, run_values[r]);
+                begin = ends[r];
+            }
+        }
+        CHECK(decoded == values);
+        CHECK(cursor.idx == values.size());
+    }
+
+    SECTION("skip") {
+        int buffer[3];
+        for (std::size_t start : { 0, 1, 3, 42 }) {
+            for (std::size_t n : { 0, 1, 2, 7, 100 }) {
+                ColumnCursor cursor = rle_col.cursor(start);
+                rle_col.skip(cursor, n);
+                CHECK(cursor.idx == start + n);
+                rle_col.read(cursor, 3, buffer);
+                for (std::size_t i = 0; i != 3; ++i)
+                    CHECK(buffer[i] == values[start + n + i]);
+            }
+        }
+        ColumnCursor cursor = rle_col.cursor(5);
+        rle_col.skip(cursor, values.size());
+        CHECK(cursor.idx == values.size());
+    }
+}
+
 TEST_CASE("Dictionary", "[unit][milestone2]")
 {
     const char *str0 = "Hello, World";
@@ -102,6 +199,71 @@ TEST_CASE("Dictionary", "[unit][milestone2]")
     CHECK(string_dict[2] == str2);
 }
 
+TEST_CASE("Dictionary/many values", "[unit][milestone2]")
+{
+    Dictionary<uint64_t> dict;
+    for (uint64_t i = 0; i != 100000; ++i)
+        REQUIRE(dict(i * 7919 % 100003) == i);
+    for (uint64_t i = 0; i != 100000; ++i)
+        REQUIRE(dict(i * 7919 % 100003) == i);
+    REQUIRE(dict.size() == 100000);
+    CHECK(dict.find(42 * 7919 % 100003) == 42);
+    CHECK(dict.find(100003) == dict.size());
+    CHECK_FALSE(dict.is_sorted());
+    for (uint64_t i = 0; i != 100000; ++i)
+        REQUIRE(dict[i] == i * 7919 % 100003);
+}
+
+TEST_CASE("Dictionary/sorted", "[unit][milestone2]")
+{
+    const Char<8> values[] = { "pear", "apple", "fig", "apple", "kiwi", "pear", "fig" };
+    auto dict = Dictionary<Char<8>>::Create_Sorted(values, 7);
+    REQUIRE(dict.size() == 4);
+    REQUIRE(dict.is_sorted());
+    CHECK(std::string(dict[0].data) == "apple");
+    CHECK(std::string(dict[1].data) == "fig");
+    CHECK(std::string(dict[2].data) == "kiwi");
+    CHECK(std::string(dict[3].data) == "pear");
+    CHECK(dict.find("kiwi") == 2);
+    CHECK(dict.lower_bound("fig") == 1);
+    CHECK(dict.upper_bound("fig") == 2);
+    CHECK(dict.lower_bound("grape") == 2);
+    CHECK(dict.upper_bound("zucchini") == 4);
+
+    /* Inserting a value that orders after all values keeps the dictionary sorted. */
+    CHECK(dict("quince") == 4);
+    CHECK(dict.is_sorted());
+    CHECK(dict("banana") == 5);
+    CHECK_FALSE(dict.is_sorted());
+
+    SECTION("columns") {
+        Column<Char<8>> plain;
+        for (auto &value : values)
+            plain.push_back(value);
+
+        Column<Dictionary<Char<8>>> col;
+        col.build(plain, plain.size(), true);
+        REQUIRE(col.size() == 7);
+        REQUIRE(col.get_dictionary().is_sorted());
+        CHECK(col.num_runs() == 7);
+
+        Column<RLE<Dictionary<Char<8>>>> rle_col;
+        rle_col.build(plain, plain.size(), true);
+        REQUIRE(rle_col.size() == 7);
+        REQUIRE(rle_col.get_dictionary().is_sorted());
+
+        Char<8> buffer[7];
+        REQUIRE(col.fetch(0, 7, buffer) == 7);
+        for (std::size_t i = 0; i != 7; ++i)
+            CHECK(std::string(buffer[i].data) == values[i].data);
+        REQUIRE(rle_col.fetch(0, 7, buffer) == 7);
+        for (std::size_t i = 0; i != 7; ++i)
+            CHECK(std::string(buffer[i].data) == values[i].data);
+        CHECK(*col.begin() == 3);
+        CHECK(rle_col.at(1) == values[1]);
+    }
+}
+
 TEST_CASE("Generic Dictionary Compression", "[unit][milestone2]")
 {
     const char *str0 = "Hello, World";
@@ -134,6 +296,12 @@ TEST_CASE("Generic Dictionary Compression", "[unit][milestone2]")
     CHECK(std::string(dict[*it++].data) == str1);
     CHECK(std::string(dict[*it++].data) == str2);
     CHECK(std::string(dict[*it++].data) == str1);
+
+    Char<42> buffer[8];
+    REQUIRE(col.fetch(4, 8, buffer) == 3);
+    CHECK(std::string(buffer[0].data) == str1);
+    CHECK(std::string(buffer[1].data) == str2);
+    CHECK(std::string(buffer[2].data) == str1);
 }
 
 TEST_CASE("RLE on Dictionary Compression", "[unit][milestone2]")
@@ -161,6 +329,10 @@ TEST_CASE("RLE on Dictionary Compression", "[unit][milestone2]")
     CHECK(col.size_in_bytes() == sizeof(decltype(col)::rle_type) * col.num_runs() + col.get_dictionary().size() * sizeof(Char<42>));
 
     auto &dict = col.get_dictionary();
+    CHECK(std::string(col.at(0).data) == str0);
+    CHECK(std::string(col.at(4).data) == str1);
+    CHECK(std::string(col.at(5).data) == str2);
+    CHECK(std::string(col.at(6).data) == str1);
 
     {
         auto it = col.begin();
@@ -187,4 +359,375 @@ TEST_CASE("RLE on Dictionary Compression", "[unit][milestone2]")
         CHECK(std::string(dict[run_it->value].data) == str1);
         CHECK(run_it->count == 1);
     }
+
+    {
+        Char<42> buffer[4];
+        auto it = col.cbegin();
+        REQUIRE(col.fetch(it, 4, buffer) == 4);
+        CHECK(std::string(buffer[0].data) == str0);
+        CHECK(std::string(buffer[3].data) == str1);
+        REQUIRE(col.fetch(it, 4, buffer) == 3);
+        CHECK(std::string(buffer[0].data) == str1);
+        CHECK(std::string(buffer[1].data) == str2);
+        CHECK(std::string(buffer[2].data) == str1);
+        CHECK(it == col.cend());
+
+        REQUIRE(col.fetch(2, 2, buffer) == 2);
+        CHECK(std::string(buffer[0].data) == str0);
+        CHECK(std::string(buffer[1].data) == str1);
+    }
+}
+
+TEST_CASE("BitPacked", "[unit][milestone2]")
+{
+    using column_type = Column<BitPacked<uint32_t>>;
+    constexpr std::size_t NUM_VALUES = 2 * column_type::BLOCK_SIZE + 100;
+
+    column_type col;
+    std::vector<uint32_t> values;
+    for (std::size_t i = 0; i != NUM_VALUES; ++i) {
+        /* The first block needs 10 bits, the second block 0 bits. */
+        values.push_back(i < column_type::BLOCK_SIZE ? i % 1000 : i < 2 * column_type::BLOCK_SIZE ? 0 : i);
+        col.push_back(values.back());
+    }
+    REQUIRE(col.size() == NUM_VALUES);
+    REQUIRE(col.num_blocks() == 2);
+    CHECK(col.bits(0) == 10);
+    CHECK(col.bits(1) == 0);
+    CHECK(col.size_in_bytes() < NUM_VALUES * sizeof(uint32_t) / 2);
+
+    for (std::size_t i = 0; i != NUM_VALUES; ++i)
+        REQUIRE(col.at(i) == values[i]);
+
+    SECTION("batches across blocks") {
+        uint32_t buffer[1000];
+        for (std::size_t start : { 0, 500, 1000, 2000, 2140 }) {
+            const std::size_t n = col.fetch(start, 1000, buffer);
+            REQUIRE(n == std::min<std::size_t>(1000, NUM_VALUES - start));
+            for (std::size_t i = 0; i != n; ++i)
+                REQUIRE(buffer[i] == values[start + i]);
+        }
+    }
+
+    SECTION("signed values") {
+        Column<BitPacked<int64_t>> signed_col;
+        for (int64_t i = 0; i != 2000; ++i)
+            signed_col.push_back(i - 1000);
+        /* Negative values are large unsigned integers, and take the whole width. */
+        CHECK(signed_col.bits(0) == 64);
+        for (std::size_t i = 0; i != 2000; ++i)
+            REQUIRE(signed_col.at(i) == int64_t(i) - 1000);
+    }
+}
+
+TEST_CASE("FOR", "[unit][milestone2]")
+{
+    constexpr std::size_t BLOCK_SIZE = Column<FOR<int64_t>>::BLOCK_SIZE;
+
+    SECTION("signed values") {
+        Column<FOR<int64_t>> col;
+        std::vector<int64_t> values;
+        for (std::size_t i = 0; i != 3 * BLOCK_SIZE + 1; ++i) {
+            values.push_back(int64_t(i % 100) - 50 + (i / BLOCK_SIZE) * 1000000000000);
+            col.push_back(values.back());
+        }
+        REQUIRE(col.num_blocks() == 3);
+        for (std::size_t b = 0; b != 3; ++b)
+            CHECK(col.bits(b) == 7);
+
+        int64_t buffer[3 * BLOCK_SIZE + 1];
+        ColumnCursor cursor = col.cursor(0);
+        const int64_t *decoded = static_cast<const int64_t*>(col.read(cursor, 3 * BLOCK_SIZE + 1, buffer));
+        CHECK(cursor.idx == 3 * BLOCK_SIZE + 1);
+        for (std::size_t i = 0; i != values.size(); ++i)
+            REQUIRE(decoded[i] == values[i]);
+    }
+
+    SECTION("narrow values") {
+        Column<FOR<uint8_t>> col;
+        for (std::size_t i = 0; i != 2 * BLOCK_SIZE; ++i)
+            col.push_back(250 + i % 6);
+        CHECK(col.bits(0) == 3);
+        for (std::size_t i = 0; i != 2 * BLOCK_SIZE; ++i)
+            REQUIRE(col.at(i) == 250 + i % 6);
+    }
+
+    SECTION("extreme values") {
+        Column<FOR<uint64_t>> col;
+        for (std::size_t i = 0; i != BLOCK_SIZE; ++i)
+            col.push_back(i % 2 ? std::numeric_limits<uint64_t>::max() : 0);
+        CHECK(col.bits(0) == 64);
+        for (std::size_t i = 0; i != BLOCK_SIZE; ++i)
+            REQUIRE(col.at(i) == (i % 2 ? std::numeric_limits<uint64_t>::max() : 0));
+    }
+}
+
+TEST_CASE("Delta", "[unit][milestone2]")
+{
+    constexpr std::size_t BLOCK_SIZE = Column<Delta<uint32_t>>::BLOCK_SIZE;
+    constexpr std::size_t NUM_VALUES = 3 * BLOCK_SIZE + 10;
+
+    Column<Delta<uint32_t>> col;
+    std::vector<uint32_t> values;
+    /* A sorted sequence with small steps, that jumps within the first block. */
+    uint32_t value = 1000000;
+    for (std::size_t i = 0; i != NUM_VALUES; ++i) {
+        value += i == 500 ? 1000000 : i % 3;
+        values.push_back(value);
+        col.push_back(value);
+    }
+    REQUIRE(col.size() == NUM_VALUES);
+    REQUIRE(col.num_blocks() == 3);
+    CHECK(col.bits(0) == 20);
+    CHECK(col.bits(1) == 2);
+    CHECK(col.size_in_bytes() < NUM_VALUES * sizeof(uint32_t) / 3);
+
+    for (std::size_t i = 0; i != NUM_VALUES; ++i)
+        REQUIRE(col.at(i) == values[i]);
+
+    SECTION("consecutive batches") {
+        for (std::size_t batch_size : { 1, 100, 1000, 5000 }) {
+            std::vector<uint32_t> buffer(batch_size);
+            ColumnCursor cursor = col.cursor(0);
+            while (cursor.idx != col.size()) {
+                const std::size_t start = cursor.idx;
+                const uint32_t *decoded = static_cast<const uint32_t*>(col.read(cursor, batch_size, buffer.data()));
+                for (std::size_t i = 0; i != cursor.idx - start; ++i)
+                    REQUIRE(decoded[i] == values[start + i]);
+            }
+        }
+    }
+
+    SECTION("skip and fetch") {
+        ColumnCursor cursor = col.cursor(10);
+        col.skip(cursor, 2000);
+        REQUIRE(cursor.idx == 2010);
+        uint32_t buffer[100];
+        col.read(cursor, 100, buffer);
+        for (std::size_t i = 0; i != 100; ++i)
+            REQUIRE(buffer[i] == values[2010 + i]);
+        REQUIRE(col.fetch(NUM_VALUES - 5, 100, buffer) == 5);
+        for (std::size_t i = 0; i != 5; ++i)
+            REQUIRE(buffer[i] == values[NUM_VALUES - 5 + i]);
+    }
+
+    SECTION("decreasing values") {
+        Column<Delta<uint8_t>> narrow;
+        Column<Delta<int64_t>> wide;
+        for (std::size_t i = 0; i != 2 * BLOCK_SIZE; ++i) {
+            narrow.push_back(uint8_t(255 - i));
+            wide.push_back(-int64_t(i) * 1000);
+        }
+        /* The first element of the column has no predecessor, and hence difference 0. */
+        CHECK(narrow.bits(0) == 1);
+        CHECK(narrow.bits(1) == 0);
+        CHECK(wide.bits(1) == 0);
+        uint8_t narrow_buffer[2 * BLOCK_SIZE];
+        int64_t wide_buffer[2 * BLOCK_SIZE];
+        REQUIRE(narrow.fetch(0, 2 * BLOCK_SIZE, narrow_buffer) == 2 * BLOCK_SIZE);
+        REQUIRE(wide.fetch(0, 2 * BLOCK_SIZE, wide_buffer) == 2 * BLOCK_SIZE);
+        for (std::size_t i = 0; i != 2 * BLOCK_SIZE; ++i) {
+            REQUIRE(narrow_buffer[i] == uint8_t(255 - i));
+            REQUIRE(wide_buffer[i] == -int64_t(i) * 1000);
+        }
+    }
+}
+
+TEST_CASE("Encoding selection", "[unit][milestone2]")
+{
+    constexpr std::size_t NUM_ROWS = 10000;
+    Relation relation("relation", {
+            Attribute::Int4("key"),
+            Attribute::Int8("quantity"),
+            Attribute::Char("mode", 11),
+            Attribute::Double("price"),
+            });
+    const char *modes[] = { "AIR", "MAIL", "RAIL", "SHIP", "TRUCK" };
+
+    ColumnStore store = ColumnStore::Create_Naive(relation);
+    auto &key = store.get_column<int32_t>(0);
+    auto &quantity = store.get_column<int64_t>(1);
+    auto &mode = store.get_column<Char<11>>(2);
+    auto &price = store.get_column<double>(3);
+    auto key_of = [](std::size_t i) { return 100000 + int32_t(i / 4); };
+    auto quantity_of = [](std::size_t i) { return int64_t(1 + (i * 7919) % 50); };
+    auto mode_of = [&](std::size_t i) { return Char<11>(modes[(i * 31) % 5]); };
+    auto price_of = [](std::size_t i) { return (i * 2654435761u % 1000003) / 7.; };
+    for (std::size_t i = 0; i != NUM_ROWS; ++i) {
+        key.push_back(key_of(i));
+        quantity.push_back(quantity_of(i));
+        mode.push_back(mode_of(i));
+        price.push_back(price_of(i));
+    }
+
+    auto analyses = analyze_columnstore(relation, store);
+    REQUIRE(analyses.size() == 4);
+    for (auto &analysis : analyses) {
+        REQUIRE(analysis.num_rows == NUM_ROWS);
+        REQUIRE(analysis.plain().encoding == EN_Plain);
+        CHECK(analysis.plain().size == NUM_ROWS * analysis.attr.size);
+    }
+    CHECK(analyses[0].encoding == EN_Delta);
+    CHECK((analyses[1].encoding == EN_BitPacked or analyses[1].encoding == EN_FOR));
+    CHECK(analyses[2].encoding == EN_Dictionary);
+    CHECK(analyses[3].encoding == EN_Plain);
+
+    SECTION("smallest encoding") {
+        CompressionPolicy policy;
+        policy.bytes_per_ns = 0;
+        auto smallest = analyze_column(relation[1], store.get_column(1), policy);
+        for (auto &estimate : smallest.estimates)
+            CHECK(smallest.chosen().size <= estimate.size);
+    }
+
+    SECTION("compress") {
+        ColumnStore *compressed = compress_columnstore(store, analyses);
+        REQUIRE(compressed->size() == NUM_ROWS);
+        CHECK(compressed->size_in_bytes() < store.size_in_bytes() / 2);
+        for (std::size_t i = 0; i != 4; ++i)
+            CHECK(compressed->get_column(i).is_compressed() == (analyses[i].encoding != EN_Plain));
+
+        std::vector<int32_t> keys(NUM_ROWS);
+        std::vector<int64_t> quantities(NUM_ROWS);
+        std::vector<Char<11>> decoded_modes(NUM_ROWS);
+        std::vector<double> prices(NUM_ROWS);
+        void *buffers[] = { keys.data(), quantities.data(), decoded_modes.data(), prices.data() };
+        const void *decoded[4];
+        for (std::size_t i = 0; i != 4; ++i) {
+            auto &column = compressed->get_column(i);
+            ColumnCursor cursor = column.cursor(0);
+            decoded[i] = column.read(cursor, NUM_ROWS, buffers[i]);
+            REQUIRE(cursor.idx == NUM_ROWS);
+        }
+        for (std::size_t i = 0; i != NUM_ROWS; ++i) {
+            REQUIRE(static_cast<const int32_t*>(decoded[0])[i] == key_of(i));
+            REQUIRE(static_cast<const int64_t*>(decoded[1])[i] == quantity_of(i));
+            REQUIRE(static_cast<const Char<11>*>(decoded[2])[i] == mode_of(i));
+            REQUIRE(static_cast<const double*>(decoded[3])[i] == price_of(i));
+        }
+        delete compressed;
+    }
+
+    SECTION("compress in parallel") {
+        ThreadPool pool(3);
+        std::vector<ColumnAnalysis> parallel_analyses;
+        ColumnStore *compressed = compress(relation, store, CompressionPolicy(), pool, &parallel_analyses);
+        REQUIRE(compressed->num_columns() == 4);
+        REQUIRE(compressed->size() == NUM_ROWS);
+        REQUIRE(parallel_analyses.size() == 4);
+        for (std::size_t i = 0; i != 4; ++i) {
+            CHECK(parallel_analyses[i].attr.name == relation[i].name);
+            CHECK(parallel_analyses[i].encoding == analyses[i].encoding);
+        }
+
+        std::vector<int32_t> keys(NUM_ROWS);
+        auto &key_column = compressed->get_column(0);
+        ColumnCursor cursor = key_column.cursor(0);
+        const int32_t *decoded = static_cast<const int32_t*>(key_column.read(cursor, NUM_ROWS, keys.data()));
+        REQUIRE(cursor.idx == NUM_ROWS);
+        for (std::size_t i = 0; i != NUM_ROWS; ++i)
+            REQUIRE(decoded[i] == key_of(i));
+        delete compressed;
+    }
+}
+
+TEST_CASE("FSST", "[unit][milestone2]")
+{
+    constexpr std::size_t NUM_VALUES = 3000;
+    const char *words[] = { "carefully", "final", "deposits", "sleep", "quickly", "ironic", "requests", "x" };
+    /* Sentences of words with a random byte, that no symbol covers. */
+    auto value_of = [&](std::size_t i) {
+        std::string str;
+        for (std::size_t w = 0; w != 1 + i % 4; ++w) {
+            if (w) str += ' ';
+            str += words[(i * 7 + w * 3) % 8];
+        }
+        if (i % 5 == 0) str += char('!' + i % 90);
+        return Char<45>(str.c_str());
+    };
+    Column<Char<45>> plain;
+    for (std::size_t i = 0; i != NUM_VALUES; ++i)
+        plain.push_back(value_of(i));
+
+    SECTION("symbol table") {
+        std::vector<const char*> strings;
+        for (auto &value : plain)
+            strings.push_back(value.data);
+        const SymbolTable table = SymbolTable::Train(strings.data(), strings.size());
+        REQUIRE(table.size() > 0);
+        REQUIRE(table.size() <= SymbolTable::MAX_SYMBOLS);
+
+        for (const char *str : { "", "carefully final deposits", "\x01 unseen bytes \x7f", "requests x" }) {
+            const std::size_t len = strlen(str);
+            uint8_t codes[2 * 64];
+            char decoded[64 + 8];
+            const std::size_t num_codes = table.encode(str, len, codes);
+            REQUIRE(num_codes <= 2 * len);
+            REQUIRE(table.decode(codes, num_codes, decoded) == len);
+            CHECK(std::string(decoded, len) == str);
+            CHECK(table.starts_with(codes, num_codes, str, len));
+            CHECK(table.starts_with(codes, num_codes, str, len / 2));
+            CHECK_FALSE(table.starts_with(codes, num_codes, "zzz", 3));
+        }
+        uint8_t codes[2 * 64];
+        CHECK(table.encode("carefully final", 15, codes) < 15);
+    }
+
+    SECTION("append trains on the appended elements") {
+        Column<FSST<Char<45>>> col;
+        col.append(plain, NUM_VALUES);
+        REQUIRE(col.size() == NUM_VALUES);
+        REQUIRE(col.is_trained());
+        CHECK(col.size_in_bytes() < plain.size_in_bytes() / 3);
+
+        for (std::size_t i = 0; i != NUM_VALUES; ++i)
+            REQUIRE(col.at(i) == value_of(i));
+        for (std::size_t batch_size : { 1, 7, 1000, 5000 }) {
+            std::vector<Char<45>> buffer(batch_size);
+            ColumnCursor cursor = col.cursor(0);
+            while (cursor.idx != col.size()) {
+                const std::size_t start = cursor.idx;
+                const Char<45> *decoded = static_cast<const Char<45>*>(col.read(cursor, batch_size, buffer.data()));
+                for (std::size_t i = 0; i != cursor.idx - start; ++i)
+                    REQUIRE(decoded[i] == value_of(start + i));
+            }
+        }
+
+        /* Elements pushed after training are encoded with the trained table. */
+        col.push_back("ironic requests");
+        CHECK(col.at(NUM_VALUES) == Char<45>("ironic requests"));
+    }
+
+    SECTION("push_back keeps elements plain until the table is trained") {
+        using column_type = Column<FSST<Char<45>>>;
+        column_type col;
+        for (std::size_t i = 0; i != column_type::TRAINING_SIZE - 1; ++i)
+            col.push_back(value_of(i));
+        CHECK_FALSE(col.is_trained());
+        CHECK(col.at(42) == value_of(42));
+        col.push_back(value_of(column_type::TRAINING_SIZE - 1));
+        REQUIRE(col.is_trained());
+        for (std::size_t i = 0; i != column_type::TRAINING_SIZE; ++i)
+            REQUIRE(col.at(i) == value_of(i));
+    }
+
+    SECTION("match on encoded elements") {
+        Column<FSST<Char<45>>> col;
+        col.append(plain, NUM_VALUES);
+        std::vector<uint8_t> mask(NUM_VALUES);
+        const std::string first = value_of(3).data;
+        for (const char *str : { first.c_str(), "carefully", "final deposits", "sleep", "", "not there" }) {
+            for (bool is_prefix : { false, true }) {
+                ColumnCursor cursor = col.cursor(0);
+                REQUIRE(col.match(cursor, NUM_VALUES, str, is_prefix, mask.data()) == NUM_VALUES);
+                REQUIRE(cursor.idx == NUM_VALUES);
+                for (std::size_t i = 0; i != NUM_VALUES; ++i) {
+                    const Char<45> value = value_of(i);
+                    const bool expected = is_prefix ? strncmp(value.data, str, strlen(str)) == 0
+                                                    : strcmp(value.data, str) == 0;
+                    REQUIRE(bool(mask[i]) == expected);
+                }
+            }
+        }
+    }
 }
@@ -0,0 +1,153 @@
+#include "catch.hpp"
+#include "dbms/Kernels.hpp"
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+
+using namespace dbms;
+
+
+TEST_CASE("Kernels/sum_discounted_price", "[unit]")
+{
+    /* An odd number of rows, such that the vectorized kernels process a tail of scalar rows. */
+    constexpr std::size_t NUM_ROWS = 1000 + 7;
+    constexpr uint32_t THRESHOLD = 5000;
+
+    std::mt19937_64 gen(42);
+    std::vector<uint32_t> date(NUM_ROWS);
+    std::vector<int64_t> price(NUM_ROWS), discount(NUM_ROWS), tax(NUM_ROWS);
+    int64_t expected = 0;
+    for (std::size_t i = 0; i != NUM_ROWS; ++i) {
+        /* Include dates above 2^31, that must not compare as negative. */
+        date[i] = i % 5 == 0 ? uint32_t(gen()) : gen() % (2 * THRESHOLD);
+        price[i] = gen() % 10000000 - 1000;
+        discount[i] = gen() % 11;
+        tax[i] = gen() % 9;
+        if (date[i] < THRESHOLD)
+            expected += price[i] * (100 - discount[i]) * (100 + tax[i]);
+    }
+
+    /* Lay out the same values in rows of 40 bytes. */
+    constexpr std::size_t ROW_SIZE = 40;
+    std::vector<uint8_t> rows(NUM_ROWS * ROW_SIZE);
+    for (std::size_t i = 0; i != NUM_ROWS; ++i) {
+        uint8_t *row = rows.data() + i * ROW_SIZE;
+        memcpy(row + 0, &price[i], 8);
+        memcpy(row + 8, &discount[i], 8);
+        memcpy(row + 16, &tax[i], 8);
+        memcpy(row + 24, &date[i], 4);
+    }
+
+    for (ISA isa : { ISA_Scalar, ISA_AVX2, ISA_AVX512 }) {
+        if (not is_supported(isa)) continue;
+        INFO("instruction set " << isa);
+        CHECK(sum_discounted_price(date.data(), price.data(), discount.data(), tax.data(), NUM_ROWS, THRESHOLD, isa)
+              == expected);
+        CHECK(sum_discounted_price(rows.data(), ROW_SIZE, 24, 0, 8, 16, NUM_ROWS, THRESHOLD, isa) == expected);
+        for (std::size_t n : { 0, 1, 3, 4, 5, 8, 9 }) {
+            int64_t prefix = 0;
+            for (std::size_t i = 0; i != n; ++i)
+                prefix += date[i] < THRESHOLD ? price[i] * (100 - discount[i]) * (100 + tax[i]) : 0;
+            CHECK(sum_discounted_price(date.data(), price.data(), discount.data(), tax.data(), n, THRESHOLD, isa)
+                  == prefix);
+            CHECK(sum_discounted_price(rows.data(), ROW_SIZE, 24, 0, 8, 16, n, THRESHOLD, isa) == prefix);
+        }
+    }
+}
+
+TEST_CASE("Kernels/unpack_bits", "[unit]")
+{
+    constexpr std::size_t NUM_VALUES = 300 + 5;
+
+    std::mt19937_64 gen(42);
+    for (unsigned bits = 0; bits <= 64; ++bits) {
+        INFO(bits << " bits");
+        const uint64_t mask = bits == 64 ? ~uint64_t(0) : (uint64_t(1) << bits) - 1;
+        std::vector<uint64_t> values(NUM_VALUES);
+        /* Pad the packed array with a word, such that the 8 bytes following every integer are readable. */
+        std::vector<uint64_t> packed((NUM_VALUES * bits + 63) / 64 + 1);
+        for (std::size_t i = 0; i != NUM_VALUES; ++i) {
+            values[i] = gen() & mask;
+            for (unsigned b = 0; b != bits; ++b) {
+                const std::size_t bit = i * bits + b;
+                packed[bit / 64] |= (values[i] >> b & 1) << bit % 64;
+            }
+        }
+
+        for (ISA isa : { ISA_Scalar, ISA_AVX2, ISA_AVX512 }) {
+            if (not is_supported(isa)) continue;
+            INFO("instruction set " << isa);
+            std::vector<uint64_t> out(NUM_VALUES);
+            unpack_bits(packed.data(), bits, 0, NUM_VALUES, 7, out.data(), isa);
+            for (std::size_t i = 0; i != NUM_VALUES; ++i)
+                REQUIRE(out[i] == values[i] + 7);
+            /* Start in the middle of the array, with a count that leaves a tail for the scalar kernel. */
+            unpack_bits(packed.data(), bits, 13, 21, 0, out.data(), isa);
+            for (std::size_t i = 0; i != 21; ++i)
+                REQUIRE(out[i] == values[13 + i]);
+        }
+    }
+}
+
+TEST_CASE("Kernels/prefix_sum", "[unit]")
+{
+    constexpr std::size_t NUM_VALUES = 100 + 3;
+
+    std::mt19937_64 gen(42);
+    std::vector<uint32_t> values32(NUM_VALUES);
+    std::vector<uint64_t> values64(NUM_VALUES);
+    for (std::size_t i = 0; i != NUM_VALUES; ++i) {
+        values32[i] = gen();
+        values64[i] = gen();
+    }
+
+    for (ISA isa : { ISA_Scalar, ISA_AVX2, ISA_AVX512 }) {
+        if (not is_supported(isa)) continue;
+        INFO("instruction set " << isa);
+        for (std::size_t n : { 0, 1, 7, 8, 9, 17, 33, int(NUM_VALUES) }) {
+            std::vector<uint32_t> sums32(values32);
+            std::vector<uint64_t> sums64(values64);
+            prefix_sum(sums32.data(), n, 5, isa);
+            prefix_sum(sums64.data(), n, 5, isa);
+            uint32_t sum32 = 5;
+            uint64_t sum64 = 5;
+            for (std::size_t i = 0; i != n; ++i) {
+                REQUIRE(sums32[i] == (sum32 += values32[i]));
+                REQUIRE(sums64[i] == (sum64 += values64[i]));
+            }
+            for (std::size_t i = n; i != NUM_VALUES; ++i) {
+                REQUIRE(sums32[i] == values32[i]);
+                REQUIRE(sums64[i] == values64[i]);
+            }
+        }
+    }
+}
+
+TEST_CASE("Kernels/find_structurals", "[unit]")
+{
+    /* Random bytes, with many delimiters and newlines, and bytes that are negative as signed chars. */
+    constexpr std::size_t NUM_BYTES = 1024;
+    const char alphabet[] = { '|', '\n', ',', 'a', '0', '\0', '\r', char(0x80), char(0xfc), char(0x8a) };
+    std::mt19937_64 gen(42);
+    std::vector<char> bytes(NUM_BYTES);
+    for (auto &c : bytes)
+        c = gen() % 4 ? alphabet[gen() % sizeof(alphabet)] : char(gen());
+
+    for (char delimiter : { '|', ',' }) {
+        INFO("delimiter " << delimiter);
+        for (ISA isa : { ISA_Scalar, ISA_AVX2, ISA_AVX512 }) {
+            if (not is_supported(isa)) continue;
+            INFO("instruction set " << isa);
+            /* Blocks at every offset, such that the kernels read unaligned blocks. */
+            for (std::size_t offset = 0; offset + 64 <= NUM_BYTES; ++offset) {
+                const char *block = bytes.data() + offset;
+                uint64_t expected = 0;
+                for (unsigned i = 0; i != 64; ++i)
+                    expected |= uint64_t(block[i] == delimiter or block[i] == '\n') << i;
+                REQUIRE(find_structurals(block, delimiter, isa) == expected);
+            }
+        }
+    }
+}
@@ -0,0 +1,546 @@
+#include "catch.hpp"
+#include "dbms/Loader.hpp"
+#include "dbms/Schema.hpp"
+#include "dbms/util.hpp"
+#include "impl/ColumnStore.hpp"
+#include "impl/Compression.hpp"
+#include "impl/Loader.hpp"
+#include "impl/RowStore.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+
+using namespace dbms;
+
+
+namespace {
+
+Relation relation("relation", {
+        Attribute::Int4("key"),
+        Attribute::Int8("price"),
+        Attribute::Int1("flag"),
+        Attribute::Int4("date"),
+        Attribute::Char("name", 8),
+        Attribute::Double("ratio"),
+        Attribute::Int2("small"),
+        });
+
+/* The fields are in a different order than the attributes of the relation. */
+const char *table =
+    "name|key|date|price|flag|ratio|small\n"
+    "first|1|1998-01-01|123.45|R|0.5|-7\n"
+    "second|2|1992-12-31|0.07|A|1.25|42\n"
+    "a very long name|3|1995-6-9|100.00|N|-2|0\n";
+
+/** Writes a table to a fresh temporary file and removes it on destruction. */
+struct TempTable
+{
+    TempTable(const char *contents) {
+        int fd = mkstemp(name);
+        REQUIRE(fd != -1);
+        REQUIRE(write(fd, contents, strlen(contents)) == ssize_t(strlen(contents)));
+        close(fd);
+    }
+    ~TempTable() { unlink(name); }
+
+    char name[32] = "/tmp/dbms_table_XXXXXX";
+};
+
+/** Returns a table in the format of table with num_rows generated rows. */
+std::string generate_table(std::size_t num_rows)
+{
+    std::string res = "name|key|date|price|flag|ratio|small\n";
+    char row[128];
+    for (std::size_t i = 0; i != num_rows; ++i) {
+        snprintf(row, sizeof(row), "name%zu|%zu|%zu-%02zu-%02zu|%zu.%02zu|%c|%zu.5|%d\n",
+                 i % 1000, i, 1992 + i % 7, 1 + i % 12, 1 + i % 28, i % 100000, i % 100, "RAN"[i % 3], i % 10,
+                 int(i % 200) - 100);
+        res += row;
+    }
+    return res;
+}
+
+/** Splits input into its fields at delimiters and newlines, one character at a time. */
+std::vector<std::string> split_fields(const std::string &input, char delimiter)
+{
+    std::vector<std::string> fields;
+    std::size_t begin = 0;
+    for (std::size_t i = 0; i != input.size(); ++i) {
+        if (input[i] == delimiter or input[i] == '\n') {
+            fields.emplace_back(input, begin, i - begin);
+            begin = i + 1;
+        }
+    }
+    if (begin != input.size())
+        fields.emplace_back(input, begin);
+    return fields;
+}
+
+/** Reads all fields of the file filename with a loader that builds its structural index with isa. */
+std::vector<std::string> read_fields(const char *filename, ISA isa)
+{
+    Loader loader(filename, '|', isa);
+    std::vector<std::string> fields;
+    while (not loader.eof())
+        fields.emplace_back(loader.read());
+    return fields;
+}
+
+/** A store that counts the live stores of chunks, and that appends slowly, like a store of compressed columns. */
+struct ChunkCountingStore
+{
+    inline static std::atomic<unsigned> num_live_chunks{0};
+    inline static std::atomic<unsigned> max_live_chunks{0};
+
+    ChunkCountingStore(bool is_chunk) : is_chunk(is_chunk) {
+        if (not is_chunk) return;
+        const unsigned n = ++num_live_chunks;
+        unsigned max = max_live_chunks;
+        while (n > max and not max_live_chunks.compare_exchange_weak(max, n)) { }
+    }
+    ChunkCountingStore(const ChunkCountingStore&) = delete;
+    ~ChunkCountingStore() { if (is_chunk) --num_live_chunks; }
+
+    void append(const ChunkCountingStore&, std::size_t n) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        size += n;
+    }
+
+    const bool is_chunk;
+    std::size_t size = 0;
+};
+
+/** Returns whether fn exits the process with EXIT_FAILURE.  fn is executed in a child process. */
+template<typename Fn>
+bool exits_with_failure(Fn fn)
+{
+    const pid_t pid = fork();
+    REQUIRE(pid != -1);
+    if (pid == 0) {
+        if (not freopen("/dev/null", "w", stderr)) _exit(EXIT_SUCCESS);
+        fn();
+        _exit(EXIT_SUCCESS);
+    }
+    int status;
+    REQUIRE(waitpid(pid, &status, 0) == pid);
+    return WIFEXITED(status) and WEXITSTATUS(status) == EXIT_FAILURE;
+}
+
+/** Returns whether the fields of attr at first and second are equal.  Char fields are compared up to their
+ * terminating NUL, since the bytes after it are undefined. */
+bool field_equals(const Attribute &attr, const void *first, const void *second)
+{
+    if (attr.type == Attribute::TY_Char)
+        return strncmp(static_cast<const char*>(first), static_cast<const char*>(second), attr.size) == 0;
+    return memcmp(first, second, attr.size) == 0;
+}
+
+/** Returns the number of rows of first and second that differ in any field, or SIZE_MAX if their sizes differ. */
+std::size_t num_different_rows(const Relation &relation, const RowStore &first, const RowStore &second)
+{
+    if (first.size() != second.size()) return SIZE_MAX;
+    std::size_t num_different = 0;
+    for (auto it = first.cbegin(), other = second.cbegin(); it != first.cend(); ++it, ++other) {
+        bool is_equal = true;
+        for (auto &attr : relation) {
+            is_equal = is_equal and field_equals(attr,
+                                                 static_cast<const uint8_t*>(*it) + first.offset_of(attr.offset()),
+                                                 static_cast<const uint8_t*>(*other) + second.offset_of(attr.offset()));
+        }
+        num_different += not is_equal;
+    }
+    return num_different;
+}
+
+std::size_t num_different_rows(const Relation &relation, const ColumnStore &first, const ColumnStore &second)
+{
+    if (first.size() != second.size()) return SIZE_MAX;
+    std::vector<bool> is_different(first.size());
+    for (auto &attr : relation) {
+        auto &column = static_cast<const GenericColumn&>(first.get_column(attr.offset()));
+        auto &other = static_cast<const GenericColumn&>(second.get_column(attr.offset()));
+        if (column.size() != other.size()) return SIZE_MAX;
+        for (std::size_t i = 0; i != column.size(); ++i) {
+            const std::size_t offset = i * column.elem_size();
+            if (not field_equals(attr, static_cast<const uint8_t*>(column.data()) + offset,
+                                 static_cast<const uint8_t*>(other.data()) + offset))
+                is_different[i] = true;
+        }
+    }
+    return std::count(is_different.begin(), is_different.end(), true);
+}
+
+}
+
+TEST_CASE("Loader/structural index", "[unit][loader]")
+{
+    SECTION("fields at block boundaries") {
+        std::string input;
+        input += std::string(63, 'a') + '\n'; // a newline at the last byte of the first block
+        input += std::string(64, 'b') + '|'; // a field spanning the second block, the delimiter starts the third
+        input += '|'; // an empty field
+        input += std::string(200, 'c') + '\n'; // a line longer than a block
+        input += std::string(62, 'd') + "||"; // delimiters at the last byte of one and the first byte of the next block
+        input += "e|f"; // a final partial block without a trailing newline
+        REQUIRE(input.size() % 64 != 0);
+        TempTable file(input.c_str());
+
+        for (ISA isa : { ISA_Scalar, ISA_AVX2, ISA_AVX512 }) {
+            if (not is_supported(isa)) continue;
+            INFO("instruction set " << isa);
+            CHECK(read_fields(file.name, isa) == split_fields(input, '|'));
+        }
+    }
+
+    SECTION("final partial blocks of every size") {
+        /* Random fields of up to two blocks. */
+        std::mt19937_64 gen(42);
+        std::string text;
+        while (text.size() < 400) {
+            text += std::string(gen() % 130, 'a' + gen() % 26);
+            text += gen() % 3 ? '|' : '\n';
+        }
+
+        for (std::size_t size = 0; size <= 3 * 64 + 1; ++size) {
+            INFO("input of " << size << " bytes");
+            const std::string input = text.substr(0, size);
+            TempTable file(input.c_str());
+            const std::vector<std::string> expected = split_fields(input, '|');
+            for (ISA isa : { ISA_Scalar, ISA_AVX2, ISA_AVX512 }) {
+                if (not is_supported(isa)) continue;
+                INFO("instruction set " << isa);
+                REQUIRE(read_fields(file.name, isa) == expected);
+            }
+        }
+    }
+}
+
+TEST_CASE("Loader/RowStore", "[unit][loader]")
+{
+    TempTable file(table);
+    RowStore store = RowStore::Create_Optimized(relation);
+
+    REQUIRE(Loader::load(file.name, relation, store) == 3);
+    REQUIRE(store.size() == 3);
+
+    auto it = store.cbegin();
+    CHECK(it.get<uint32_t>(0) == 1);
+    CHECK(it.get<int64_t>(1) == 12345);
+    CHECK(it.get<char>(2) == 'R');
+    CHECK(it.get<uint32_t>(3) == date_to_int(1998, 1, 1));
+    CHECK(std::string(it.get<Char<8>>(4)) == "first");
+    CHECK(it.get<double>(5) == 0.5);
+    CHECK(it.get<int16_t>(6) == -7);
+    ++it;
+    CHECK(it.get<uint32_t>(0) == 2);
+    CHECK(it.get<int64_t>(1) == 7);
+    CHECK(it.get<char>(2) == 'A');
+    CHECK(it.get<uint32_t>(3) == date_to_int(1992, 12, 31));
+    CHECK(std::string(it.get<Char<8>>(4)) == "second");
+    CHECK(it.get<double>(5) == 1.25);
+    CHECK(it.get<int16_t>(6) == 42);
+    ++it;
+    CHECK(it.get<uint32_t>(0) == 3);
+    CHECK(it.get<int64_t>(1) == 10000);
+    CHECK(it.get<char>(2) == 'N');
+    CHECK(it.get<uint32_t>(3) == date_to_int(1995, 6, 9));
+    CHECK(std::string(it.get<Char<8>>(4)) == "a very ");
+    CHECK(it.get<double>(5) == -2);
+    CHECK(it.get<int16_t>(6) == 0);
+    ++it;
+    CHECK(it == store.cend());
+}
+
+TEST_CASE("Loader/ColumnStore", "[unit][loader]")
+{
+    TempTable file(table);
+    ColumnStore store = ColumnStore::Create_Naive(relation);
+
+    SECTION("all rows") {
+        REQUIRE(Loader::load(file.name, relation, store) == 3);
+        REQUIRE(store.size() == 3);
+
+        auto key = store.get_column<uint32_t>(0).cbegin();
+        auto price = store.get_column<int64_t>(1).cbegin();
+        auto date = store.get_column<uint32_t>(3).cbegin();
+        auto name = store.get_column<Char<8>>(4).cbegin();
+        CHECK(*key++ == 1);
+        CHECK(*key++ == 2);
+        CHECK(*key++ == 3);
+        CHECK(*price++ == 12345);
+        CHECK(*price++ == 7);
+        CHECK(*price++ == 10000);
+        CHECK(*date++ == date_to_int(1998, 1, 1));
+        CHECK(*date++ == date_to_int(1992, 12, 31));
+        CHECK(*date++ == date_to_int(1995, 6, 9));
+        CHECK(std::string(*name++) == "first");
+        CHECK(std::string(*name++) == "second");
+        CHECK(std::string(*name++) == "a very ");
+    }
+
+    SECTION("at most max_rows rows") {
+        REQUIRE(Loader::load(file.name, relation, store, 2) == 2);
+        REQUIRE(store.size() == 2);
+        for (std::size_t i = 0; i != relation.size(); ++i)
+            CHECK(store.get_column(i).size() == 2);
+    }
+}
+
+TEST_CASE("Loader/projection", "[unit][loader]")
+{
+    TempTable file(table);
+    Relation projection(relation, { "date", "key" }); // skips the first and the trailing fields
+
+    SECTION("RowStore") {
+        RowStore store = RowStore::Create_Optimized(projection);
+        REQUIRE(Loader::load(file.name, projection, store) == 3);
+        REQUIRE(store.num_attributes() == 2);
+
+        auto it = store.cbegin();
+        CHECK(it.get<uint32_t>(0) == date_to_int(1998, 1, 1));
+        CHECK(it.get<uint32_t>(1) == 1);
+        ++it;
+        CHECK(it.get<uint32_t>(0) == date_to_int(1992, 12, 31));
+        CHECK(it.get<uint32_t>(1) == 2);
+        ++it;
+        CHECK(it.get<uint32_t>(0) == date_to_int(1995, 6, 9));
+        CHECK(it.get<uint32_t>(1) == 3);
+    }
+
+    SECTION("ColumnStore") {
+        ColumnStore store = ColumnStore::Create_Naive(projection);
+        REQUIRE(Loader::load(file.name, projection, store) == 3);
+        REQUIRE(store.size() == 3);
+
+        auto date = store.get_column<uint32_t>(0).cbegin();
+        auto key = store.get_column<uint32_t>(1).cbegin();
+        CHECK(*date++ == date_to_int(1998, 1, 1));
+        CHECK(*date++ == date_to_int(1992, 12, 31));
+        CHECK(*date++ == date_to_int(1995, 6, 9));
+        CHECK(*key++ == 1);
+        CHECK(*key++ == 2);
+        CHECK(*key++ == 3);
+    }
+}
+
+TEST_CASE("Loader/compressed", "[unit][loader]")
+{
+    TempTable file(table);
+    ColumnStore store = ColumnStore::Create_Explicit({
+            new Column<RLE<uint32_t>>(),
+            new Column<RLE<int64_t>>(),
+            new Column<Dictionary<char>>(),
+            new Column<RLE<Dictionary<uint32_t>>>(),
+            new Column<Dictionary<Char<8>>>(),
+            new Column<double>(),
+            new Column<RLE<int16_t>>(),
+            });
+
+    REQUIRE(Loader::load(file.name, relation, store) == 3);
+    REQUIRE(store.size() == 3);
+
+    auto key = store.get_column<RLE<uint32_t>>(0).cbegin();
+    CHECK(*key++ == 1);
+    CHECK(*key++ == 2);
+    CHECK(*key++ == 3);
+
+    auto &flag = store.get_column<Dictionary<char>>(2);
+    auto flag_idx = flag.cbegin();
+    CHECK(flag.get_dictionary()[*flag_idx++] == 'R');
+    CHECK(flag.get_dictionary()[*flag_idx++] == 'A');
+    CHECK(flag.get_dictionary()[*flag_idx++] == 'N');
+
+    auto &name = store.get_column<Dictionary<Char<8>>>(4);
+    auto name_idx = name.cbegin();
+    CHECK(std::string(name.get_dictionary()[*name_idx++]) == "first");
+    CHECK(std::string(name.get_dictionary()[*name_idx++]) == "second");
+    CHECK(std::string(name.get_dictionary()[*name_idx++]) == "a very ");
+
+    auto ratio = store.get_column<double>(5).cbegin();
+    CHECK(*ratio++ == 0.5);
+    CHECK(*ratio++ == 1.25);
+    CHECK(*ratio++ == -2);
+
+    auto small = store.get_column<RLE<int16_t>>(6).cbegin();
+    CHECK(*small++ == -7);
+    CHECK(*small++ == 42);
+    CHECK(*small++ == 0);
+}
+
+TEST_CASE("Loader/formats", "[unit][loader]")
+{
+    Relation numbers("numbers", {
+            Attribute::Int8("price"),
+            Attribute::Int4("date"),
+            Attribute::Int2("count"),
+            });
+
+    SECTION("the format is determined from all sampled rows") {
+        TempTable file(
+                "price|date|count\n"
+                "5|1998-01-01|1\n"
+                "5.25|1992-12-31|-2\n"
+                "5.2|1995-6-9|3\n"
+                "-0.07|2000-02-29|4\n");
+        ColumnStore store = ColumnStore::Create_Naive(numbers);
+        REQUIRE(Loader::load(file.name, numbers, store) == 4);
+
+        auto price = store.get_column<int64_t>(0).cbegin();
+        CHECK(*price++ == 500);
+        CHECK(*price++ == 525);
+        CHECK(*price++ == 520);
+        CHECK(*price++ == -7);
+        auto date = store.get_column<uint32_t>(1).cbegin();
+        CHECK(*date++ == date_to_int(1998, 1, 1));
+        CHECK(*date++ == date_to_int(1992, 12, 31));
+        CHECK(*date++ == date_to_int(1995, 6, 9));
+        CHECK(*date++ == date_to_int(2000, 2, 29));
+        auto count = store.get_column<int16_t>(2).cbegin();
+        CHECK(*count++ == 1);
+        CHECK(*count++ == -2);
+        CHECK(*count++ == 3);
+        CHECK(*count++ == 4);
+    }
+
+    SECTION("fields that do not match the format of their attribute are an error") {
+        auto fails = [&](const std::string &rows) {
+            TempTable file(("price|date|count\n" + rows).c_str());
+            return exits_with_failure([&]() {
+                RowStore store = RowStore::Create_Optimized(numbers);
+                Loader::load(file.name, numbers, store, std::numeric_limits<std::size_t>::max(), 1);
+            });
+        };
+
+        CHECK_FALSE(fails("1.5|1998-01-01|1\n"));
+        CHECK(fails("1.5|1998-13-01|1\n")); // not a date, hence an integer
+        CHECK(fails("1.5|1998-01-1x|1\n"));
+        CHECK(fails("1.505|1998-01-01|1\n")); // more than two decimals
+        CHECK(fails("1.5|1998-01-01|1.5\n"));
+        CHECK(fails("1.5|1998-01-01|70000\n")); // out of range of Int2
+        CHECK(fails("1.5|1998-01-01|\n"));
+
+        /* A row past the sampled rows with a fixed point number in an integer field. */
+        std::string rows;
+        for (unsigned i = 0; i != 2000; ++i)
+            rows += "1.5|1998-01-01|" + std::to_string(i) + '\n';
+        CHECK_FALSE(fails(rows));
+        CHECK(fails(rows + "1.5|1998-01-01|5.25\n"));
+    }
+}
+
+TEST_CASE("Loader/chunks", "[unit][loader]")
+{
+    /* The input is large enough to be split into several chunks, which are parsed concurrently. */
+    const std::size_t num_rows = 100000;
+    const std::string contents = generate_table(num_rows);
+    REQUIRE(contents.size() > 4 << 20);
+    TempTable file(contents.c_str());
+
+    /* Whether max_rows ends within the first chunk, within a later chunk, or not at all, a concurrent load must yield
+     * the same rows as a sequential one. */
+    const std::size_t max_rows[] = {
+        std::numeric_limits<std::size_t>::max(), num_rows + 1, num_rows, num_rows - 1, num_rows / 3, 1000, 1, 0
+    };
+
+    SECTION("RowStore") {
+        for (std::size_t n : max_rows) {
+            INFO("max_rows = " << n);
+            RowStore sequential = RowStore::Create_Optimized(relation);
+            RowStore concurrent = RowStore::Create_Optimized(relation);
+            const std::size_t expected = std::min(n, num_rows);
+            REQUIRE(Loader::load(file.name, relation, sequential, n, 1) == expected);
+            REQUIRE(Loader::load(file.name, relation, concurrent, n, 4) == expected);
+            CHECK(num_different_rows(relation, sequential, concurrent) == 0);
+        }
+    }
+
+    SECTION("ColumnStore") {
+        for (std::size_t n : max_rows) {
+            INFO("max_rows = " << n);
+            ColumnStore sequential = ColumnStore::Create_Naive(relation);
+            ColumnStore concurrent = ColumnStore::Create_Naive(relation);
+            const std::size_t expected = std::min(n, num_rows);
+            REQUIRE(Loader::load(file.name, relation, sequential, n, 1) == expected);
+            REQUIRE(Loader::load(file.name, relation, concurrent, n, 4) == expected);
+            CHECK(num_different_rows(relation, sequential, concurrent) == 0);
+        }
+    }
+
+    SECTION("at most num_threads chunks are parsed ahead of a slow append") {
+        for (unsigned num_threads : { 2, 3 }) {
+            INFO(num_threads << " threads");
+            Loader loader(file.name, '|');
+            ChunkCountingStore store(false);
+            ChunkCountingStore::max_live_chunks = 0;
+            const std::size_t n = Loader::load_parallel(
+                    loader, store, std::numeric_limits<std::size_t>::max(), num_threads,
+                    []() { return ChunkCountingStore(true); },
+                    [](Loader &loader, ChunkCountingStore&, std::size_t max_rows) {
+                        std::size_t num_lines = 0;
+                        for (; num_lines != max_rows and not loader.eof(); ++num_lines) {
+                            for (std::size_t i = 0; i != relation.size(); ++i)
+                                loader.read();
+                        }
+                        return num_lines;
+                    });
+            CHECK(n == num_rows + 1); // including the header
+            CHECK(store.size == n);
+            CHECK(ChunkCountingStore::num_live_chunks == 0);
+            CHECK(ChunkCountingStore::max_live_chunks <= num_threads);
+        }
+    }
+
+    SECTION("chunks are concatenated in input order") {
+        ColumnStore store = ColumnStore::Create_Naive(relation);
+        REQUIRE(Loader::load(file.name, relation, store, num_rows, 4) == num_rows);
+        auto keys = store.get_column<uint32_t>(0).fetch(0, num_rows);
+        REQUIRE(keys.size() == num_rows);
+        std::size_t num_misplaced = 0;
+        for (std::size_t i = 0; i != num_rows; ++i)
+            num_misplaced += keys[i] != i;
+        CHECK(num_misplaced == 0);
+    }
+}
+
+TEST_CASE("Loader/Varchar", "[unit][loader]")
+{
+    /* Strings parsed into the stores of chunks must outlive these stores. */
+    Relation varchars("varchars", {
+            Attribute::Int4("key"),
+            Attribute::Varchar("comment", 64),
+            });
+    auto comment_of = [](std::size_t i) { return "comment " + std::to_string(i) + std::string(i % 32, 'x'); };
+
+    const std::size_t num_rows = 50000;
+    std::string contents = "key|comment\n";
+    for (std::size_t i = 0; i != num_rows; ++i)
+        contents += std::to_string(i) + '|' + comment_of(i) + '\n';
+    REQUIRE(contents.size() > 1 << 20);
+    TempTable file(contents.c_str());
+
+    for (std::size_t n : { num_rows, num_rows / 3 }) {
+        INFO("max_rows = " << n);
+        ColumnStore store = ColumnStore::Create_Naive(varchars);
+        REQUIRE(Loader::load(file.name, varchars, store, n, 4) == n);
+
+        auto &comment = store.get_column<Varchar>(1);
+        REQUIRE(comment.size() == n);
+        std::size_t num_wrong = 0;
+        std::size_t i = 0;
+        for (auto elem : comment)
+            num_wrong += comment_of(i++) != elem.value;
+        CHECK(num_wrong == 0);
+    }
+}
@@ -0,0 +1,134 @@
+#include "catch.hpp"
+#include "dbms/Memory.hpp"
+#include "impl/ColumnStore.hpp"
+#include "impl/Compression.hpp"
+#include "impl/HashTable.hpp"
+#include "impl/RowStore.hpp"
+#include <cstdint>
+#include <cstring>
+
+
+using namespace dbms;
+
+
+TEST_CASE("MemoryPolicy/Parse", "[unit][memory]")
+{
+    SECTION("the empty policy is regular") {
+        CHECK(MemoryPolicy().is_regular());
+        CHECK(MemoryPolicy::Parse("regular").is_regular());
+    }
+
+    SECTION("page sizes") {
+        CHECK(MemoryPolicy::Parse("thp").pages == MemoryPolicy::PG_Transparent_Huge);
+        CHECK(MemoryPolicy::Parse("hugetlb").pages == MemoryPolicy::PG_Explicit_Huge);
+        CHECK_FALSE(MemoryPolicy::Parse("thp").is_regular());
+    }
+
+    SECTION("NUMA placement") {
+        MemoryPolicy bind = MemoryPolicy::Parse("bind=1");
+        CHECK(bind.placement == MemoryPolicy::PL_Bind);
+        CHECK(bind.nodes == 0b10);
+
+        MemoryPolicy interleave = MemoryPolicy::Parse("thp,interleave=0+2-4");
+        CHECK(interleave.pages == MemoryPolicy::PG_Transparent_Huge);
+        CHECK(interleave.placement == MemoryPolicy::PL_Interleave);
+        CHECK(interleave.nodes == 0b11101);
+    }
+}
+
+TEST_CASE("Memory/allocate", "[unit][memory]")
+{
+    for (const char *spec : { "regular", "thp", "hugetlb" }) {
+        const MemoryPolicy policy = MemoryPolicy::Parse(spec);
+
+        uint8_t *ptr = static_cast<uint8_t*>(allocate(1000, policy));
+        REQUIRE(ptr);
+        for (std::size_t i = 0; i != 1000; ++i)
+            ptr[i] = i;
+
+        ptr = static_cast<uint8_t*>(reallocate(ptr, 1000, 10 << 20, policy));
+        REQUIRE(ptr);
+        ptr[(10 << 20) - 1] = 42;
+        for (std::size_t i = 0; i != 1000; ++i)
+            CHECK(ptr[i] == uint8_t(i));
+
+        deallocate(ptr, 10 << 20, policy);
+    }
+
+    CHECK(allocate(0, MemoryPolicy::Parse("thp")) == nullptr);
+}
+
+TEST_CASE("Memory/stores", "[unit][memory]")
+{
+    Relation relation("relation", {
+            Attribute::Int4("int4"),
+            Attribute::Int8("int8"),
+            });
+    const MemoryPolicy policy = MemoryPolicy::Parse("thp");
+
+    SECTION("RowStore") {
+        RowStore store = RowStore::Create_Optimized(relation);
+        {
+            auto it = store.append(100);
+            for (std::size_t i = 0; i != 100; ++i, ++it)
+                it.get<int64_t>(1) = i;
+        }
+        store.set_memory_policy(policy);
+        CHECK(store.memory_policy().pages == MemoryPolicy::PG_Transparent_Huge);
+        CHECK(RowStore::Create_Like(store).memory_policy().pages == MemoryPolicy::PG_Transparent_Huge);
+
+        store.append(100000);
+        auto it = store.cbegin();
+        for (std::size_t i = 0; i != 100; ++i, ++it)
+            CHECK(it.get<int64_t>(1) == int64_t(i));
+    }
+
+    SECTION("ColumnStore") {
+        ColumnStore store = ColumnStore::Create_Naive(relation);
+        auto &column = store.get_column<int64_t>(1);
+        for (int64_t i = 0; i != 100; ++i)
+            column.push_back(i);
+        store.set_memory_policy(policy);
+        CHECK(column.memory_policy().pages == MemoryPolicy::PG_Transparent_Huge);
+
+        for (int64_t i = 100; i != 100000; ++i)
+            column.push_back(i);
+        auto it = column.cbegin();
+        for (int64_t i = 0; i != 100000; ++i)
+            REQUIRE(*it++ == i);
+    }
+
+    SECTION("compressed columns of a ColumnStore keep their allocations") {
+        ColumnStore store = ColumnStore::Create_Explicit({
+                new Column<uint32_t>(),
+                new Column<RLE<int64_t>>(),
+                });
+        auto &plain = store.get_column<uint32_t>(0);
+        auto &runs = store.get_column<RLE<int64_t>>(1);
+        for (std::size_t i = 0; i != 100; ++i) {
+            plain.push_back(i);
+            runs.push_back(i / 10);
+        }
+        const MemoryPolicy old_policy = runs.memory_policy();
+        const std::size_t old_capacity = runs.capacity_in_bytes();
+
+        store.reserve_address_space(100000);
+        store.set_memory_policy(policy);
+        CHECK(plain.capacity() >= 100000);
+        CHECK(plain.memory_policy().pages == MemoryPolicy::PG_Transparent_Huge);
+        CHECK(runs.capacity_in_bytes() == old_capacity);
+        CHECK(runs.memory_policy().pages == old_policy.pages);
+        REQUIRE(runs.size() == 100);
+        for (std::size_t i = 0; i != 100; ++i)
+            CHECK(runs.at(i) == int64_t(i / 10));
+    }
+
+    SECTION("HashTable") {
+        HashTable<uint64_t> table(16, policy);
+        for (uint64_t i = 0; i != 1000; ++i)
+            table.insert(i);
+        REQUIRE(table.size() == 1000);
+        for (uint64_t i = 0; i != 1000; ++i)
+            CHECK(table.find(i) != table.end());
+    }
+}
@@ -0,0 +1,571 @@
+#include "catch.hpp"
+#include "dbms/Operator.hpp"
+#include "dbms/Schema.hpp"
+#include "impl/ColumnStore.hpp"
+#include "impl/Compression.hpp"
+#include "impl/RowStore.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+
+using namespace dbms;
+
+
+namespace {
+
+Relation relation("relation", {
+        Attribute::Int4("key"),
+        Attribute::Int8("value"),
+        Attribute::Char("name", 8),
+        Attribute::Double("price"),
+        });
+
+const char *names[] = { "foo", "bar", "baz" };
+/* More rows than fit into a batch, such that operators must process several batches. */
+constexpr std::size_t NUM_ROWS = 3 * BATCH_SIZE + 42;
+
+uint32_t key_of(std::size_t i) { return i / 100; }
+int64_t value_of(std::size_t i) { return int64_t(i) - 1000; }
+const char * name_of(std::size_t i) { return names[i % 3]; }
+double price_of(std::size_t i) { return i * .5; }
+
+ColumnStore create_column_store()
+{
+    ColumnStore store = ColumnStore::Create_Naive(relation);
+    for (std::size_t i = 0; i != NUM_ROWS; ++i) {
+        store.get_column<uint32_t>(0).push_back(key_of(i));
+        store.get_column<int64_t>(1).push_back(value_of(i));
+        store.get_column<Char<8>>(2).push_back(name_of(i));
+        store.get_column<double>(3).push_back(price_of(i));
+    }
+    return store;
+}
+
+ColumnStore create_compressed_store(const ColumnStore &store)
+{
+    ColumnStore compressed = ColumnStore::Create_Explicit({
+            new Column<RLE<uint32_t>>(),
+            new Column<int64_t>(),
+            new Column<RLE<Dictionary<Char<8>>>>(),
+            new Column<double>(),
+            });
+    compressed.append(store, store.size());
+    return compressed;
+}
+
+RowStore create_row_store()
+{
+    RowStore store = RowStore::Create_Naive(relation);
+    auto it = store.append(NUM_ROWS);
+    for (std::size_t i = 0; i != NUM_ROWS; ++i, ++it) {
+        it.get<uint32_t>(0) = key_of(i);
+        it.get<int64_t>(1) = value_of(i);
+        strcpy(it.get<Char<8>>(2).data, name_of(i));
+        it.get<double>(3) = price_of(i);
+    }
+    return store;
+}
+
+/** Returns the values of the attribute with index attr of all selected rows produced by op. */
+template<typename T>
+std::vector<T> collect(Operator &op, std::size_t attr)
+{
+    std::vector<T> values;
+    Batch batch;
+    while (op.next(batch)) {
+        REQUIRE(batch.size <= BATCH_SIZE);
+        REQUIRE(batch.num_selected <= batch.size);
+        const T *data = batch.vectors[attr].as<T>();
+        for (std::size_t i = 0; i != batch.num_selected; ++i)
+            values.push_back(data[batch.selection ? batch.selection[i] : i]);
+    }
+    return values;
+}
+
+std::vector<std::string> collect_strings(Operator &op, std::size_t attr)
+{
+    std::vector<std::string> values;
+    Batch batch;
+    while (op.next(batch)) {
+        const Vector &v = batch.vectors[attr];
+        for (std::size_t i = 0; i != batch.num_selected; ++i)
+            values.emplace_back(v.as<char>() + v.elem_size * (batch.selection ? batch.selection[i] : i));
+    }
+    return values;
+}
+
+/** Checks the operators on store, which holds the rows of relation. */
+template<typename Store>
+void check_operators(const Store &store)
+{
+    SECTION("scan produces all rows") {
+        Scan scan(store, relation, { "value", "name" });
+        REQUIRE(scan.schema().size() == 2);
+        CHECK(scan.schema()[0].name == "value");
+        auto values = collect<int64_t>(scan, 0);
+        REQUIRE(values.size() == NUM_ROWS);
+        for (std::size_t i = 0; i != NUM_ROWS; ++i)
+            REQUIRE(values[i] == value_of(i));
+    }
+
+    SECTION("scan produces a range of rows") {
+        Scan scan(store, relation, { "name" }, 1000, 1100);
+        auto values = collect_strings(scan, 0);
+        REQUIRE(values.size() == 100);
+        for (std::size_t i = 0; i != 100; ++i)
+            REQUIRE(values[i] == name_of(1000 + i));
+    }
+
+    SECTION("filter selects the rows satisfying the predicate") {
+        Filter filter(new Scan(store, relation, { "key", "value", "name" }),
+                      between(col("key"), 5, 10) and col("name") != "bar");
+        auto values = collect<int64_t>(filter, 1);
+        std::vector<int64_t> expected;
+        for (std::size_t i = 0; i != NUM_ROWS; ++i) {
+            if (key_of(i) >= 5 and key_of(i) <= 10 and strcmp(name_of(i), "bar") != 0)
+                expected.push_back(value_of(i));
+        }
+        CHECK(values == expected);
+    }
+
+    SECTION("filters compose") {
+        Filter filter(new Filter(new Scan(store, relation, { "value" }), col("value") < 0), col("value") / 2 * 2 == col("value"));
+        auto values = collect<int64_t>(filter, 0);
+        REQUIRE(values.size() == 500);
+        CHECK(values.front() == -1000);
+        CHECK(values.back() == -2);
+    }
+
+    SECTION("project computes expressions") {
+        Project project(new Scan(store, relation, { "value", "price", "name" }), {
+                { "sum", col("value") + 2 * col("value") },
+                { "half", col("price") / 2 },
+                { "length", length(col("name")) },
+                { "constant", Expr(42) },
+                });
+        REQUIRE(project.schema().size() == 4);
+        CHECK(project.schema()[1].type == Attribute::TY_Double);
+        Batch batch;
+        REQUIRE(project.next(batch));
+        REQUIRE(batch.size == BATCH_SIZE);
+        for (std::size_t i = 0; i != batch.size; ++i) {
+            REQUIRE(batch.vectors[0].as<int64_t>()[i] == 3 * value_of(i));
+            REQUIRE(batch.vectors[1].as<double>()[i] == price_of(i) / 2);
+            REQUIRE(batch.vectors[2].as<int64_t>()[i] == 3);
+            REQUIRE(batch.vectors[3].as<int64_t>()[i] == 42);
+        }
+    }
+
+    SECTION("aggregate without grouping produces a single row") {
+        HashAggregate aggregate(new Scan(store, relation, { "value", "price" }), {}, {
+                Aggregate::Count("count"),
+                Aggregate::Sum("sum", col("value")),
+                Aggregate::Min("min", col("value")),
+                Aggregate::Max("max", col("price")),
+                });
+        Batch batch;
+        REQUIRE(aggregate.next(batch));
+        REQUIRE(batch.size == 1);
+        int64_t sum = 0;
+        for (std::size_t i = 0; i != NUM_ROWS; ++i)
+            sum += value_of(i);
+        CHECK(batch.vectors[0].as<int64_t>()[0] == int64_t(NUM_ROWS));
+        CHECK(batch.vectors[1].as<int64_t>()[0] == sum);
+        CHECK(batch.vectors[2].as<int64_t>()[0] == -1000);
+        CHECK(batch.vectors[3].as<double>()[0] == price_of(NUM_ROWS - 1));
+        CHECK_FALSE(aggregate.next(batch));
+    }
+
+    SECTION("aggregate of no rows") {
+        HashAggregate aggregate(new Filter(new Scan(store, relation, { "value" }), col("value") > 1000000), {},
+                                { Aggregate::Count("count") });
+        auto counts = collect<int64_t>(aggregate, 0);
+        REQUIRE(counts.size() == 1);
+        CHECK(counts[0] == 0);
+    }
+
+    SECTION("aggregate groups rows") {
+        HashAggregate aggregate(new Scan(store, relation, { "key", "name", "value" }), { "name", "key" }, {
+                Aggregate::Sum("sum", col("value")),
+                });
+        REQUIRE(aggregate.schema().size() == 3);
+        std::map<std::pair<std::string, uint32_t>, int64_t> expected;
+        for (std::size_t i = 0; i != NUM_ROWS; ++i)
+            expected[{ name_of(i), key_of(i) }] += value_of(i);
+
+        std::map<std::pair<std::string, uint32_t>, int64_t> groups;
+        Batch batch;
+        while (aggregate.next(batch)) {
+            for (std::size_t i = 0; i != batch.size; ++i) {
+                const std::string name(batch.vectors[0].as<char>() + 8 * i);
+                const uint32_t key = batch.vectors[1].as<uint32_t>()[i];
+                REQUIRE(groups.count({ name, key }) == 0);
+                groups[{ name, key }] = batch.vectors[2].as<int64_t>()[i];
+            }
+        }
+        CHECK(groups == expected);
+    }
+
+    SECTION("aggregate averages per group") {
+        HashAggregate aggregate(new Scan(store, relation, { "key", "value", "price" }), { "key" }, {
+                Aggregate::Avg("avg_value", col("value")),
+                Aggregate::Count("count"),
+                Aggregate::Avg("avg_price", col("price")),
+                });
+        REQUIRE(aggregate.schema().size() == 4);
+        CHECK(aggregate.schema()[1].type == Attribute::TY_Double);
+        CHECK(aggregate.schema()[3].type == Attribute::TY_Double);
+        std::map<uint32_t, std::pair<double, double>> sums;
+        std::map<uint32_t, int64_t> counts;
+        for (std::size_t i = 0; i != NUM_ROWS; ++i) {
+            sums[key_of(i)].first += value_of(i);
+            sums[key_of(i)].second += price_of(i);
+            ++counts[key_of(i)];
+        }
+
+        std::size_t num_groups = 0;
+        Batch batch;
+        while (aggregate.next(batch)) {
+            for (std::size_t i = 0; i != batch.size; ++i, ++num_groups) {
+                const uint32_t key = batch.vectors[0].as<uint32_t>()[i];
+                REQUIRE(counts.count(key));
+                CHECK(batch.vectors[2].as<int64_t>()[i] == counts[key]);
+                CHECK(batch.vectors[1].as<double>()[i] == Approx(sums[key].first / counts[key]));
+                CHECK(batch.vectors[3].as<double>()[i] == Approx(sums[key].second / counts[key]));
+            }
+        }
+        CHECK(num_groups == counts.size());
+    }
+
+    SECTION("sort orders rows") {
+        Sort sort(new Scan(store, relation, { "name", "value" }), { { "name" }, { "value", false } });
+        auto values = collect<int64_t>(sort, 1);
+        REQUIRE(values.size() == NUM_ROWS);
+        /* "bar" are the rows i with i % 3 == 1 and come first, in descending order of their values. */
+        std::size_t last_bar = NUM_ROWS - 1;
+        while (last_bar % 3 != 1) --last_bar;
+        CHECK(values[0] == value_of(last_bar));
+        CHECK(values[1] == value_of(last_bar - 3));
+        CHECK(values.back() == value_of(0));
+    }
+
+    SECTION("limit truncates") {
+        Limit limit(new Filter(new Scan(store, relation, { "value" }), col("value") >= 0), 1500);
+        auto values = collect<int64_t>(limit, 0);
+        REQUIRE(values.size() == 1500);
+        CHECK(values.front() == 0);
+        CHECK(values.back() == 1499);
+    }
+
+    SECTION("join matches rows on equal keys") {
+        /* Join the distinct keys with the rows. */
+        HashJoin join(new HashAggregate(new Scan(store, relation, { "key" }), { "key" }, { Aggregate::Count("num") }),
+                      new Filter(new Scan(store, relation, { "key", "value" }), col("value") < 0),
+                      "key", "key");
+        REQUIRE(join.schema().size() == 4);
+        Batch batch;
+        std::size_t num_rows = 0;
+        while (join.next(batch)) {
+            for (std::size_t i = 0; i != batch.num_selected; ++i) {
+                const std::size_t row = batch.selection ? batch.selection[i] : i;
+                REQUIRE(batch.vectors[0].as<uint32_t>()[row] == batch.vectors[2].as<uint32_t>()[row]);
+                REQUIRE(batch.vectors[1].as<int64_t>()[row] == 100);
+                REQUIRE(batch.vectors[3].as<int64_t>()[row] == value_of(num_rows));
+                ++num_rows;
+            }
+        }
+        CHECK(num_rows == 1000);
+    }
+}
+
+}
+
+TEST_CASE("Operator/ColumnStore", "[unit]")
+{
+    ColumnStore store = create_column_store();
+    check_operators(store);
+}
+
+TEST_CASE("Operator/compressed ColumnStore", "[unit]")
+{
+    ColumnStore uncompressed = create_column_store();
+    ColumnStore store = create_compressed_store(uncompressed);
+    check_operators(store);
+}
+
+TEST_CASE("Operator/RowStore", "[unit]")
+{
+    RowStore store = create_row_store();
+    check_operators(store);
+}
+
+/** Returns the rows produced by op, each as the concatenation of the bytes of its values, in sorted order. */
+std::vector<std::string> collect_rows(Operator &op)
+{
+    std::vector<std::string> rows;
+    Batch batch;
+    while (op.next(batch)) {
+        for (std::size_t i = 0; i != batch.num_selected; ++i) {
+            const std::size_t row = batch.selection ? batch.selection[i] : i;
+            std::string bytes;
+            for (auto &v : batch.vectors)
+                bytes.append(v.as<char>() + row * v.elem_size, v.elem_size);
+            rows.push_back(bytes);
+        }
+    }
+    std::sort(rows.begin(), rows.end());
+    return rows;
+}
+
+TEST_CASE("Operator/parallel aggregate", "[unit]")
+{
+    ColumnStore uncompressed = create_column_store();
+    ColumnStore store = create_compressed_store(uncompressed);
+    ThreadPool pool(4);
+    std::vector<const char*> group_by;
+    std::size_t num_groups = 1;
+    SECTION("without grouping") { }
+    SECTION("with grouping") {
+        group_by = { "name", "key" };
+        num_groups = 2 * (key_of(NUM_ROWS - 1) + 1); // the predicate rejects all rows named "bar"
+    }
+
+    auto aggregates = []() {
+        return std::vector<Aggregate>{
+            Aggregate::Count("count"),
+            Aggregate::Sum("sum", col("value")),
+            Aggregate::Min("min", col("price")),
+            Aggregate::Max("max", col("value")),
+            Aggregate::Avg("avg", col("value")),
+        };
+    };
+    auto predicate = []() { return col("value") / 3 * 3 != col("value"); };
+
+    /* Use small morsels, such that every worker processes several of them. */
+    ParallelAggregate parallel(store.size(), [&](Morsels &morsels, std::size_t worker) {
+        return new Filter(new Scan(store, relation, { "key", "value", "name", "price" }, morsels, worker), predicate());
+    }, group_by, aggregates(), pool, 100);
+    HashAggregate sequential(new Filter(new Scan(store, relation, { "key", "value", "name", "price" }), predicate()),
+                             group_by, aggregates());
+    REQUIRE(parallel.schema().size() == sequential.schema().size());
+
+    auto rows = collect_rows(parallel);
+    CHECK(rows.size() == num_groups);
+    CHECK(rows == collect_rows(sequential));
+}
+
+TEST_CASE("Operator/join produces all matches", "[unit]")
+{
+    Relation pairs("pairs", { Attribute::Int4("key"), Attribute::Int8("value") });
+    ColumnStore build = ColumnStore::Create_Naive(pairs);
+    ColumnStore probe = ColumnStore::Create_Naive(pairs);
+    /* Every key occurs 3 times on the build side, such that a probe row has more matches than fit into a batch once
+     * keys repeat often enough. */
+    for (uint32_t i = 0; i != 3000; ++i) {
+        build.get_column<uint32_t>(0).push_back(i % 1000 / 500);
+        build.get_column<int64_t>(1).push_back(i);
+    }
+    for (uint32_t i = 0; i != 10; ++i) {
+        probe.get_column<uint32_t>(0).push_back(i % 3);
+        probe.get_column<int64_t>(1).push_back(i);
+    }
+    HashJoin join(new Scan(build, pairs, { "key", "value" }), new Scan(probe, pairs, { "key", "value" }), "key", "key");
+    auto probe_values = collect<int64_t>(join, 3);
+    /* Probe rows with key 0 or 1 match 1500 build rows each, rows with key 2 match none. */
+    std::vector<int64_t> expected;
+    for (int64_t i = 0; i != 10; ++i) {
+        if (i % 3 != 2)
+            expected.insert(expected.end(), 1500, i);
+    }
+    CHECK(probe_values == expected);
+}
+
+TEST_CASE("Operator/radix join", "[unit]")
+{
+    Relation pairs("pairs", { Attribute::Int4("key"), Attribute::Int8("value") });
+    ColumnStore build = ColumnStore::Create_Naive(pairs);
+    ColumnStore probe = ColumnStore::Create_Naive(pairs);
+    /* Build keys repeat and probe keys include keys without match. */
+    for (uint32_t i = 0; i != 5000; ++i) {
+        build.get_column<uint32_t>(0).push_back(i % 2000);
+        build.get_column<int64_t>(1).push_back(i);
+    }
+    for (uint32_t i = 0; i != 3000; ++i) {
+        probe.get_column<uint32_t>(0).push_back(i * 7 % 2500);
+        probe.get_column<int64_t>(1).push_back(-int64_t(i));
+    }
+    ThreadPool pool(4);
+    /* Use small partitions, such that the rows are distributed over many partitions. */
+    RadixJoin radix(new Scan(build, pairs, { "key", "value" }), new Scan(probe, pairs, { "key", "value" }), "key", "key",
+                    pool, 1024);
+    HashJoin hash(new Scan(build, pairs, { "key", "value" }), new Scan(probe, pairs, { "key", "value" }), "key", "key");
+    REQUIRE(radix.schema().size() == 4);
+
+    auto rows = collect_rows(radix);
+    CHECK_FALSE(rows.empty());
+    CHECK(rows == collect_rows(hash));
+}
+
+TEST_CASE("Operator/aggregate of runs", "[unit]")
+{
+    /* Columns with runs of different lengths, such that the runs of the columns end at different rows. */
+    Relation runs("runs", {
+            Attribute::Int4("a"),
+            Attribute::Int8("b"),
+            Attribute::Char("c", 8),
+            Attribute::Double("d"),
+            });
+    ColumnStore uncompressed = ColumnStore::Create_Naive(runs);
+    for (std::size_t i = 0; i != NUM_ROWS; ++i) {
+        uncompressed.get_column<uint32_t>(0).push_back(i / 70 % 4);
+        uncompressed.get_column<int64_t>(1).push_back(int64_t(i / 45) - 20);
+        uncompressed.get_column<Char<8>>(2).push_back(names[i / 130 % 3]);
+        uncompressed.get_column<double>(3).push_back(i / 90 * .25);
+    }
+    ColumnStore store = ColumnStore::Create_Explicit({
+            new Column<RLE<uint32_t>>(),
+            new Column<RLE<int64_t>>(),
+            new Column<Dictionary<Char<8>>>(),
+            new Column<RLE<double>>(),
+            });
+    store.append(uncompressed, uncompressed.size());
+
+    SECTION("scans produce runs only of columns with runs") {
+        Scan scan(store, runs, { "a", "b", "c" });
+        REQUIRE(scan.produce_runs());
+        Batch batch;
+        std::size_t num_rows = 0;
+        while (scan.next(batch)) {
+            REQUIRE(batch.counts);
+            for (std::size_t i = 0; i != batch.size; ++i)
+                num_rows += batch.counts[i];
+        }
+        CHECK(num_rows == NUM_ROWS);
+
+        Scan plain(uncompressed, runs, { "a" });
+        CHECK_FALSE(plain.produce_runs());
+    }
+
+    SECTION("aggregates of runs equal aggregates of rows") {
+        auto aggregates = []() {
+            return std::vector<Aggregate>{
+                Aggregate::Count("count"),
+                Aggregate::Sum("sum", col("b") * 3),
+                Aggregate::Sum("dsum", col("d")),
+                Aggregate::Min("min", col("b")),
+                Aggregate::Max("max", col("d")),
+                Aggregate::Avg("avg", col("b")),
+            };
+        };
+        auto predicate = []() { return col("b") / 7 * 7 != col("b"); };
+        HashAggregate compressed(new Filter(new Scan(store, runs, { "a", "b", "c", "d" }), predicate()),
+                                 { "c", "a" }, aggregates());
+        HashAggregate rows(new Filter(new Scan(uncompressed, runs, { "a", "b", "c", "d" }), predicate()),
+                           { "c", "a" }, aggregates());
+        CHECK(collect_rows(compressed) == collect_rows(rows));
+    }
+}
+
+TEST_CASE("Operator/aggregate groups strings by their bytes up to NUL", "[unit]")
+{
+    /* The string starts within the first word of the key and ends within the second. */
+    Relation strings("strings", {
+            Attribute::Int1("a"),
+            Attribute::Char("s", 13),
+            });
+    const char *values[] = { "", "A", "SHIP", "REG AIR", "TWELVE CHARS" };
+    ColumnStore store = ColumnStore::Create_Naive(strings);
+    std::map<std::pair<std::string, int>, int64_t> expected;
+    for (std::size_t i = 0; i != NUM_ROWS; ++i) {
+        const char a = i % 2;
+        const char *s = values[i / 2 % 5];
+        *static_cast<char*>(static_cast<GenericColumn&>(store.get_column(0)).append(1)) = a;
+        /* Fill the bytes after the terminating NUL with garbage, that differs from row to row. */
+        auto *str = static_cast<uint8_t*>(static_cast<GenericColumn&>(store.get_column(1)).append(1));
+        for (std::size_t j = 0; j != 13; ++j)
+            str[j] = uint8_t(i + j) | 1;
+        memcpy(str, s, strlen(s) + 1);
+        ++expected[{ s, a }];
+    }
+
+    HashAggregate aggregate(new Scan(store, strings, { "a", "s" }), { "a", "s" }, { Aggregate::Count("count") });
+    std::map<std::pair<std::string, int>, int64_t> groups;
+    Batch batch;
+    while (aggregate.next(batch)) {
+        for (std::size_t i = 0; i != batch.size; ++i) {
+            const std::string s(batch.vectors[1].as<char>() + 13 * i);
+            const int a = batch.vectors[0].as<char>()[i];
+            REQUIRE(groups.count({ s, a }) == 0);
+            groups[{ s, a }] = batch.vectors[2].as<int64_t>()[i];
+        }
+    }
+    CHECK(groups == expected);
+}
+
+TEST_CASE("Operator/select", "[unit]")
+{
+    ColumnStore uncompressed = create_column_store();
+    ColumnStore rle = create_compressed_store(uncompressed);
+    ColumnStore dictionary = ColumnStore::Create_Explicit({
+            new Column<Dictionary<uint32_t>>(),
+            new Column<int64_t>(),
+            new Column<Dictionary<Char<8>>>(),
+            new Column<double>(),
+            });
+    dictionary.append(uncompressed, uncompressed.size());
+    ColumnStore fsst = ColumnStore::Create_Explicit({
+            new Column<FOR<uint32_t>>(),
+            new Column<int64_t>(),
+            new Column<FSST<Char<8>>>(),
+            new Column<double>(),
+            });
+    fsst.append(uncompressed, uncompressed.size());
+
+    SECTION("ranges are the same for all encodings") {
+        auto ranges = select(uncompressed, relation, "key", between(col("key"), 3, 7) or col("key") == 20);
+        REQUIRE(ranges.size() == 2);
+        CHECK(ranges[0] == RowRange(300, 800));
+        CHECK(ranges[1] == RowRange(2000, 2100));
+        CHECK(select(rle, relation, "key", between(col("key"), 3, 7) or col("key") == 20) == ranges);
+        CHECK(select(dictionary, relation, "key", between(col("key"), 3, 7) or col("key") == 20) == ranges);
+
+        auto names = select(uncompressed, relation, "name", col("name") == "baz");
+        REQUIRE(names.size() == (NUM_ROWS + 1) / 3);
+        CHECK(names[0] == RowRange(2, 3));
+        CHECK(select(rle, relation, "name", col("name") == "baz") == names);
+        CHECK(select(dictionary, relation, "name", col("name") == "baz") == names);
+        CHECK(select(fsst, relation, "name", col("name") == "baz") == names);
+        CHECK(select(fsst, relation, "name", "baz" == col("name")) == names);
+        CHECK(select(fsst, relation, "key", between(col("key"), 3, 7) or col("key") == 20) == ranges);
+
+        auto prefixes = select(uncompressed, relation, "name", starts_with(col("name"), "ba"));
+        REQUIRE(prefixes.size() == 1 + (NUM_ROWS - 1) / 3);
+        CHECK(prefixes[0] == RowRange(1, 3));
+        CHECK(select(dictionary, relation, "name", starts_with(col("name"), "ba")) == prefixes);
+        CHECK(select(fsst, relation, "name", starts_with(col("name"), "ba")) == prefixes);
+
+        CHECK(select(rle, relation, "key", col("key") > 1000000).empty());
+    }
+
+    SECTION("scans of ranges produce the rows in the ranges") {
+        for (ColumnStore *store : { &uncompressed, &rle, &dictionary, &fsst }) {
+            /* Long ranges, between which rows are skipped, and ranges of single rows. */
+            Scan ranges(*store, relation, { "value", "name" },
+                        select(*store, relation, "key", col("key") == 4 or between(col("key"), 12, 20)));
+            Filter filter(new Scan(*store, relation, { "value", "name", "key" }),
+                          col("key") == 4 or between(col("key"), 12, 20));
+            CHECK(collect<int64_t>(ranges, 0) == collect<int64_t>(filter, 0));
+
+            Scan names(*store, relation, { "value" }, select(*store, relation, "name", col("name") != "foo"));
+            auto values = collect<int64_t>(names, 0);
+            REQUIRE(values.size() == NUM_ROWS - (NUM_ROWS + 2) / 3);
+            CHECK(values[0] == value_of(1));
+            CHECK(values[1] == value_of(2));
+            CHECK(values[2] == value_of(4));
+        }
+    }
+}
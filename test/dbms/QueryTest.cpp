@@ -0,0 +1,47 @@
+#include "catch.hpp"
+#include "dbms/query.hpp"
+#include "dbms/Schema.hpp"
+#include "impl/ColumnStore.hpp"
+#include "impl/RowStore.hpp"
+#include <cstring>
+
+
+using namespace dbms;
+
+
+namespace {
+
+/** The shipmode is the 14th attribute of lineitem, the attributes before it are not accessed by Q2. */
+Relation lineitem("lineitem", {
+        Attribute::Int4("a0"), Attribute::Int4("a1"), Attribute::Int4("a2"), Attribute::Int4("a3"),
+        Attribute::Int4("a4"), Attribute::Int4("a5"), Attribute::Int4("a6"), Attribute::Int4("a7"),
+        Attribute::Int4("a8"), Attribute::Int4("a9"), Attribute::Int4("a10"), Attribute::Int4("a11"),
+        Attribute::Int4("a12"),
+        Attribute::Char("shipmode", 11),
+        });
+
+/** Unknown shipmodes share their first letters with known ones, the most frequent shipmode is unknown. */
+const char *shipmodes[] = { "TRAM", "TRUCK", "MOTOR", "TRAM", "MAIL", "TRUCK", "TRAM", "MAIL", "RAIL" };
+
+}
+
+TEST_CASE("Query/milestone1/Q2", "[unit][milestone1]")
+{
+    SECTION("RowStore counts unknown shipmodes separately") {
+        RowStore store = RowStore::Create_Naive(lineitem);
+        auto it = store.append(sizeof(shipmodes) / sizeof(*shipmodes));
+        for (auto mode : shipmodes) {
+            char *data = it.get<Char<11>>(13).data;
+            strncpy(data, mode, 11);
+            ++it;
+        }
+        CHECK(query::milestone1::Q2(store) == 3);
+    }
+
+    SECTION("ColumnStore counts unknown shipmodes separately") {
+        ColumnStore store = ColumnStore::Create_Naive(lineitem);
+        for (auto mode : shipmodes)
+            store.get_column<Char<11>>(13).push_back(mode);
+        CHECK(query::milestone1::Q2(store) == 3);
+    }
+}
@@ -137,3 +137,69 @@ TEST_CASE("RowStore/Optimized", "[unit][milestone1]")
         }
     }
 }
+
+TEST_CASE("RowStore/Create_Like", "[unit][milestone1]")
+{
+    RowStore store = RowStore::Create_Optimized(relation);
+    RowStore other = RowStore::Create_Like(store);
+
+    REQUIRE(other.num_attributes() == store.num_attributes());
+    REQUIRE(other.row_size() == store.row_size());
+    REQUIRE(other.size() == 0);
+
+    SECTION("rows of a store with the same layout can be appended") {
+        {
+            auto it = other.append(5);
+            for (std::size_t i = 0; i != 5; ++i, ++it) {
+                it.get<int64_t>(2) = (1lu << 42) + i;
+                it.get<Char<3>>(3) = "OK";
+            }
+        }
+        store.append(1);
+        store.begin().get<int64_t>(2) = 42;
+
+        store.append(other, 3);
+        REQUIRE(store.size() == 4);
+
+        auto it = store.begin();
+        CHECK(it.get<int64_t>(2) == 42);
+        ++it;
+        for (std::size_t i = 0; i != 3; ++i, ++it) {
+            CHECK(it.get<int64_t>(2) == (1lu << 42) + i);
+            CHECK(std::string(it.get<Char<3>>(3)) == "OK");
+        }
+    }
+}
+
+TEST_CASE("RowStore/reserve_address_space", "[unit][milestone1]")
+{
+    RowStore store = RowStore::Create_Optimized(relation);
+    store.append(1).get<int64_t>(2) = 42;
+
+    store.reserve_address_space(1000);
+    REQUIRE(store.size() == 1);
+    CHECK(store.begin().get<int64_t>(2) == 42);
+
+    SECTION("rows within the reservation are appended in place") {
+        const void *first = *store.begin();
+        for (std::size_t i = 1; i != 1000; ++i)
+            store.append(1).get<int64_t>(2) = i;
+        CHECK(*store.begin() == first);
+        REQUIRE(store.size() == 1000);
+        CHECK(store.capacity() >= 1000);
+    }
+
+    SECTION("growing beyond the reservation moves the rows") {
+        {
+            auto it = store.append(2999);
+            for (std::size_t i = 1; i != 3000; ++i, ++it)
+                it.get<int64_t>(2) = i;
+        }
+        REQUIRE(store.size() == 3000);
+        auto it = store.begin();
+        CHECK(it.get<int64_t>(2) == 42);
+        ++it;
+        for (std::size_t i = 1; i != 3000; ++i, ++it)
+            CHECK(it.get<int64_t>(2) == int64_t(i));
+    }
+}
@@ -0,0 +1,106 @@
+#include "catch.hpp"
+#include "dbms/Scheduler.hpp"
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+
+using namespace dbms;
+
+
+TEST_CASE("Morsels", "[unit]")
+{
+    SECTION("a worker claims the morsels of its stripe front to back") {
+        Morsels morsels(100, 2, 10);
+        std::size_t begin, end;
+        REQUIRE(morsels.next(0, begin, end));
+        CHECK(begin == 0);
+        CHECK(end == 10);
+        REQUIRE(morsels.next(0, begin, end));
+        CHECK(begin == 10);
+        CHECK(end == 20);
+        REQUIRE(morsels.next(1, begin, end));
+        CHECK(begin == 50);
+        CHECK(end == 60);
+    }
+
+    SECTION("the last morsel holds the remaining items") {
+        Morsels morsels(25, 1, 10);
+        std::size_t begin, end;
+        REQUIRE(morsels.next(0, begin, end));
+        REQUIRE(morsels.next(0, begin, end));
+        REQUIRE(morsels.next(0, begin, end));
+        CHECK(begin == 20);
+        CHECK(end == 25);
+        CHECK_FALSE(morsels.next(0, begin, end));
+    }
+
+    SECTION("a worker steals from the back of other stripes") {
+        Morsels morsels(100, 4, 10);
+        std::vector<bool> is_claimed(100);
+        std::size_t begin, end;
+        std::size_t num_morsels = 0;
+        while (morsels.next(3, begin, end)) {
+            for (std::size_t i = begin; i != end; ++i) {
+                REQUIRE_FALSE(is_claimed[i]);
+                is_claimed[i] = true;
+            }
+            ++num_morsels;
+        }
+        CHECK(num_morsels == 10);
+        for (std::size_t i = 0; i != 100; ++i)
+            CHECK(is_claimed[i]);
+        for (std::size_t w = 0; w != 4; ++w)
+            CHECK_FALSE(morsels.next(w, begin, end));
+    }
+
+    SECTION("no items") {
+        Morsels morsels(0, 4);
+        std::size_t begin, end;
+        CHECK_FALSE(morsels.next(0, begin, end));
+    }
+}
+
+TEST_CASE("ThreadPool", "[unit]")
+{
+    ThreadPool pool(4);
+    REQUIRE(pool.num_workers() == 4);
+
+    SECTION("run executes the task on every worker") {
+        std::atomic<unsigned> workers(0);
+        pool.run([&](std::size_t worker) { workers.fetch_or(1U << worker); });
+        CHECK(workers == 0xf);
+        /* The pool is reusable. */
+        workers = 0;
+        pool.run([&](std::size_t worker) { workers.fetch_or(1U << worker); });
+        CHECK(workers == 0xf);
+    }
+
+    SECTION("parallel_for processes every item exactly once") {
+        constexpr std::size_t NUM_ITEMS = 100000;
+        std::vector<std::atomic<unsigned>> counts(NUM_ITEMS);
+        std::atomic<std::size_t> sum(0);
+        pool.parallel_for(NUM_ITEMS, [&](std::size_t, std::size_t begin, std::size_t end) {
+            std::size_t local = 0;
+            for (std::size_t i = begin; i != end; ++i) {
+                ++counts[i];
+                local += i;
+            }
+            sum += local;
+        }, 1000);
+        CHECK(sum == NUM_ITEMS * (NUM_ITEMS - 1) / 2);
+        for (std::size_t i = 0; i != NUM_ITEMS; ++i)
+            REQUIRE(counts[i] == 1);
+    }
+
+    SECTION("nested tasks run on the calling worker") {
+        std::atomic<unsigned> num_calls(0);
+        pool.run([&](std::size_t) {
+            pool.run([&](std::size_t worker) {
+                CHECK(worker == 0);
+                ++num_calls;
+            });
+        });
+        CHECK(num_calls == 4);
+    }
+}
@@ -59,3 +59,34 @@ TEST_CASE("Relation", "[unit][core]")
         }
     }
 }
+
+TEST_CASE("Relation/projection", "[unit][core]")
+{
+    Relation test("test", {
+            /* 00 */ Attribute::Int4("A"),
+            /* 01 */ Attribute::Char("B", 6),
+            /* 02 */ Attribute::Int1("C"),
+            });
+    Relation projection(test, { "c", "A" });
+
+    CHECK(projection.name == "test");
+    REQUIRE(projection.size() == 2);
+    CHECK(projection.has("a"));
+    CHECK_FALSE(projection.has("B"));
+
+    {
+        auto &C = projection[0];
+        CHECK(C.name == "C");
+        CHECK(C.type == Attribute::TY_Int);
+        CHECK(C.size == 1);
+        CHECK(C.offset() == 0);
+        CHECK(&projection["c"] == &C);
+    }
+
+    {
+        auto &A = projection[1];
+        CHECK(A.name == "A");
+        CHECK(A.size == 4);
+        CHECK(A.offset() == 1);
+    }
+}
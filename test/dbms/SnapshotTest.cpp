@@ -0,0 +1,262 @@
+#include "catch.hpp"
+#include "dbms/Schema.hpp"
+#include "dbms/Snapshot.hpp"
+#include "impl/ColumnStore.hpp"
+#include "impl/Compression.hpp"
+#include "impl/RowStore.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+
+using namespace dbms;
+
+
+namespace {
+
+Relation relation("relation", {
+        Attribute::Int1("int1"),
+        Attribute::Float("float"),
+        Attribute::Int8("int8"),
+        Attribute::Char("Char(3)", 3),
+        Attribute::Double("double"),
+        });
+
+/** Creates a fresh temporary file and removes it on destruction. */
+struct TempFile
+{
+    TempFile() {
+        int fd = mkstemp(name);
+        REQUIRE(fd != -1);
+        close(fd);
+    }
+    ~TempFile() { unlink(name); }
+
+    char name[32] = "/tmp/dbms_snapshot_XXXXXX";
+};
+
+/** Returns whether fn exits the process with EXIT_FAILURE.  fn is executed in a child process. */
+template<typename Fn>
+bool exits_with_failure(Fn fn)
+{
+    const pid_t pid = fork();
+    REQUIRE(pid != -1);
+    if (pid == 0) {
+        if (not freopen("/dev/null", "w", stderr)) _exit(EXIT_SUCCESS);
+        fn();
+        _exit(EXIT_SUCCESS);
+    }
+    int status;
+    REQUIRE(waitpid(pid, &status, 0) == pid);
+    return WIFEXITED(status) and WEXITSTATUS(status) == EXIT_FAILURE;
+}
+
+}
+
+TEST_CASE("Snapshot/RowStore", "[unit][snapshot]")
+{
+    TempFile file;
+    RowStore store = RowStore::Create_Optimized(relation);
+    {
+        auto it = store.append(1000);
+        for (std::size_t i = 0; i != 1000; ++i, ++it) {
+            it.get<uint8_t>(0) = i;
+            it.get<float>(1) = 3.14f * i;
+            it.get<int64_t>(2) = (1lu << 42) + i;
+            it.get<Char<3>>(3) = "OK";
+            it.get<double>(4) = 2.71828 * i;
+        }
+    }
+    store.save_snapshot(file.name);
+
+    RowStore opened = RowStore::Open_Snapshot(file.name);
+    REQUIRE(opened.size() == 1000);
+    REQUIRE(opened.row_size() == store.row_size());
+    REQUIRE(opened.num_attributes() == store.num_attributes());
+
+    {
+        auto it = opened.begin();
+        for (std::size_t i = 0; i != 1000; ++i, ++it) {
+            CHECK(it.get<uint8_t>(0) == uint8_t(i));
+            CHECK(it.get<float>(1) == 3.14f * i);
+            CHECK(it.get<int64_t>(2) == (1lu << 42) + i);
+            CHECK(std::string(it.get<Char<3>>(3)) == "OK");
+            CHECK(it.get<double>(4) == 2.71828 * i);
+        }
+    }
+
+    SECTION("an opened store can be modified") {
+        opened.begin().get<int64_t>(2) = 42;
+        auto it = opened.append(1);
+        it.get<int64_t>(2) = 43;
+        REQUIRE(opened.size() == 1001);
+        CHECK(opened.begin().get<int64_t>(2) == 42);
+        CHECK(it.get<int64_t>(2) == 43);
+
+        /* The snapshot is not affected. */
+        RowStore reopened = RowStore::Open_Snapshot(file.name);
+        CHECK(reopened.begin().get<int64_t>(2) == (1lu << 42));
+    }
+}
+
+TEST_CASE("Snapshot/ColumnStore", "[unit][snapshot]")
+{
+    TempFile file;
+
+    SECTION("uncompressed columns") {
+        ColumnStore store = ColumnStore::Create_Naive(relation);
+        for (int64_t i = 0; i != 1000; ++i) {
+            store.get_column<uint8_t>(0).push_back(i);
+            store.get_column<float>(1).push_back(3.14f * i);
+            store.get_column<int64_t>(2).push_back(i * i);
+            store.get_column<Char<3>>(3).push_back("OK");
+            store.get_column<double>(4).push_back(2.71828 * i);
+        }
+        store.save_snapshot(file.name);
+
+        ColumnStore opened = ColumnStore::Open_Snapshot(file.name, relation);
+        REQUIRE(opened.size() == 1000);
+        auto it = opened.get_column<int64_t>(2).cbegin();
+        auto char_it = opened.get_column<Char<3>>(3).cbegin();
+        for (int64_t i = 0; i != 1000; ++i, ++it, ++char_it) {
+            CHECK(*it == i * i);
+            CHECK(std::string(*char_it) == "OK");
+        }
+
+        opened.get_column<int64_t>(2).push_back(-1);
+        CHECK(opened.get_column<int64_t>(2).size() == 1001);
+    }
+
+    SECTION("compressed columns") {
+        ColumnStore store = ColumnStore::Create_Explicit({
+                new Column<RLE<uint32_t>>(),
+                new Column<Dictionary<Char<16>>>(),
+                new Column<RLE<Dictionary<Char<16>>>>(),
+                new Column<FOR<int64_t>>(),
+                new Column<Delta<uint32_t>>(),
+                new Column<FSST<Char<16>>>(),
+                });
+        const char *words[] = { "foo", "bar", "baz" };
+        for (uint32_t i = 0; i != 1000; ++i) {
+            store.get_column<RLE<uint32_t>>(0).push_back(i / 10);
+            store.get_column<Dictionary<Char<16>>>(1).push_back(words[i % 3]);
+            store.get_column<RLE<Dictionary<Char<16>>>>(2).push_back(words[i / 100 % 3]);
+        }
+        /* Pack two blocks and keep a tail of unpacked elements. */
+        for (int64_t i = 0; i != 2500; ++i) {
+            store.get_column<FOR<int64_t>>(3).push_back(i * 7 - 3000);
+            store.get_column<Delta<uint32_t>>(4).push_back(i / 3);
+        }
+        Column<Char<16>> strings;
+        for (uint32_t i = 0; i != 2500; ++i)
+            strings.push_back(words[i % 3]);
+        store.get_column<FSST<Char<16>>>(5).append(strings, strings.size());
+        store.save_snapshot(file.name);
+
+        ColumnStore opened = ColumnStore::Open_Snapshot(file.name, {
+                new Column<RLE<uint32_t>>(),
+                new Column<Dictionary<Char<16>>>(),
+                new Column<RLE<Dictionary<Char<16>>>>(),
+                new Column<FOR<int64_t>>(),
+                new Column<Delta<uint32_t>>(),
+                new Column<FSST<Char<16>>>(),
+                });
+
+        auto &rle = opened.get_column<RLE<uint32_t>>(0);
+        REQUIRE(rle.size() == 1000);
+        REQUIRE(rle.num_runs() == 100);
+        auto &dict = opened.get_column<Dictionary<Char<16>>>(1);
+        REQUIRE(dict.size() == 1000);
+        REQUIRE(dict.get_dictionary().size() == 3);
+        auto &rle_dict = opened.get_column<RLE<Dictionary<Char<16>>>>(2);
+        REQUIRE(rle_dict.size() == 1000);
+        REQUIRE(rle_dict.num_runs() == 10);
+        auto &packed = opened.get_column<FOR<int64_t>>(3);
+        REQUIRE(packed.size() == 2500);
+        REQUIRE(packed.num_blocks() == 2);
+        auto &delta = opened.get_column<Delta<uint32_t>>(4);
+        REQUIRE(delta.size() == 2500);
+        auto &fsst = opened.get_column<FSST<Char<16>>>(5);
+        REQUIRE(fsst.size() == 2500);
+        REQUIRE(fsst.is_trained());
+        for (int64_t i = 0; i != 2500; ++i) {
+            REQUIRE(packed.at(i) == i * 7 - 3000);
+            REQUIRE(delta.at(i) == i / 3);
+            REQUIRE(fsst.at(i) == Char<16>(words[i % 3]));
+        }
+        delta.push_back(900);
+        CHECK(delta.at(2500) == 900);
+
+        auto rle_it = rle.cbegin();
+        auto dict_it = dict.cbegin();
+        auto rle_dict_it = rle_dict.cbegin();
+        for (uint32_t i = 0; i != 1000; ++i, ++rle_it, ++dict_it, ++rle_dict_it) {
+            CHECK(*rle_it == i / 10);
+            CHECK(std::string(dict.get_dictionary()[*dict_it]) == words[i % 3]);
+            CHECK(std::string(rle_dict.get_dictionary()[*rle_dict_it]) == words[i / 100 % 3]);
+        }
+
+        rle.push_back(99);
+        rle.push_back(100);
+        CHECK(rle.size() == 1002);
+        CHECK(rle.num_runs() == 101);
+    }
+}
+
+TEST_CASE("Snapshot/format", "[unit][snapshot]")
+{
+    TempFile file;
+
+    SECTION("columns are identified by explicit type tags") {
+        CHECK(Column<uint32_t>().type_tag() == "Plain<UInt32>");
+        CHECK(Column<Char<3>>().type_tag() == "Plain<Char3>");
+        CHECK(Column<RLE<int64_t>>().type_tag() == "RLE<Int64>");
+        CHECK(Column<Dictionary<Char<16>>>().type_tag() == "Dictionary<Char16, UInt32>");
+        using RLE_Dictionary = RLE<Dictionary<Char<16>, uint16_t>>;
+        CHECK(Column<RLE_Dictionary>().type_tag() == "RLE<Dictionary<Char16, UInt16>>");
+        CHECK(Column<FOR<int64_t>>().type_tag() == "FOR<Int64>");
+        CHECK(Column<Delta<uint32_t>>().type_tag() == "Delta<UInt32>");
+        CHECK(Column<FSST<Char<16>>>().type_tag() == "FSST<Char16>");
+        CHECK(GenericColumn(8).type_tag() == "Bytes8");
+    }
+
+    SECTION("a snapshot is only opened with columns of the same types") {
+        ColumnStore store = ColumnStore::Create_Explicit({ new Column<RLE<uint32_t>>() });
+        store.get_column<RLE<uint32_t>>(0).push_back(42);
+        store.save_snapshot(file.name);
+        CHECK_FALSE(exits_with_failure([&]() {
+            ColumnStore::Open_Snapshot(file.name, { new Column<RLE<uint32_t>>() });
+        }));
+        CHECK(exits_with_failure([&]() { ColumnStore::Open_Snapshot(file.name, { new Column<RLE<int32_t>>() }); }));
+        CHECK(exits_with_failure([&]() { ColumnStore::Open_Snapshot(file.name, { new Column<uint32_t>() }); }));
+    }
+
+    SECTION("a snapshot of another byte order is rejected") {
+        ColumnStore store = ColumnStore::Create_Naive(relation);
+        store.save_snapshot(file.name);
+
+        FILE *f = fopen(file.name, "r+b");
+        REQUIRE(f);
+        Snapshot::Header header;
+        REQUIRE(fread(&header, sizeof(header), 1, f) == 1);
+        CHECK(header.byte_order == Snapshot::BYTE_ORDER_MARK);
+        header.version = __builtin_bswap32(header.version);
+        header.byte_order = __builtin_bswap64(header.byte_order);
+        REQUIRE(fseek(f, 0, SEEK_SET) == 0);
+        REQUIRE(fwrite(&header, sizeof(header), 1, f) == 1);
+        REQUIRE(fclose(f) == 0);
+
+        CHECK(exits_with_failure([&]() { ColumnStore::Open_Snapshot(file.name, relation); }));
+    }
+
+    SECTION("stores with Varchar attributes are rejected before writing") {
+        Relation varchars("varchars", { Attribute::Int4("int4"), Attribute::Varchar("Varchar(8)", 8) });
+        unlink(file.name);
+        CHECK(exits_with_failure([&]() { RowStore::Create_Naive(varchars).save_snapshot(file.name); }));
+        CHECK(exits_with_failure([&]() { ColumnStore::Create_Naive(varchars).save_snapshot(file.name); }));
+        CHECK(access(file.name, F_OK) != 0);
+    }
+}
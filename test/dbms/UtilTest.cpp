@@ -1,5 +1,6 @@
 #include "catch.hpp"
 #include "dbms/util.hpp"
+#include <cstdio>
 
 
 TEST_CASE("ceil_to_pow2", "[unit][core]")
@@ -12,3 +13,49 @@ TEST_CASE("ceil_to_pow2", "[unit][core]")
     REQUIRE(ceil_to_pow2(7) == 8);
     REQUIRE(ceil_to_pow2(8) == 8);
 }
+
+TEST_CASE("parse_date", "[unit][core]")
+{
+    uint32_t date = 42;
+
+    SECTION("well-formed dates are parsed") {
+        REQUIRE(parse_date_scalar("1998-01-01", date));
+        CHECK(date == date_to_int(1998, 1, 1));
+        REQUIRE(parse_date_swar("1998-01-01", date));
+        CHECK(date == date_to_int(1998, 1, 1));
+
+        REQUIRE(parse_date_scalar("2019-12-31", date));
+        CHECK(date == date_to_int(2019, 12, 31));
+        REQUIRE(parse_date_swar("2019-12-31", date));
+        CHECK(date == date_to_int(2019, 12, 31));
+
+        REQUIRE(parse_date_swar("0000-09-09", date));
+        CHECK(date == date_to_int(0, 9, 9));
+    }
+
+    SECTION("malformed dates are rejected") {
+        const char *malformed[] = {
+            "1998/01/01", "1998-1-01|", "199a-01-01", "1998-0:-01", "1998-01-0/",
+            "1998-00-01", "1998-13-01", "1998-01-00", "1998-01-32", "          ",
+        };
+        for (auto str : malformed) {
+            CHECK_FALSE(parse_date_scalar(str, date));
+            CHECK_FALSE(parse_date_swar(str, date));
+        }
+        CHECK(date == 42);
+    }
+
+    SECTION("scalar and SWAR parsing agree") {
+        char str[11];
+        for (uint32_t year : { 1992u, 1998u, 2000u })
+            for (uint32_t month = 1; month <= 12; ++month)
+                for (uint32_t day = 1; day <= 31; ++day) {
+                    snprintf(str, sizeof(str), "%04u-%02u-%02u", year, month, day);
+                    uint32_t scalar, swar;
+                    REQUIRE(parse_date_scalar(str, scalar));
+                    REQUIRE(parse_date_swar(str, swar));
+                    CHECK(scalar == swar);
+                    CHECK(swar == date_to_int(year, month, day));
+                }
+    }
+}